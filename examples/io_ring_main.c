@@ -0,0 +1,170 @@
+// batched I/O: same records are written by syscall per record and by ring
+// note: asm file should be last
+// ../bin/build io_ring io_ring_main.c io_ring_asm.S
+// run from directory of output file:
+// time yeti-vm v io_ring.elf
+
+#include <stdint.h>
+
+[[noreturn]]
+void sys_exit(void);
+int32_t sys_open(const char* filename, uint32_t flags, uint32_t mode);
+void sys_close(uint32_t fd);
+int32_t sys_write(uint32_t fd, const void * buffer, uint32_t size);
+int32_t sys_ring_setup(void* ring, uint32_t entries);
+int32_t sys_ring_enter(uint32_t min_complete);
+
+void put_int(int32_t num);
+void put_char(char c);
+
+// layout of vm::io_ring
+#define RING_ENTRIES 64
+#define OP_WRITE 2
+
+struct ring_header
+{
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+};
+
+struct submission
+{
+    uint16_t opcode;
+    uint16_t fd;
+    uint32_t address;
+    uint32_t size;
+    uint32_t user_data;
+};
+
+struct completion
+{
+    uint32_t user_data;
+    int32_t result;
+};
+
+struct ring
+{
+    struct ring_header header;
+    struct submission sq[RING_ENTRIES];
+    struct completion cq[RING_ENTRIES];
+};
+
+#define NUM_RECORDS 4096
+#define RECORD_SIZE 32
+
+// O_WRONLY | O_CREAT | O_TRUNC
+#define OPEN_FLAGS 01101
+
+const char fileName[] = "ring_out.txt";
+char record[RECORD_SIZE];
+struct ring io;
+
+void app_main();
+
+[[noreturn]]
+void _start()
+{
+    app_main();
+    sys_exit();
+}
+
+void print_text(const char* text);
+void print_result(const char* title, int32_t calls, int32_t errors);
+
+/// one syscall for each record
+void write_records(uint32_t fd)
+{
+    int32_t errors = 0;
+    for (int i = 0; i < NUM_RECORDS; ++i)
+    {
+        if (sys_write(fd, record, RECORD_SIZE) != RECORD_SIZE)
+        {
+            ++errors;
+        }
+    }
+    print_result("write:", NUM_RECORDS, errors);
+}
+
+/// one ring_enter for each RING_ENTRIES records
+void ring_records(uint32_t fd)
+{
+    if (sys_ring_setup(&io, RING_ENTRIES) != 0)
+    {
+        print_text("ring: setup failed\n");
+        return;
+    }
+    int32_t calls = 0;
+    int32_t errors = 0;
+    uint32_t tail = 0;
+    for (int i = 0; i < NUM_RECORDS; i += RING_ENTRIES)
+    {
+        for (int n = 0; n < RING_ENTRIES; ++n)
+        {
+            struct submission* request = &io.sq[tail % RING_ENTRIES];
+            request->opcode = OP_WRITE;
+            request->fd = fd;
+            request->address = (uint32_t)record;
+            request->size = RECORD_SIZE;
+            request->user_data = i + n;
+            ++tail;
+        }
+        io.header.sq_tail = tail;
+        // doorbell: host writes batch, waits for all completions
+        sys_ring_enter(RING_ENTRIES);
+        ++calls;
+
+        uint32_t head = io.header.cq_head;
+        while (head != io.header.cq_tail)
+        {
+            if (io.cq[head % RING_ENTRIES].result != RECORD_SIZE)
+            {
+                ++errors;
+            }
+            ++head;
+        }
+        io.header.cq_head = head;
+    }
+    print_result("ring:", calls, errors);
+}
+
+void app_main()
+{
+    for (int i = 0; i < RECORD_SIZE - 1; ++i)
+    {
+        record[i] = (char)('a' + i % 26);
+    }
+    record[RECORD_SIZE - 1] = '\n';
+
+    int32_t fd = sys_open(fileName, OPEN_FLAGS, 0644);
+    if (fd < 0)
+    {
+        print_text("unable open file\n");
+        return;
+    }
+    write_records(fd);
+    ring_records(fd);
+    sys_close(fd);
+}
+
+void print_text(const char* text)
+{
+    while (*text)
+    {
+        put_char(*text);
+        ++text;
+    }
+}
+
+void print_result(const char* title, int32_t calls, int32_t errors)
+{
+    print_text(title);
+    print_text(" records = ");
+    put_int(NUM_RECORDS);
+    print_text(", syscalls = ");
+    put_int(calls);
+    print_text(", errors = ");
+    put_int(errors);
+    put_char('\n');
+}
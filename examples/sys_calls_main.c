@@ -13,6 +13,7 @@ void sys_exit(void);
 int32_t sys_open(const char* filename, uint32_t flags);
 int32_t sys_read(uint32_t fd, void * buffer, uint32_t size);
 void sys_close(uint32_t fd);
+int32_t sys_write(uint32_t fd, const void * buffer, uint32_t size);
 
 void put_int(int32_t num);
 void put_char(char c);
@@ -53,6 +54,8 @@ void app_main()
         }
     }
 
+    static const char input_title[] = "input:\n";
+    sys_write(1, input_title, sizeof(input_title) - 1);
     print_matrix(input);
 
     int k = 0;
@@ -78,6 +81,8 @@ void app_main()
         }
     }
 
+    static const char result_title[] = "result:\n";
+    sys_write(1, result_title, sizeof(result_title) - 1);
     print_matrix(result);
 }
 
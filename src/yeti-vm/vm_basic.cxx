@@ -3,25 +3,76 @@
 #include "vm_handlers_rv32i.hxx"
 #include "vm_handlers_rv32m.hxx"
 
+#include <cstring>
 #include <iostream>
 #include <format>
+#include <limits>
+#include <utility>
 
 namespace vm
 {
 
+namespace
+{
+/// access of 1, 2 or 4 bytes by native load/store, size is checked by caller
+void copy_bytes(void* dest, const void* source, std::uint8_t size)
+{
+    switch (size)
+    {
+    case 1: std::memcpy(dest, source, 1); break;
+    case 2: std::memcpy(dest, source, 2); break;
+    default: std::memcpy(dest, source, 4); break;
+    }
+}
+} // namespace
+
+std::optional<basic_vm::engine_type> basic_vm::find_engine(std::string_view name)
+{
+    if (name == "interpreter") return engine_type::interpreter;
+    if (name == "blocks") return engine_type::blocks;
+    if (name == "jit") return engine_type::jit;
+    return std::nullopt;
+}
+
+void basic_vm::raise(const trap &info)
+{
+    switch (info.cause)
+    {
+    case trap_cause::fetch_error:
+    case trap_cause::illegal_instruction:
+        throw unknown_instruction{info.get_message()};
+    case trap_cause::misaligned_jump:
+    case trap_cause::code_access:
+        throw code_access_error{info.get_message()};
+    case trap_cause::unknown_syscall:
+        throw unknown_syscall{info.get_message()};
+    default:
+        throw data_access_error{info.get_message()};
+    }
+}
+
+void basic_vm::set_trap(trap_cause cause, register_t address)
+{
+    if (!pending)
+    {
+        pending = {cause, address, get_pc()};
+    }
+    block_interrupt = true;
+}
+
 void basic_vm::halt()
 {
     running = false;
+    block_interrupt = true;
 }
 
 void basic_vm::jump_abs(basic_vm::address_t dest)
 {
     if (dest % sizeof(opcode::opcode_t)) [[unlikely]]
     {
-        throw code_access_error{
-            std::format("destination address({:08x}) should be aligned by instruction size", dest)
-        };
-    };
+        set_trap(trap_cause::misaligned_jump, dest);
+        return;
+    }
     set_pc(dest);
 }
 
@@ -46,115 +97,139 @@ void basic_vm::jump_if_abs(bool condition, basic_vm::address_t value)
 void basic_vm::syscall()
 {
     auto syscall_id = syscalls.get_syscall_id(this);
-    auto handler = syscalls.find_handler(syscall_id);
-    if (handler == nullptr) [[unlikely]]
+    auto call = syscalls.find_entry(syscall_id);
+    if (call == nullptr) [[unlikely]]
     {
-        if (!syscall_throw_on_error)
+        if (syscall_throw_on_error)
         {
-            return;
+            set_trap(trap_cause::unknown_syscall, syscall_id);
         }
-        throw unknown_syscall{
-                std::format("unknown syscall #{:08x}", syscall_id)
-        };
+        return;
     }
-    handler->exec(this);
+    (*call)(this);
 }
 
 void basic_vm::debug()
 {
-    inc_pc();
+    // PC is incremented by caller: ebreak is not a jump
+    breakpoint = true;
+    block_interrupt = true;
 }
 
 void basic_vm::control()
 {
-    inc_pc();
+    // CSRs are not implemented, PC is incremented by caller
 }
 
 void basic_vm::barrier()
 {
-    inc_pc();
+    // memory is coherent for single hart, PC is incremented by caller
 }
 
 void basic_vm::read_memory(basic_vm::address_t from, uint8_t size, register_t &value)
 {
-    auto ptr = get_ptr_ro(from, size);
-    if (!ptr) [[unlikely]]
+    if (pending) [[unlikely]]
+    {
+        return;
+    }
+    if (!std::has_single_bit(size) || (size > sizeof(value))) [[unlikely]]
+    {
+        set_trap(trap_cause::load_access, from);
+        return;
+    }
+    if (from % size) [[unlikely]]
     {
-        throw data_access_error{std::format("load: address {:08x} out of range", from)};;
+        set_trap(trap_cause::misaligned_load, from);
+        return;
     }
-    if (size > sizeof(value)) [[unlikely]]
+    // aligned access never crosses page boundary
+    if (auto* host = tlb.find(from)) [[likely]]
     {
-        throw data_access_error{"load: size out of range"};
+        copy_bytes(&value, host, size);
+        return;
     }
-    bool ok = ptr->load(from, &value, size);
-    if (!ok) [[unlikely]]
+    const auto* page = mmu.find_page(from);
+    if (page && page->host)
     {
-        throw data_access_error{"load: read error"};
+        tlb.fill(from, page->host);
+        copy_bytes(&value, page->host + (from & memory_management_unit::page_mask), size);
+        return;
+    }
+    const auto* ptr = mmu.find_block(from, size);
+    if (!ptr || !ptr->load(from, &value, size)) [[unlikely]]
+    {
+        set_trap(trap_cause::load_access, from);
     }
 }
 
 void basic_vm::write_memory(basic_vm::address_t from, uint8_t size, register_t value)
 {
-    if ((size == 0) || (size > sizeof(value))) [[unlikely]]
+    if (pending) [[unlikely]]
     {
-        throw data_access_error{"store: size out of range"};
+        return;
     }
-    auto ptr = get_ptr_rw(from, size);
-    if (!ptr) [[unlikely]]
+    if (!std::has_single_bit(size) || (size > sizeof(value))) [[unlikely]]
     {
-        throw data_access_error{std::format("store: address {:08x} out of range", from)};
+        set_trap(trap_cause::store_access, from);
+        return;
     }
-    bool ok = ptr->store(from, &value, size);
-    if (!ok) [[unlikely]]
+    if (from % size) [[unlikely]]
     {
-        throw data_access_error{"store: write error"};
+        set_trap(trap_cause::misaligned_store, from);
+        return;
     }
-}
-
-void basic_vm::set_register(register_no r, register_t value)
-{
-    if (r >= register_count) [[unlikely]]
+    if (auto* host = tlb.find(from)) [[likely]]
     {
-        throw data_access_error{std::format("register ID({}) out of range", r)};
+        copy_bytes(host, &value, size);
     }
-    if (r > 0)
+    else if (const auto* page = mmu.find_page(from); page && page->host)
     {
-        registers[r] = value;
+        tlb.fill(from, page->host);
+        copy_bytes(page->host + (from & memory_management_unit::page_mask), &value, size);
     }
-}
-
-register_t basic_vm::get_register(register_no r) const
-{
-    if (r >= register_count) [[unlikely]]
+    else
+    {
+        auto ptr = mmu.find_block(from, size);
+        if (!ptr || !ptr->store(from, &value, size)) [[unlikely]]
+        {
+            set_trap(trap_cause::store_access, from);
+            return;
+        }
+    }
+    if (predecode.contains(from)) [[unlikely]]
     {
-        throw data_access_error{std::format("register ID({}) out of range", r)};
+        predecode.invalidate(from, size);
     }
-    if (r > 0)
+    if (blocks.overlaps(from, size)) [[unlikely]]
     {
-        return registers[r];
+        blocks_flush = true;
+        block_interrupt = true;
     }
-    return 0;
 }
 
-register_t basic_vm::get_pc() const
+void basic_vm::register_error(register_no r)
 {
-    return registers[RegAlias::pc];
+    throw data_access_error{std::format("register ID({}) out of range", r)};
 }
 
-void basic_vm::set_pc(register_t value)
+void basic_vm::update_pc(register_t value)
 {
-    if (!mmu.find_block(value, sizeof(opcode::opcode_t))) [[unlikely]]
+    if (pending) [[unlikely]]
+    {
+        return;
+    }
+    const auto* block = mmu.find_block(value, sizeof(opcode::opcode_t));
+    if (!block) [[unlikely]]
     {
-        throw code_access_error{std::format("destination address {:08x} outside code region", value)};
+        set_trap(trap_cause::code_access, value);
+        return;
     }
+    const auto& params = block->get_params();
+    constexpr address_t tail = sizeof(opcode::opcode_t) - 1;
+    pc_window = {params.block_start, params.block_size - tail, block};
     registers[RegAlias::pc] = value;
 }
 
-void basic_vm::inc_pc()
-{
-    set_pc(get_pc() + sizeof(opcode::opcode_t));
-}
-
 const memory_block *basic_vm::get_ptr_ro(address_t address, uint8_t size) const
 {
     if (address % size)
@@ -177,6 +252,39 @@ memory_block *basic_vm::get_ptr_rw(vm::vm_interface::address_t address, uint8_t
     return nullptr;
 }
 
+std::optional<std::span<std::byte>> basic_vm::get_guest_span(address_t address, size_t size)
+{
+    auto view = std::as_const(*this).get_guest_span(address, size);
+    if (!view) [[unlikely]]
+    {
+        return std::nullopt;
+    }
+    predecode.invalidate(address, static_cast<predecode_cache::size_type>(size));
+    if (blocks.overlaps(address, size)) [[unlikely]]
+    {
+        blocks_flush = true;
+        block_interrupt = true;
+    }
+    // host memory of block is writable
+    return std::span{const_cast<std::byte*>(view->data()), view->size()};
+}
+
+std::optional<std::span<const std::byte>> basic_vm::get_guest_span(address_t address, size_t size) const
+{
+    if (size > std::numeric_limits<memory_block::size_type>::max()) [[unlikely]]
+    {
+        return std::nullopt;
+    }
+    auto* block = mmu.find_block(address, static_cast<memory_block::size_type>(std::max<size_t>(size, 1)));
+    auto* host = block ? block->get_host_memory() : nullptr;
+    if (!host) [[unlikely]]
+    {
+        return std::nullopt;
+    }
+    const auto* first = reinterpret_cast<const std::byte*>(host + block->get_params().offset(address));
+    return std::span{first, size};
+}
+
 bool basic_vm::set_ro_size(size_t size)
 {
     if (is_flag_set(HAVE_CODE_BLOCK)) return false;
@@ -191,17 +299,34 @@ bool basic_vm::set_rw_size(size_t size)
     return true;
 }
 
-void basic_vm::run_step()
+trap basic_vm::run_step()
 {
-    auto* current = get_current();
-    if (!current) [[unlikely]]
+    if (pending) [[unlikely]]
+    {
+        return take_trap();
+    }
+    const opcode::Decoder* current = nullptr;
+    registry::handler_ptr handler = nullptr;
+    const decoded_instruction* decoded = get_decoded();
+    if (decoded)
     {
-        throw unknown_instruction{std::format("unable fetch instruction from {:08x}", get_pc())};
+        current = &decoded->code;
+        handler = decoded->handler;
+    }
+    else
+    {
+        current = get_current();
+        if (!current) [[unlikely]]
+        {
+            set_trap(trap_cause::fetch_error, get_pc());
+            return take_trap();
+        }
+        handler = opcodes.find_handler(current);
     }
-    auto handler = opcodes.find_handler(current);
     if (!handler) [[unlikely]]
     {
-        throw unknown_instruction{std::format("unable find handler for {:08x}", current->code)};
+        set_trap(trap_cause::illegal_instruction, current->code);
+        return take_trap();
     }
     if (is_debugging_enabled()) [[unlikely]]
     {
@@ -214,7 +339,14 @@ void basic_vm::run_step()
                 << std::setw(10) << std::right << std::hex << get_register(current->get_rs2())
         ;
     }
-    handler->exec(this, current);
+    if (decoded)
+    {
+        exec(*decoded);
+    }
+    else
+    {
+        handler->exec(this, current);
+    }
     if (is_debugging_enabled()) [[unlikely]]
     {
         std::cout
@@ -228,20 +360,331 @@ void basic_vm::run_step()
     {
         inc_pc();
     }
+    return take_trap();
+}
+
+trap basic_vm::run_until_trap()
+{
+    constexpr auto unlimited = std::numeric_limits<std::uint64_t>::max();
+    while (true)
+    {
+        auto result = run_for(unlimited);
+        if (result.reason == stop_reason::trap)
+        {
+            return result.fault;
+        }
+        if (result.reason == stop_reason::halt)
+        {
+            return {};
+        }
+        // breakpoint: continue execution
+    }
 }
 
 void basic_vm::run()
 {
+    if (auto result = run_until_trap())
+    {
+        raise(result);
+    }
+}
+
+basic_vm::run_result basic_vm::run_for(std::uint64_t budget)
+{
+    breakpoint = false;
+    if (pending) [[unlikely]]
+    {
+        return {stop_reason::trap, 0, take_trap()};
+    }
+    if (engine != engine_type::interpreter && !is_debugging_enabled())
+    {
+        return run_blocks(budget);
+    }
+    return run_steps(budget);
+}
+
+basic_vm::run_result basic_vm::run_steps(std::uint64_t budget)
+{
+    run_result result;
+    while (is_running())
+    {
+        if (result.executed == budget) [[unlikely]]
+        {
+            return result;
+        }
+        if (auto fault = run_step()) [[unlikely]]
+        {
+            result.reason = stop_reason::trap;
+            result.fault = fault;
+            return result;
+        }
+        ++result.executed;
+        if (breakpoint) [[unlikely]]
+        {
+            breakpoint = false;
+            result.reason = stop_reason::breakpoint;
+            return result;
+        }
+    }
+    result.reason = stop_reason::halt;
+    return result;
+}
+
+basic_vm::run_result basic_vm::run_blocks(std::uint64_t budget)
+{
+    const bool compile = (engine == engine_type::jit) && jit_compiler::is_supported();
+    if (compile && !jit)
+    {
+        jit = std::make_unique<jit_compiler>();
+        jit->enable_direct_memory(space != nullptr);
+    }
+    run_result result;
+    basic_block* current = nullptr;
     while (is_running())
     {
-        run_step();
+        if (blocks_flush) [[unlikely]]
+        {
+            blocks.clear();
+            if (jit) jit->reset();
+            blocks_flush = false;
+            current = nullptr;
+        }
+        const auto remaining = budget - result.executed;
+        if (remaining == 0) [[unlikely]]
+        {
+            return result;
+        }
+        current = next_block(current);
+        if (!current) [[unlikely]]
+        {
+            result.reason = stop_reason::trap;
+            result.fault = take_trap();
+            return result;
+        }
+        if (current->count > remaining) [[unlikely]]
+        {
+            // rest of budget is less than block: execute by single steps
+            auto tail = run_steps(remaining);
+            tail.executed += result.executed;
+            return tail;
+        }
+        if (current->native)
+        {
+            result.executed += exec_native(*current);
+        }
+        else
+        {
+            result.executed += exec_block(*current);
+            if (compile && ++current->hits == jit_compiler::threshold) [[unlikely]]
+            {
+                current->native = jit->compile(*current);
+                // no space for code: drop all and compile again
+                blocks_flush |= jit->is_full();
+            }
+        }
+        if (pending) [[unlikely]]
+        {
+            result.reason = stop_reason::trap;
+            result.fault = take_trap();
+            return result;
+        }
+        if (breakpoint) [[unlikely]]
+        {
+            breakpoint = false;
+            result.reason = stop_reason::breakpoint;
+            return result;
+        }
+    }
+    result.reason = stop_reason::halt;
+    return result;
+}
+
+basic_block *basic_vm::next_block(basic_block *prev)
+{
+    const auto address = get_pc();
+    if (prev)
+    {
+        if (auto next = prev->find_successor(address))
+        {
+            return next;
+        }
+    }
+    auto next = blocks.find(address);
+    if (!next)
+    {
+        next = translate(address);
+    }
+    if (prev && next)
+    {
+        prev->link(next);
+    }
+    return next;
+}
+
+basic_block *basic_vm::translate(address_t address)
+{
+    auto block = std::make_unique<basic_block>();
+    block->start = address;
+
+    const auto* memory = get_ptr_ro(address, sizeof(opcode::opcode_t));
+    while (memory && block->ops.size() < basic_block::max_size)
+    {
+        auto code = memory->get_ro_ptr<opcode::Decoder>(address);
+        if (!code) break;
+        decoded_instruction op;
+        if (auto* slot = predecode.get_slot(address); slot && slot->is_valid())
+        {
+            op = *slot; // bound by start() or interpreter
+        }
+        else
+        {
+            op = decoded_instruction::decode(opcodes, *code);
+            if (!op.is_valid()) break; // fail on execution
+            bind(op);
+        }
+        if (fusion_active && !block->ops.empty())
+        {
+            auto fused = fusion::fuse(block->ops.back(), op, address - sizeof(opcode::opcode_t));
+            if (fused.is_valid())
+            {
+                op = fused;
+                bind(op);
+                block->ops.pop_back();
+            }
+        }
+        block->ops.push_back(op);
+        block->count += 1;
+        if (basic_block::is_terminator(op)) break;
+        address += sizeof(opcode::opcode_t);
+    }
+
+    if (block->ops.empty()) [[unlikely]]
+    {
+        auto* current = get_current();
+        if (!current)
+        {
+            set_trap(trap_cause::fetch_error, block->start);
+        }
+        else
+        {
+            set_trap(trap_cause::illegal_instruction, current->code);
+        }
+        return nullptr;
+    }
+
+    return blocks.insert(std::move(block));
+}
+
+size_t basic_vm::exec_block(const basic_block &block)
+{
+    block_interrupt = false;
+    const auto last = block.ops.size() - 1;
+    for (size_t i = 0; ; ++i)
+    {
+        const auto& op = block.ops[i];
+        exec(op);
+        if ((i == last) || block_interrupt) [[unlikely]]
+        {
+            if (!op.handler->skip() && !pending)
+            {
+                registers[RegAlias::pc] += (op.size - 1) * sizeof(opcode::opcode_t);
+                inc_pc();
+            }
+            if (i == last && !pending) [[likely]]
+            {
+                return block.count;
+            }
+            // stopped in the middle of block, faulting instruction is not retired
+            size_t retired = 0;
+            for (size_t k = 0; k < i; ++k)
+            {
+                retired += block.ops[k].size;
+            }
+            return pending ? retired : retired + op.size;
+        }
+        registers[RegAlias::pc] += op.size * sizeof(opcode::opcode_t);
+    }
+}
+
+size_t basic_vm::exec_native(const basic_block &block)
+{
+    block_interrupt = false;
+    jit_compiler::context ctx{registers.data(), this};
+    if (space)
+    {
+        ctx.memory = space->get_base();
+        // stores into translated or predecoded code invalidate it
+        std::uint64_t start = blocks.get_code_start();
+        std::uint64_t end = start + blocks.get_code_size();
+        if (predecode.get_size() != 0)
+        {
+            start = std::min<std::uint64_t>(start, predecode.get_start());
+            end = std::max<std::uint64_t>(end, std::uint64_t{predecode.get_start()} + predecode.get_size());
+        }
+        ctx.code_start = static_cast<address_t>(start);
+        ctx.code_size = static_cast<address_t>(end - start);
+    }
+    switch (jit->execute(block.native, ctx))
+    {
+    case jit_compiler::exit_next:
+        set_pc(ctx.target);
+        break;
+    case jit_compiler::exit_jump:
+        jump_abs(ctx.target);
+        break;
+    case jit_compiler::exit_interrupt:
+        set_pc(ctx.target);
+        return ctx.executed + 1;
+    default: // system instruction or fault
+        if (pending) [[unlikely]]
+        {
+            // fault in memory access helper, PC and retired count are stored on exit
+            pending.pc = get_pc();
+            return ctx.executed;
+        }
+        pending = run_step();
+        return pending ? ctx.executed : ctx.executed + 1;
     }
+    // trap of jump by last instruction of block, it is not retired
+    return pending ? ctx.executed - block.ops.back().size : ctx.executed;
+}
+
+void basic_vm::set_engine(basic_vm::engine_type type)
+{
+    engine = type;
+}
+
+basic_vm::engine_type basic_vm::get_engine() const
+{
+    return engine;
 }
 
 void basic_vm::start()
 {
+    if (predecode_enabled)
+    {
+        predecode.assign(code_base, ro_size);
+        load_decode_cache();
+    }
+    else
+    {
+        predecode.assign(0, 0);
+        decode_cache_hit = false;
+    }
+    blocks.clear();
+    if (jit) jit->reset();
+    blocks_flush = false;
+    fusion_active = fusion_enabled;
+    fusion_hits.fill(0);
     std::fill(registers.begin(), registers.end(), 0);
+    pending = {};
+    pc_window = {};
+    tlb.flush();
     set_pc(initial_pc);
+    if (pending) [[unlikely]]
+    {
+        raise(take_trap());
+    }
     running = is_initialized();
 }
 
@@ -273,58 +716,204 @@ bool basic_vm::set_program(const program_code_t &bin, address_t pc_value)
     if (!init_pc(pc_value)) return false;
     auto code = mmu.find_block(code_base, bin.size());
     if (!code) return false;
+    add_program_range(code_base, bin.size());
     return code->store(code_base, bin.data(), bin.size());
 }
 
+bool basic_vm::set_program(const program_image &image, address_t pc_value)
+{
+    if (!have_code_block()) return false;
+    if (!init_pc(pc_value)) return false;
+    return load_image(image, code_base);
+}
+
+bool basic_vm::load_image(const program_image &image, address_t address)
+{
+    auto block = mmu.find_block(address, image.get_size());
+    if (!block) return false;
+    add_program_range(address, image.get_size());
+    if (block->map_image(address, image)) return true;
+    const auto bin = image.get_data();
+    return block->store(address, bin.data(), bin.size());
+}
+
+bool basic_vm::set_program(const elf_file &elf)
+{
+    if (!have_code_block()) return false;
+    if (!init_pc(elf.get_entry())) return false;
+
+    for (const auto& segment: elf.get_segments())
+    {
+        if (!mmu.find_block(segment.address, segment.memory_size)) return false;
+        if (!load_image(*segment.image, segment.address)) return false;
+    }
+    return true;
+}
+
 bool basic_vm::set_program(const hex_file &hex)
 {
     if (!have_code_block()) return false; // no memory for code
     if (is_flag_set(PC_INITIALIZED)) return false; // program loaded
 
-    address_t offset = 0;
-    address_t pc_value = 0;
-
-    for (const hex_record& record: hex)
+    hex_loader loader;
+    for (size_t i = 0; i < hex.size() && !loader.finished; )
     {
-        if (!record.is_valid()) [[unlikely]] return false;
-
-        switch (record.get_type())
+        const auto record = hex[i];
+        if (record.is_data() && record.is_valid())
         {
-        case hex_record::HEX_DATA: // load data to memory
-        {
-            auto data_ptr = record.data.data();
-            auto data_sz = record.data.size();
-            address_t address = offset + record.offset;
-            auto mem_block = mmu.find_block(address, data_sz);
-
-            bool ok = mem_block != nullptr;
-            ok = ok && data_ptr != nullptr;
-            ok = ok && mem_block->store(address, data_ptr, data_sz);
-            if (!ok) [[unlikely]] return false;
-            break;
+            // contiguous records are contiguous in payload too: write them directly
+            const auto address = hex.get_address(i);
+            auto data = record.data;
+            for (++i; i < hex.size(); ++i)
+            {
+                const auto next = hex[i];
+                if (!next.is_data() || !next.is_valid()) break;
+                if (hex.get_address(i) != address + data.size()) break;
+                if (next.data.data() != data.data() + data.size()) break;
+                data = {data.data(), data.size() + next.data.size()};
+            }
+            if (!store_run(address, data)) [[unlikely]] return false;
+            continue;
         }
-        case hex_record::HEX_EOF:
+        if (!load_record(loader, record)) [[unlikely]] return false;
+        ++i;
+    }
+
+    return loader.finished && init_pc(loader.pc_value); // EOF record is required
+}
+
+bool basic_vm::set_program(std::istream &hex)
+{
+    if (!have_code_block()) return false; // no memory for code
+    if (is_flag_set(PC_INITIALIZED)) return false; // program loaded
+
+    hex_loader loader;
+    bool ok = parse_hex(hex, [this, &loader](const hex_record_view& record) {
+        return load_record(loader, record);
+    });
+
+    return ok && loader.finished && init_pc(loader.pc_value); // EOF record is required
+}
+
+bool basic_vm::load_record(hex_loader &loader, const hex_record_view &record)
+{
+    if (!record.is_valid()) [[unlikely]] return false;
+
+    switch (record.type)
+    {
+    case hex_record::HEX_DATA: // append data to run
+    {
+        address_t address = loader.offset + record.offset;
+        if (!loader.run.empty())
         {
-            return init_pc(pc_value); // EOF record: load finished
+            bool contiguous = address == loader.run_start + loader.run.size();
+            if (!contiguous || loader.run.size() + record.data.size() > hex_loader::max_run)
+            {
+                if (!flush_run(loader)) [[unlikely]] return false;
+            }
         }
-        case hex_record::HEX_SEGMENT_START:
-        case hex_record::HEX_LINEAR_START:
+        if (loader.run.empty())
         {
-            pc_value = record.get_start(); // use as entry point
-            break;
+            loader.run_start = address;
         }
-        case hex_record::HEX_SEGMENT_EXTEND:
-        case hex_record::HEX_LINEAR_EXTEND:
+        loader.run.insert(loader.run.end(), record.data.begin(), record.data.end());
+        return true;
+    }
+    case hex_record::HEX_EOF:
+    {
+        loader.finished = true; // EOF record: load finished
+        return flush_run(loader);
+    }
+    case hex_record::HEX_SEGMENT_START:
+    case hex_record::HEX_LINEAR_START:
+    {
+        loader.pc_value = record.get_start(); // use as entry point
+        return true;
+    }
+    case hex_record::HEX_SEGMENT_EXTEND:
+    case hex_record::HEX_LINEAR_EXTEND:
+    {
+        loader.offset = record.get_extend(); // offset for next data records
+        return true;
+    }
+    default:
+        return false; // can't load
+    }
+}
+
+bool basic_vm::flush_run(hex_loader &loader)
+{
+    if (!store_run(loader.run_start, loader.run)) [[unlikely]] return false;
+    loader.run.clear();
+    return true;
+}
+
+bool basic_vm::store_run(address_t address, std::span<const std::uint8_t> data)
+{
+    while (!data.empty())
+    {
+        // run may continue in adjacent block
+        auto mem_block = mmu.find_block(address, 1);
+        if (!mem_block) [[unlikely]] return false;
+        const auto& params = mem_block->get_params();
+        const auto size = static_cast<memory_block::size_type>(
+                std::min<std::uint64_t>(data.size(), std::uint64_t{params.block_start} + params.block_size - address));
+
+        if (size >= memory_management_unit::page_size)
         {
-            offset = record.get_extend(); // offset for next data records
-            break;
-        }
-        case hex_record::HEX_UNKNOWN:
-            return false; // can't load
+            mem_block->prefault(address, size);
         }
+        if (!mem_block->store(address, data.data(), size)) [[unlikely]] return false;
+        add_program_range(address, size);
+        address += size;
+        data = data.subspan(size);
     }
+    return true;
+}
 
-    return false; // EOF record is required
+void basic_vm::add_program_range(address_t address, size_t size)
+{
+    // only code block is predecoded
+    if (address < code_base || address - code_base >= ro_size) return;
+    program_size = std::max(program_size, std::min<size_t>(address - code_base + size, ro_size));
+}
+
+void basic_vm::load_decode_cache()
+{
+    decode_cache_hit = false;
+    if (decode_cache.empty() || program_size == 0) return;
+
+    constexpr auto slot_size = sizeof(opcode::opcode_t);
+    const auto size = static_cast<predecode_cache::size_type>((program_size + slot_size - 1) & ~(slot_size - 1));
+    auto block = mmu.find_block(code_base, size);
+    std::vector<std::uint8_t> code(size);
+    if (!block || !block->load(code_base, code.data(), size)) return;
+
+    const auto key = predecode_file::get_key(opcodes, code_base, code);
+    const auto file = predecode_file::get_path(decode_cache, key);
+    decode_cache_hit = predecode_file::load(file, key, opcodes, predecode, code_base, code,
+                                            [this](registry::handler_ptr handler) {
+        auto it = static_exec.find(handler);
+        return (it != static_exec.end()) ? it->second : nullptr;
+    });
+    if (decode_cache_hit) return;
+
+    for (size_t offset = 0; offset < size; offset += slot_size)
+    {
+        opcode::Decoder current{0};
+        std::memcpy(&current.code, code.data() + offset, slot_size);
+        auto* slot = predecode.get_slot(code_base + offset);
+        *slot = decoded_instruction::decode(opcodes, current);
+        if (slot->is_valid())
+        {
+            bind(*slot);
+        }
+    }
+    // cache is optional: program runs even if file can not be written
+    if (!predecode_file::save(file, key, opcodes, predecode, code_base, size) && is_debugging_enabled())
+    {
+        std::cout << "unable write predecode cache " << file << std::endl;
+    }
 }
 
 bool basic_vm::is_initialized() const
@@ -334,10 +923,30 @@ bool basic_vm::is_initialized() const
 
 const opcode::Decoder *basic_vm::get_current() const
 {
+    if (pc_window.contains(get_pc())) [[likely]]
+    {
+        return pc_window.block->get_ro_ptr<opcode::Decoder>(get_pc());
+    }
     const auto * ptr = get_ptr_ro(get_pc(), sizeof(opcode::opcode_t));
     return ptr->get_ro_ptr<opcode::Decoder>(get_pc());
 }
 
+const decoded_instruction *basic_vm::get_decoded()
+{
+    auto slot = predecode.get_slot(get_pc());
+    if (slot && !slot->is_valid()) [[unlikely]]
+    {
+        auto current = get_current();
+        if (!current) [[unlikely]]
+        {
+            return nullptr; // reported by run_step()
+        }
+        *slot = decoded_instruction::decode(opcodes, *current);
+        bind(*slot);
+    }
+    return slot;
+}
+
 bool basic_vm::set_ro_base(address_t base)
 {
     if (have_code_block()) return false;
@@ -352,6 +961,50 @@ bool basic_vm::set_rw_base(address_t base)
     return true;
 }
 
+namespace
+{
+/// handler body instantiated for basic_vm, operands are taken from slot
+template<typename Handler>
+void exec_static(vm_interface* vm, const decoded_instruction& op)
+{
+    Handler::invoke(static_cast<basic_vm*>(vm), &op);
+}
+} // namespace
+
+template<typename Handler>
+void basic_vm::exec_fused(vm_interface* vm, const decoded_instruction& op)
+{
+    auto self = static_cast<basic_vm*>(vm);
+    ++self->fusion_hits[static_cast<size_t>(Handler::id)];
+    Handler::invoke(self, op);
+}
+
+template<typename... Handlers>
+void basic_vm::bind_fused(handler_list<Handlers...>)
+{
+    ((static_exec[fusion::get_handler<Handlers>()] = &exec_fused<Handlers>), ...);
+}
+
+template<typename... Handlers>
+void basic_vm::bind_handlers(handler_list<Handlers...>)
+{
+    auto bind_one = [this]<typename Handler>(const Handler& tmp)
+    {
+        auto it = opcodes.handlers.find(tmp.get_id());
+        if (it != opcodes.handlers.end() && dynamic_cast<const Handler*>(it->second.get()))
+        {
+            static_exec[it->second.get()] = &exec_static<Handler>;
+        }
+    };
+    (bind_one(Handlers{}), ...);
+}
+
+void basic_vm::bind(decoded_instruction &op) const
+{
+    auto it = static_exec.find(op.handler);
+    op.exec = (it != static_exec.end()) ? it->second : nullptr;
+}
+
 bool basic_vm::init_isa()
 {
     bool rv32i_ok = rv32i::register_rv32i_set(&opcodes);
@@ -361,6 +1014,9 @@ bool basic_vm::init_isa()
 
     if (isa_ok)
     {
+        bind_handlers(rv32i::handlers{});
+        bind_handlers(rv32m::handlers{});
+        bind_fused(fusion::handlers{});
         set_flag(ISA_INITIALIZED);
     }
 
@@ -382,9 +1038,38 @@ void basic_vm::enable_debugging(bool enable)
     debugging = enable;
 }
 
+bool basic_vm::enable_guest_space()
+{
+    if (space)
+        return true;
+    if (!mmu.is_empty())
+        return false;
+    space = guest_space::reserve();
+    return space != nullptr;
+}
+
+bool basic_vm::is_guest_space_enabled() const
+{
+    return space != nullptr;
+}
+
 bool basic_vm::add_memory(vm_interface::address_t address, size_t size)
 {
-    return mmu.add_block<vm::generic_memory>(address, size);
+    if (space && size <= std::numeric_limits<memory_block::size_type>::max()
+        && guest_space::is_aligned(address, size))
+    {
+        // region is committed only if it does not belong to other block
+        if (size == 0 || !mmu.is_free({address, static_cast<memory_block::size_type>(size)}))
+            return false;
+        if (space->commit(address, size))
+            return mmu.add_block<vm::mapped_memory>(space, address, size);
+    }
+    return mmu.add_block<vm::sparse_memory>(address, size);
+}
+
+std::uint64_t basic_vm::get_committed_memory() const
+{
+    return mmu.get_committed_size();
 }
 
 bool basic_vm::add_memory(memory_block::ptr ptr)
@@ -493,4 +1178,49 @@ void basic_vm::syscall_should_throw(bool enable) {
     syscall_throw_on_error = enable;
 }
 
+bool basic_vm::is_predecode_enabled() const
+{
+    return predecode_enabled;
+}
+
+void basic_vm::enable_predecode(bool enable)
+{
+    predecode_enabled = enable;
+}
+
+const std::filesystem::path &basic_vm::get_decode_cache() const
+{
+    return decode_cache;
+}
+
+void basic_vm::set_decode_cache(const std::filesystem::path &directory)
+{
+    decode_cache = directory;
+}
+
+bool basic_vm::is_decode_cache_hit() const
+{
+    return decode_cache_hit;
+}
+
+bool basic_vm::is_fusion_enabled() const
+{
+    return fusion_enabled;
+}
+
+void basic_vm::enable_fusion(bool enable)
+{
+    fusion_enabled = enable;
+}
+
+const fusion::counters &basic_vm::get_fusion_stats() const
+{
+    return fusion_hits;
+}
+
+const memory_tlb::stats &basic_vm::get_tlb_stats() const
+{
+    return tlb.get_stats();
+}
+
 } // namespace vm
@@ -7,6 +7,14 @@
 #include "vm_syscall.hxx"
 #include "vm_memory.hxx"
 #include "vm_utility.hxx"
+#include "vm_predecode.hxx"
+#include "vm_blocks.hxx"
+#include "vm_fusion.hxx"
+#include "vm_trap.hxx"
+#include "vm_jit.hxx"
+#include "vm_guest_space.hxx"
+#include "vm_program_image.hxx"
+#include "vm_elf.hxx"
 
 #include <exception>
 #include <stdexcept>
@@ -32,20 +40,63 @@ struct basic_vm: public vm_interface
         explicit data_access_error(const std::string& message): std::domain_error{message} {}
     };
 
+    /// execution engine
+    enum class engine_type: std::uint8_t
+    {
+        /// decode and execute instructions one by one
+        interpreter,
+        /// translate code into basic blocks and execute them
+        blocks,
+        /// compile hot blocks into native code(x86-64), blocks engine for other code
+        jit,
+    };
+
+    /// find engine by name
+    [[nodiscard]]
+    static std::optional<engine_type> find_engine(std::string_view name);
+
+    /// reason of stop of bounded execution
+    enum class stop_reason: std::uint8_t
+    {
+        /// instruction budget is exhausted
+        budget,
+        /// VM is halted
+        halt,
+        /// trap of guest code
+        trap,
+        /// debug break(ebreak), PC points to next instruction
+        breakpoint,
+    };
+
+    /// result of bounded execution
+    struct run_result
+    {
+        /// reason of stop
+        stop_reason reason = stop_reason::budget;
+        /// num of retired instructions
+        std::uint64_t executed = 0;
+        /// trap which stopped VM, if reason == stop_reason::trap
+        trap fault{};
+    };
+
+    /// throw exception matching to trap cause
+    [[noreturn]]
+    static void raise(const trap& info);
+
     /// stop VM
     void halt() final;
 
     /// jump to absolute address
-    void jump_abs(address_t dest) override;
+    void jump_abs(address_t dest) final;
 
     /// jump by offset
-    void jump_to(offset_t value) override;
+    void jump_to(offset_t value) final;
 
     /// conditional jump by offset
-    void jump_if(bool condition, offset_t value) override;
+    void jump_if(bool condition, offset_t value) final;
 
     /// conditional jump
-    void jump_if_abs(bool condition, address_t value) override;
+    void jump_if_abs(bool condition, address_t value) final;
 
     /// system call
     void syscall() override;
@@ -61,26 +112,63 @@ struct basic_vm: public vm_interface
 
     /// read(load) value from memory
     /// size should be eq 1,2 or 4
-    void read_memory(address_t from, uint8_t size, register_t& value) override;
+    void read_memory(address_t from, uint8_t size, register_t& value) final;
 
     /// write(store) value to memory
     /// size should be eq 1,2 or 4
-    void write_memory(address_t from, uint8_t size, register_t value) override;
+    void write_memory(address_t from, uint8_t size, register_t value) final;
 
     /// set register value
-    void set_register(register_no r, register_t value) override;
+    void set_register(register_no r, register_t value) final
+    {
+        if (r >= register_count) [[unlikely]]
+        {
+            register_error(r);
+        }
+        // instruction with pending trap has no more effects
+        if (r > 0 && !pending) [[likely]]
+        {
+            registers[r] = value;
+        }
+    }
 
     /// get register value
     [[nodiscard]]
-    register_t get_register(register_no r) const override;
+    register_t get_register(register_no r) const final
+    {
+        if (r >= register_count) [[unlikely]]
+        {
+            register_error(r);
+        }
+        if (r > 0)
+        {
+            return registers[r];
+        }
+        return 0;
+    }
 
     /// get PC register value
     [[nodiscard]]
-    register_t get_pc() const override;
+    register_t get_pc() const final
+    {
+        return registers[RegAlias::pc];
+    }
     /// set PC register value
-    void set_pc(register_t value);
+    void set_pc(register_t value)
+    {
+        // sequential execution and short jumps stay in the same block
+        if (pc_window.contains(value) && !pending) [[likely]]
+        {
+            registers[RegAlias::pc] = value;
+            return;
+        }
+        update_pc(value);
+    }
     /// increment PC value
-    void inc_pc();
+    void inc_pc()
+    {
+        set_pc(get_pc() + sizeof(opcode::opcode_t));
+    }
 
     /// get pointer to memory
     [[nodiscard]]
@@ -90,6 +178,22 @@ struct basic_vm: public vm_interface
     [[nodiscard]]
     const memory_block *get_ptr_ro(address_t address, uint8_t size) const;
 
+    /**
+     * writable view of guest memory for host code, e.g. syscall handlers
+     *
+     * predecoded and translated code in range is dropped: view is expected to be written
+     * @return nullopt if range is not mapped, crosses boundary of blocks or block has no host memory
+     */
+    [[nodiscard]]
+    std::optional<std::span<std::byte>> get_guest_span(address_t address, size_t size);
+
+    /**
+     * read-only view of guest memory for host code
+     * @return nullopt if range is not mapped, crosses boundary of blocks or block has no host memory
+     */
+    [[nodiscard]]
+    std::optional<std::span<const std::byte>> get_guest_span(address_t address, size_t size) const;
+
     /// set ro memory size
     [[nodiscard]]
     bool set_ro_size(size_t size);
@@ -107,11 +211,31 @@ struct basic_vm: public vm_interface
     bool set_rw_base(address_t base);
 
     /// single emulation step
-    void run_step();
-
-    /// run emulation cycle
+    /// @return trap of executed instruction, PC is not changed on trap
+    trap run_step();
+
+    /// run emulation cycle until halt or trap
+    /// @return trap which stopped VM
+    trap run_until_trap();
+
+    /**
+     * run at most budget instructions
+     *
+     * budget is checked once per basic block
+     * @param budget max num of instructions
+     * @return reason of stop and num of retired instructions
+     */
+    run_result run_for(std::uint64_t budget);
+
+    /// run emulation cycle, throws on trap
     void run();
 
+    /// select execution engine used by run()
+    void set_engine(engine_type type);
+
+    [[nodiscard]]
+    engine_type get_engine() const;
+
     /// init VM: clear memory/registers
     void start();
 
@@ -131,9 +255,29 @@ struct basic_vm: public vm_interface
     [[nodiscard]]
     bool init_memory(size_t code_size, size_t data_size);
 
+    /**
+     * reserve whole guest address space on host
+     *
+     * page aligned blocks added by add_memory() are committed in reserved space,
+     * so native code accesses them without bounds checks.
+     * should be called before any memory is added
+     * @return false if reservation is not supported or memory is added
+     */
+    [[nodiscard]]
+    bool enable_guest_space();
+
+    [[nodiscard]]
+    bool is_guest_space_enabled() const;
+
+    /// add RAM block, committed in guest space if enabled
+    /// pages of block are committed on first write
     [[nodiscard]]
     bool add_memory(address_t address, size_t size);
 
+    /// num of bytes of guest memory backed by host memory
+    [[nodiscard]]
+    std::uint64_t get_committed_memory() const;
+
     [[nodiscard]]
     bool add_memory(memory_block::ptr ptr);
 
@@ -147,10 +291,37 @@ struct basic_vm: public vm_interface
     [[nodiscard]]
     bool set_program(const program_code_t &bin, address_t pc_value);
 
+    /// map shared image into ro memory, pages are copied on first write
+    /// image is copied if code block can not map it
+    [[nodiscard]]
+    bool set_program(const program_image &image, address_t pc_value);
+
+    /**
+     * map shared image into memory at address, e.g. initialized data section
+     *
+     * pages are copied on first write, image is copied if block can not map it
+     * @return false if image does not fit into block
+     */
+    [[nodiscard]]
+    bool load_image(const program_image &image, address_t address);
+
     /// load program into ro memory
     [[nodiscard]]
     bool set_program(const hex_file &hex);
 
+    /// load program from IntelHEX stream, records are decoded straight into memory
+    [[nodiscard]]
+    bool set_program(std::istream &hex);
+
+    /**
+     * load segments of executable, PC is set to entry point
+     *
+     * segments should fit into memory blocks,
+     * .bss is not touched: blocks are zeroed on demand
+     */
+    [[nodiscard]]
+    bool set_program(const elf_file &elf);
+
     [[nodiscard]]
     bool init_pc(address_t address);
 
@@ -175,6 +346,44 @@ struct basic_vm: public vm_interface
     void enable_debugging(bool enable);
     void syscall_should_throw(bool enable);
 
+    [[nodiscard]]
+    bool is_predecode_enabled() const;
+
+    /// cache decoded instructions of code block
+    /// applied on start()
+    void enable_predecode(bool enable);
+
+    /// directory of predecode cache files, empty path disables it
+    [[nodiscard]]
+    const std::filesystem::path& get_decode_cache() const;
+
+    /**
+     * keep predecoded program in directory
+     *
+     * applied on start() if predecode is enabled: slots are loaded from file
+     * keyed by hash of program, missing or stale file is rebuilt
+     */
+    void set_decode_cache(const std::filesystem::path& directory);
+
+    /// slots were loaded from cache file on last start()
+    [[nodiscard]]
+    bool is_decode_cache_hit() const;
+
+    [[nodiscard]]
+    bool is_fusion_enabled() const;
+
+    /// fuse common pairs of instructions on block translation
+    /// applied on start()
+    void enable_fusion(bool enable);
+
+    /// num of executed fused pairs since start()
+    [[nodiscard]]
+    const fusion::counters& get_fusion_stats() const;
+
+    /// hits and misses of memory TLB since start()
+    [[nodiscard]]
+    const memory_tlb::stats& get_tlb_stats() const;
+
     syscall_registry& get_syscalls();
 
     void dump_state(std::ostream& dump) const;
@@ -183,6 +392,122 @@ private:
     [[nodiscard]]
     const opcode::Decoder* get_current() const;
 
+    /// get predecoded current instruction
+    /// @return nullptr if PC outside of cached region
+    [[nodiscard]]
+    const decoded_instruction* get_decoded();
+
+    /// run at most budget instructions by single steps
+    [[nodiscard]]
+    run_result run_steps(std::uint64_t budget);
+
+    /// run at most budget instructions by basic blocks
+    [[nodiscard]]
+    run_result run_blocks(std::uint64_t budget);
+
+    /// set PC outside of cached code window
+    void update_pc(register_t value);
+
+    /// register trap of current instruction, first trap wins
+    void set_trap(trap_cause cause, register_t address);
+
+    /// get and clear pending trap
+    [[nodiscard]]
+    trap take_trap()
+    {
+        auto result = pending;
+        pending = {};
+        return result;
+    }
+
+    /// get block for current PC, translate if needed
+    /// @return nullptr on trap
+    [[nodiscard]]
+    basic_block* next_block(basic_block* prev);
+
+    /// translate block starting at address
+    /// @return nullptr on trap
+    [[nodiscard]]
+    basic_block* translate(address_t address);
+
+    /// execute translated block
+    /// @return num of retired instructions
+    size_t exec_block(const basic_block& block);
+
+    /// execute compiled block
+    /// @return num of retired instructions
+    size_t exec_native(const basic_block& block);
+
+    /// execute predecoded instruction
+    void exec(const decoded_instruction& op)
+    {
+        if (op.exec) [[likely]]
+        {
+            op.exec(this, op);
+        }
+        else
+        {
+            op.handler->exec(this, &op.code);
+        }
+    }
+
+    /// bind handler bodies instantiated for basic_vm
+    template<typename... Handlers>
+    void bind_handlers(handler_list<Handlers...>);
+
+    /// bind bodies of fused pairs instantiated for basic_vm
+    template<typename... Handlers>
+    void bind_fused(handler_list<Handlers...>);
+
+    /// body of fused pair, counts executions
+    template<typename Handler>
+    static void exec_fused(vm_interface* vm, const decoded_instruction& op);
+
+    /// set static executor of decoded instruction
+    void bind(decoded_instruction& op) const;
+
+    /// throw error for wrong register ID
+    [[noreturn]]
+    static void register_error(register_no r);
+
+    /// state of IntelHEX loading
+    struct hex_loader
+    {
+        /// max size of run of contiguous data records
+        static constexpr size_t max_run = 64 * 1024;
+
+        /// offset for next data records
+        address_t offset = 0;
+        /// entry point
+        address_t pc_value = 0;
+        /// EOF record is loaded
+        bool finished = false;
+        /// start address of run
+        address_t run_start = 0;
+        /// data of contiguous records, written at once
+        std::vector<std::uint8_t> run;
+    };
+
+    /// load IntelHEX record into memory
+    [[nodiscard]]
+    bool load_record(hex_loader& loader, const hex_record_view& record);
+
+    /// write run of data records, block is resolved once per run
+    [[nodiscard]]
+    bool flush_run(hex_loader& loader);
+
+    /// write contiguous data, may cross boundary of blocks
+    [[nodiscard]]
+    bool store_run(address_t address, std::span<const std::uint8_t> data);
+
+    /// extend loaded program by data written into code block
+    void add_program_range(address_t address, size_t size);
+
+    /// fill predecode slots of program from cache file, rebuild file if it is missing or stale
+    void load_decode_cache();
+
+    friend struct jit_compiler;
+
     using init_flags_t = std::uint8_t;
     enum InitFlag: init_flags_t
     {
@@ -212,8 +537,16 @@ private:
     bool have_data_block() const;
 
     registry opcodes;
+    /// handler -> handler body for basic_vm
+    std::unordered_map<registry::handler_ptr, decoded_instruction::exec_fn> static_exec;
     syscall_registry syscalls;
+    /// reserved guest address space, nullptr if disabled
+    guest_space::ptr space;
     memory_management_unit mmu;
+    memory_tlb tlb;
+    predecode_cache predecode;
+    block_cache blocks;
+    std::unique_ptr<jit_compiler> jit;
 
     /// registers container
     register_file registers{};
@@ -235,6 +568,47 @@ private:
     bool debugging = false;
 
     bool syscall_throw_on_error = true;
+
+    bool predecode_enabled = false;
+
+    /// directory of predecode cache files
+    std::filesystem::path decode_cache;
+    /// size of program loaded from start of code block
+    size_t program_size = 0;
+    bool decode_cache_hit = false;
+
+    bool fusion_enabled = true;
+    /// fusion is used by translated code
+    bool fusion_active = false;
+    fusion::counters fusion_hits{};
+
+    engine_type engine = engine_type::interpreter;
+
+    /// trap of current instruction
+    trap pending{};
+
+    /// memory block of PC, checked before full lookup
+    struct code_window
+    {
+        address_t start = 0;
+        /// size of block minus size of instruction, 0 - empty window
+        address_t limit = 0;
+        const memory_block* block = nullptr;
+
+        [[nodiscard]]
+        bool contains(address_t address) const noexcept
+        {
+            return (address - start) < limit;
+        }
+    };
+    code_window pc_window{};
+
+    /// stop execution of current block
+    bool block_interrupt = false;
+    /// debug break was executed
+    bool breakpoint = false;
+    /// translated code was modified
+    bool blocks_flush = false;
 };
 
 } // namespace vm
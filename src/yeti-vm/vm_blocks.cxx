@@ -0,0 +1,50 @@
+#include "vm_blocks.hxx"
+
+namespace vm
+{
+
+void basic_block::link(basic_block *next) noexcept
+{
+    for (auto& slot: successors)
+    {
+        if (!slot)
+        {
+            slot = next;
+            return;
+        }
+    }
+    successors.back() = next;
+}
+
+bool basic_block::is_terminator(const decoded_instruction &op)
+{
+    return op.handler->skip() || (op.code.get_code() == opcode::SYSTEM);
+}
+
+basic_block *block_cache::find(block_cache::address_type address) const
+{
+    auto it = blocks.find(address);
+    if (it != blocks.end())
+    {
+        return it->second.get();
+    }
+    return nullptr;
+}
+
+basic_block *block_cache::insert(basic_block::ptr block)
+{
+    const auto address = block->start;
+    code_start = std::min(code_start, address);
+    code_end = std::max(code_end, block->end());
+    auto [it, ok] = blocks.try_emplace(address, std::move(block));
+    return it->second.get();
+}
+
+void block_cache::clear()
+{
+    blocks.clear();
+    code_start = ~address_type{0};
+    code_end = 0;
+}
+
+} // namespace vm
@@ -0,0 +1,123 @@
+/// basic blocks of translated code
+#pragma once
+
+#include "vm_base_types.hxx"
+#include "vm_predecode.hxx"
+
+#include <memory>
+
+namespace vm
+{
+
+/**
+ * sequence of instructions with single entry
+ *
+ * block ends on jump/branch/system instruction
+ */
+struct basic_block
+{
+    using address_type = std::uint32_t;
+    using ptr = std::unique_ptr<basic_block>;
+    /// compiled block, argument is backend specific context
+    using native_function = std::uint32_t (*)(void* context);
+
+    /// max num of instructions in block
+    static constexpr size_t max_size = 64;
+    /// max num of chained blocks
+    static constexpr size_t max_successors = 2;
+
+    /// address of first instruction
+    address_type start = 0;
+    /// pre-bound micro-ops
+    std::vector<decoded_instruction> ops;
+    /// num of guest instructions, fused pairs are counted twice
+    size_t count = 0;
+    /// chained blocks
+    std::array<basic_block*, max_successors> successors{};
+    /// num of executions by interpreter
+    std::uint32_t hits = 0;
+    /// native code, nullptr if block is not compiled
+    native_function native = nullptr;
+
+    /// address after last instruction
+    [[nodiscard]]
+    address_type end() const noexcept
+    {
+        return start + static_cast<address_type>(count * sizeof(opcode::opcode_t));
+    }
+
+    /// find chained block by start address
+    [[nodiscard]]
+    basic_block* find_successor(address_type address) const noexcept
+    {
+        for (auto next: successors)
+        {
+            if (next && next->start == address)
+                return next;
+        }
+        return nullptr;
+    }
+
+    /// chain block, replaces last successor if no free slots
+    void link(basic_block* next) noexcept;
+
+    /// instruction ends block
+    [[nodiscard]]
+    static bool is_terminator(const decoded_instruction& op);
+};
+
+/**
+ * container of translated blocks
+ */
+struct block_cache
+{
+    using address_type = basic_block::address_type;
+    using size_type = std::uint32_t;
+    using block_map = std::unordered_map<address_type, basic_block::ptr>;
+
+    /// find block by start address
+    [[nodiscard]]
+    basic_block* find(address_type address) const;
+
+    /// add translated block
+    basic_block* insert(basic_block::ptr block);
+
+    /// drop all blocks
+    void clear();
+
+    /// range overlaps translated code
+    [[nodiscard]]
+    bool overlaps(address_type address, size_type size) const noexcept
+    {
+        return (address < code_end) && (std::uint64_t{address} + size > code_start);
+    }
+
+    /// start of translated code
+    [[nodiscard]]
+    address_type get_code_start() const noexcept
+    {
+        return code_start;
+    }
+
+    /// size of translated code, 0 if there are no blocks
+    [[nodiscard]]
+    size_type get_code_size() const noexcept
+    {
+        return code_end > code_start ? code_end - code_start : 0;
+    }
+
+    /// num of translated blocks
+    [[nodiscard]]
+    size_t size() const noexcept
+    {
+        return blocks.size();
+    }
+private:
+    block_map blocks;
+    /// start of translated code
+    address_type code_start = ~address_type{0};
+    /// end of translated code
+    address_type code_end = 0;
+};
+
+} // namespace vm
@@ -0,0 +1,130 @@
+#include "vm_console.hxx"
+
+#include <algorithm>
+#include <charconv>
+
+namespace vm
+{
+
+namespace
+{
+
+/// errors returned by write(), as in Linux
+constexpr auto error_bad_file = static_cast<register_t>(-9);
+constexpr auto error_fault = static_cast<register_t>(-14);
+
+void put_int(vm_interface* vm, void* context)
+{
+    char text[16];
+    auto [end, ec] = std::to_chars(std::begin(text), std::end(text), to_signed(vm->get_register(RegAlias::a0)));
+    static_cast<console*>(context)->write({text, end});
+    vm->set_register(RegAlias::a0, 0);
+}
+
+void put_char(vm_interface* vm, void* context)
+{
+    static_cast<console*>(context)->put(static_cast<char>(vm->get_register(RegAlias::a0)));
+    vm->set_register(RegAlias::a0, 0);
+}
+
+void write_buffer(vm_interface* vm, void* context)
+{
+    // registered in registry of basic_vm only
+    auto* machine = static_cast<basic_vm*>(vm);
+    const auto fd = vm->get_register(RegAlias::a0);
+    const auto address = vm->get_register(RegAlias::a1);
+    const auto size = vm->get_register(RegAlias::a2);
+    if (fd != 1 && fd != 2) [[unlikely]]
+    {
+        vm->set_register(RegAlias::a0, error_bad_file);
+        return;
+    }
+    bool ok = static_cast<console*>(context)->write(*machine, address, size);
+    vm->set_register(RegAlias::a0, ok ? size : error_fault);
+}
+
+} // namespace
+
+console::console(std::ostream &output)
+    : output{output}
+{}
+
+console::~console()
+{
+    flush();
+}
+
+void console::write(std::string_view text)
+{
+    if (text.size() >= capacity)
+    {
+        flush();
+        output.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return;
+    }
+    if (text.size() > capacity - used)
+    {
+        flush();
+    }
+    std::copy(text.begin(), text.end(), buffer.begin() + used);
+    used += text.size();
+    if (used == capacity || text.find('\n') != std::string_view::npos)
+    {
+        flush();
+    }
+}
+
+bool console::write(basic_vm &machine, register_t address, register_t size)
+{
+    while (size != 0)
+    {
+        // guest buffer is copied into free space of buffer, block is resolved once per part
+        const auto* block = machine.get_ptr_ro(address, 1);
+        if (!block) [[unlikely]]
+        {
+            return false;
+        }
+        const auto& params = block->get_params();
+        const auto available = std::uint64_t{params.block_start} + params.block_size - address;
+        const auto part = static_cast<register_t>(std::min<std::uint64_t>({size, available, capacity - used}));
+        if (!block->load(address, buffer.data() + used, part)) [[unlikely]]
+        {
+            return false;
+        }
+        const auto* text = buffer.data() + used;
+        used += part;
+        address += part;
+        size -= part;
+        if (used == capacity || std::find(text, text + part, '\n') != text + part)
+        {
+            flush();
+        }
+    }
+    return true;
+}
+
+void console::flush()
+{
+    if (used == 0) return;
+    output.write(buffer.data(), static_cast<std::streamsize>(used));
+    output.flush();
+    used = 0;
+}
+
+bool console::register_syscalls(basic_vm &machine)
+{
+    return machine.get_syscalls().is_free({put_int_id, put_char_id, write_id})
+        && register_print(machine)
+        && machine.get_syscalls().register_handler(write_id, "write", write_buffer, this);
+}
+
+bool console::register_print(basic_vm &machine)
+{
+    auto& sys = machine.get_syscalls();
+    if (!sys.is_free({put_int_id, put_char_id})) return false;
+    bool ok = sys.register_handler(put_int_id, "put_int", put_int, this);
+    ok = ok && sys.register_handler(put_char_id, "put_char", put_char, this);
+    return ok;
+}
+
+} // namespace vm
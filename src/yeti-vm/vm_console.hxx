@@ -0,0 +1,87 @@
+/// buffered console of guest
+#pragma once
+
+#include "vm_basic.hxx"
+
+#include <array>
+#include <ostream>
+#include <string_view>
+
+namespace vm
+{
+
+/**
+ * console device of guest
+ *
+ * output is collected in host buffer and written to stream
+ * on newline, on full buffer, by flush() and on destruction
+ */
+struct console
+{
+    /// size of host buffer
+    static constexpr size_t capacity = 4096;
+
+    /// syscall IDs
+    enum syscall_id: register_t
+    {
+        /// put_int(value): print signed integer
+        put_int_id = 1,
+        /// put_char(value): print char
+        put_char_id = 11,
+        /// write(fd, buffer, size): print guest buffer, fd 1 and 2 share console
+        write_id = 64,
+    };
+
+    explicit console(std::ostream& output);
+    console(const console&) = delete;
+    console& operator=(const console&) = delete;
+    ~console();
+
+    /// print char
+    void put(char value)
+    {
+        buffer[used++] = value;
+        if (value == '\n' || used == capacity) [[unlikely]]
+        {
+            flush();
+        }
+    }
+
+    /// print text
+    void write(std::string_view text);
+
+    /**
+     * print guest buffer
+     *
+     * buffer may cross boundary of memory blocks
+     * @return false if range is not mapped, text before gap is printed
+     */
+    [[nodiscard]]
+    bool write(basic_vm& machine, register_t address, register_t size);
+
+    /// write buffer to stream
+    void flush();
+
+    /**
+     * register put_int, put_char and write syscalls
+     *
+     * console should outlive machine
+     * @return false if ID is used, nothing is registered
+     */
+    [[nodiscard]]
+    bool register_syscalls(basic_vm& machine);
+
+    /**
+     * register put_int and put_char only, write is provided by other layer
+     * @see linux_abi
+     * @return false if ID is used, nothing is registered
+     */
+    [[nodiscard]]
+    bool register_print(basic_vm& machine);
+private:
+    std::ostream& output;
+    size_t used = 0;
+    std::array<char, capacity> buffer{};
+};
+
+} // namespace vm
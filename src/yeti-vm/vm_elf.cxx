@@ -0,0 +1,194 @@
+#include "vm_elf.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vm
+{
+
+namespace
+{
+
+/// @see System V ABI, chapter 4 "Object Files"
+struct elf_header
+{
+    std::uint8_t ident[16];
+    std::uint16_t type;
+    std::uint16_t machine;
+    std::uint32_t version;
+    std::uint32_t entry;
+    std::uint32_t phoff;
+    std::uint32_t shoff;
+    std::uint32_t flags;
+    std::uint16_t ehsize;
+    std::uint16_t phentsize;
+    std::uint16_t phnum;
+    std::uint16_t shentsize;
+    std::uint16_t shnum;
+    std::uint16_t shstrndx;
+};
+
+struct program_header
+{
+    std::uint32_t type;
+    std::uint32_t offset;
+    std::uint32_t vaddr;
+    std::uint32_t paddr;
+    std::uint32_t filesz;
+    std::uint32_t memsz;
+    std::uint32_t flags;
+    std::uint32_t align;
+};
+
+struct section_header
+{
+    std::uint32_t name;
+    std::uint32_t type;
+    std::uint32_t flags;
+    std::uint32_t addr;
+    std::uint32_t offset;
+    std::uint32_t size;
+    std::uint32_t link;
+    std::uint32_t info;
+    std::uint32_t addralign;
+    std::uint32_t entsize;
+};
+
+struct symbol_entry
+{
+    std::uint32_t name;
+    std::uint32_t value;
+    std::uint32_t size;
+    std::uint8_t info;
+    std::uint8_t other;
+    std::uint16_t shndx;
+};
+
+static_assert(sizeof(elf_header) == 52);
+static_assert(sizeof(program_header) == 32);
+static_assert(sizeof(section_header) == 40);
+static_assert(sizeof(symbol_entry) == 16);
+
+constexpr std::uint8_t elf_magic[] = {0x7f, 'E', 'L', 'F'};
+constexpr std::uint8_t class_32 = 1;
+constexpr std::uint8_t data_lsb = 1;
+constexpr std::uint16_t type_exec = 2;
+constexpr std::uint16_t machine_riscv = 243;
+constexpr std::uint32_t segment_load = 1;
+constexpr std::uint32_t section_symtab = 2;
+constexpr std::uint8_t symbol_object = 1;
+constexpr std::uint8_t symbol_func = 2;
+
+/// read entry from image, false if entry is out of range
+template<typename T>
+bool read_entry(std::span<const std::uint8_t> data, std::uint64_t offset, T& entry)
+{
+    if (offset > data.size() || sizeof(T) > data.size() - offset)
+        return false;
+    std::memcpy(&entry, data.data() + offset, sizeof(T));
+    return true;
+}
+
+/// load functions and objects from first symbol table
+bool read_symbols(std::span<const std::uint8_t> data, const elf_header& header, std::vector<elf_symbol>& symbols)
+{
+    if (header.shoff == 0 || header.shnum == 0)
+        return true; // stripped
+    if (header.shentsize != sizeof(section_header))
+        return false;
+
+    for (std::uint32_t i = 0; i < header.shnum; ++i)
+    {
+        section_header table{};
+        if (!read_entry(data, header.shoff + std::uint64_t{i} * sizeof(section_header), table))
+            return false;
+        if (table.type != section_symtab)
+            continue;
+
+        section_header strings{};
+        if (table.link >= header.shnum
+            || !read_entry(data, header.shoff + std::uint64_t{table.link} * sizeof(section_header), strings)
+            || std::uint64_t{strings.offset} + strings.size > data.size())
+            return false;
+        const auto names = data.subspan(strings.offset, strings.size);
+
+        for (std::uint32_t offset = 0; offset + sizeof(symbol_entry) <= table.size; offset += sizeof(symbol_entry))
+        {
+            symbol_entry symbol{};
+            if (!read_entry(data, std::uint64_t{table.offset} + offset, symbol))
+                return false;
+            const auto type = symbol.info & 0xf;
+            if ((type != symbol_func && type != symbol_object) || symbol.shndx == 0 || symbol.name >= names.size())
+                continue;
+            const auto* first = reinterpret_cast<const char*>(names.data() + symbol.name);
+            const auto* last = std::find(first, reinterpret_cast<const char*>(names.data() + names.size()), '\0');
+            symbols.push_back({std::string{first, last}, symbol.value, symbol.size});
+        }
+        break;
+    }
+    std::sort(symbols.begin(), symbols.end(), [](const auto& a, const auto& b) { return a.address < b.address; });
+    return true;
+}
+
+} // namespace
+
+elf_file::ptr elf_file::open(const std::filesystem::path &file)
+{
+    const auto image = program_image::open(file);
+    return image ? parse(*image) : nullptr;
+}
+
+elf_file::ptr elf_file::parse(const program_image &image)
+{
+    const auto data = image.get_data();
+    elf_header header{};
+    if (!read_entry(data, 0, header))
+        return nullptr;
+    if (!std::equal(std::begin(elf_magic), std::end(elf_magic), header.ident)
+        || header.ident[4] != class_32 || header.ident[5] != data_lsb
+        || header.type != type_exec || header.machine != machine_riscv
+        || header.phentsize != sizeof(program_header))
+        return nullptr;
+
+    std::shared_ptr<elf_file> elf{new elf_file{}};
+    elf->entry = header.entry;
+    for (std::uint32_t i = 0; i < header.phnum; ++i)
+    {
+        program_header segment{};
+        if (!read_entry(data, header.phoff + std::uint64_t{i} * sizeof(program_header), segment))
+            return nullptr;
+        if (segment.type != segment_load || segment.memsz == 0)
+            continue;
+        if (segment.filesz > segment.memsz || std::uint64_t{segment.vaddr} + segment.memsz > (std::uint64_t{1} << 32))
+            return nullptr;
+        // aligned segments share pages with file, others are copied
+        auto content = image.get_slice(segment.offset, segment.filesz);
+        if (!content)
+            return nullptr;
+        elf->segments.push_back({segment.vaddr, segment.memsz, std::move(content)});
+    }
+    std::sort(elf->segments.begin(), elf->segments.end(),
+              [](const auto& a, const auto& b) { return a.address < b.address; });
+
+    if (!read_symbols(data, header, elf->symbols))
+        return nullptr;
+    return elf;
+}
+
+const elf_symbol *elf_file::find_symbol(register_t address) const
+{
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+                               [](auto value, const auto& symbol) { return value < symbol.address; });
+    // labels without size do not hide enclosing function
+    while (it != symbols.begin())
+    {
+        --it;
+        if (address - it->address < std::max<register_t>(it->size, 1))
+            return &*it;
+        if (it->size != 0)
+            break;
+    }
+    return nullptr;
+}
+
+} // namespace vm
@@ -0,0 +1,89 @@
+/// loader of RV32 executables in ELF format
+#pragma once
+
+#include "vm_program_image.hxx"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace vm
+{
+
+/// loadable segment(PT_LOAD) of executable
+struct elf_segment
+{
+    /// guest address of segment
+    register_t address = 0;
+    /// size of segment in memory, tail after file data is zeroed(.bss)
+    register_t memory_size = 0;
+    /// file data of segment
+    program_image::ptr image;
+};
+
+/// symbol from symbol table
+struct elf_symbol
+{
+    std::string name;
+    register_t address = 0;
+    register_t size = 0;
+};
+
+/**
+ * parsed RV32 executable
+ *
+ * file is mapped once and may be loaded into many VMs,
+ * segments aligned by host page are mapped from page cache
+ */
+struct elf_file
+{
+    using ptr = std::shared_ptr<const elf_file>;
+
+    /**
+     * open and parse executable
+     * @return nullptr if file is not little-endian RV32 executable or it is broken
+     */
+    [[nodiscard]]
+    static ptr open(const std::filesystem::path& file);
+
+    /**
+     * parse executable from image
+     * @return nullptr if image is not little-endian RV32 executable or it is broken
+     */
+    [[nodiscard]]
+    static ptr parse(const program_image& image);
+
+    /// entry point
+    [[nodiscard]]
+    register_t get_entry() const noexcept
+    {
+        return entry;
+    }
+
+    /// loadable segments ordered by address
+    [[nodiscard]]
+    const std::vector<elf_segment>& get_segments() const noexcept
+    {
+        return segments;
+    }
+
+    /// functions and objects ordered by address
+    [[nodiscard]]
+    const std::vector<elf_symbol>& get_symbols() const noexcept
+    {
+        return symbols;
+    }
+
+    /**
+     * find symbol which contains address
+     * @return nullptr if address is not covered by symbols
+     */
+    [[nodiscard]]
+    const elf_symbol* find_symbol(register_t address) const;
+private:
+    register_t entry = 0;
+    std::vector<elf_segment> segments;
+    std::vector<elf_symbol> symbols;
+};
+
+} // namespace vm
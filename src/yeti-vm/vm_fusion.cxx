@@ -0,0 +1,130 @@
+#include "vm_fusion.hxx"
+#include "vm_handlers_rv32i.hxx"
+
+#include <typeinfo>
+
+namespace vm::fusion
+{
+
+namespace
+{
+
+/// instruction is handled by Handler
+template<typename Handler>
+bool is(const decoded_instruction& op)
+{
+    return op.handler != nullptr && typeid(*op.handler) == typeid(Handler);
+}
+
+/// second instruction of pair reads result of first one as rs1
+bool is_chained(const decoded_instruction& first, const decoded_instruction& second)
+{
+    return first.rd != zero && second.rs1 == first.rd;
+}
+
+/// second instruction of pair compares result of first one with zero
+bool is_zero_test(const decoded_instruction& first, const decoded_instruction& second)
+{
+    return first.rd != zero && (
+        (second.rs1 == first.rd && second.rs2 == zero) ||
+        (second.rs1 == zero && second.rs2 == first.rd));
+}
+
+/// jump target of pair is aligned: misaligned jump traps at second instruction, pair is not fused
+bool is_aligned(register_t target)
+{
+    return target % sizeof(opcode::opcode_t) == 0;
+}
+
+/// make fused instruction
+template<typename Handler>
+decoded_instruction make(const decoded_instruction& first)
+{
+    decoded_instruction result;
+    result.handler = get_handler<Handler>();
+    result.code = first.code;
+    result.size = 2;
+    result.rd = first.rd;
+    result.rs1 = first.rs1;
+    result.rs2 = first.rs2;
+    return result;
+}
+
+/// make compare and branch pair
+template<typename Handler>
+decoded_instruction make_set_branch(const decoded_instruction& first, const decoded_instruction& second, register_t address)
+{
+    auto result = make<Handler>(first);
+    result.imm = address;
+    result.imm2 = address + sizeof(opcode::opcode_t) + second.imm;
+    return result;
+}
+
+} // namespace
+
+std::string_view get_name(kind id)
+{
+    switch (id)
+    {
+        case kind::lui_addi:   return "lui+addi";
+        case kind::auipc_addi: return "auipc+addi";
+        case kind::auipc_jalr: return "auipc+jalr";
+        case kind::slli_add:   return "slli+add";
+        case kind::slt_beq:    return "slt+beq";
+        case kind::slt_bne:    return "slt+bne";
+        case kind::sltu_beq:   return "sltu+beq";
+        case kind::sltu_bne:   return "sltu+bne";
+    }
+    return "unknown";
+}
+
+decoded_instruction fuse(const decoded_instruction& first, const decoded_instruction& second, register_t address)
+{
+    const bool is_lui = is<rv32i::lui>(first);
+    const bool is_auipc = is<rv32i::auipc>(first);
+
+    if ((is_lui || is_auipc) && is<rv32i::addi>(second) && is_chained(first, second) && second.rd == first.rd)
+    {
+        auto result = is_lui ? make<li>(first) : make<la>(first);
+        result.imm = first.imm + second.imm + (is_auipc ? address : 0);
+        return result;
+    }
+    if (is_auipc && is<rv32i::jalr>(second) && is_chained(first, second))
+    {
+        const auto target = (address + first.imm + second.imm) & ~register_t{1};
+        if (!is_aligned(target)) return {};
+        auto result = make<call>(first);
+        result.imm = address;
+        result.imm2 = target;
+        result.rd2 = second.rd;
+        return result;
+    }
+    if (is<rv32i::slli>(first) && is<rv32i::add_r>(second) && first.rd != zero &&
+        (second.rs1 == first.rd || second.rs2 == first.rd))
+    {
+        auto result = make<shift_add>(first);
+        result.imm = first.imm & 0x1f;
+        result.rd2 = second.rd;
+        // add is commutative: rs2 is operand other than result of shift
+        result.rs2 = (second.rs1 == first.rd) ? second.rs2 : second.rs1;
+        return result;
+    }
+    if (is_zero_test(first, second) && is_aligned(address + sizeof(opcode::opcode_t) + second.imm))
+    {
+        const bool is_beq = is<rv32i::beq>(second);
+        const bool is_bne = is<rv32i::bne>(second);
+        if (is<rv32i::slt_r>(first))
+        {
+            if (is_beq) return make_set_branch<slt_beq>(first, second, address);
+            if (is_bne) return make_set_branch<slt_bne>(first, second, address);
+        }
+        else if (is<rv32i::sltu_r>(first))
+        {
+            if (is_beq) return make_set_branch<sltu_beq>(first, second, address);
+            if (is_bne) return make_set_branch<sltu_bne>(first, second, address);
+        }
+    }
+    return {};
+}
+
+} // namespace vm::fusion
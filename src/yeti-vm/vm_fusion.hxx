@@ -0,0 +1,169 @@
+/// superinstructions: fused pairs of common RV32 instructions
+#pragma once
+
+#include "vm_base_types.hxx"
+#include "vm_handler.hxx"
+#include "vm_predecode.hxx"
+#include "vm_utility.hxx"
+
+#include <array>
+#include <stdexcept>
+
+namespace vm::fusion
+{
+
+/// kind of fused pair, index of hit counter
+enum class kind: std::uint8_t
+{
+    /// li: lui + addi
+    lui_addi,
+    /// la: auipc + addi
+    auipc_addi,
+    /// call: auipc + jalr
+    auipc_jalr,
+    /// scaled index: slli + add
+    slli_add,
+    /// compare and branch: slt + beq
+    slt_beq,
+    /// compare and branch: slt + bne
+    slt_bne,
+    /// compare and branch: sltu + beq
+    sltu_beq,
+    /// compare and branch: sltu + bne
+    sltu_bne,
+};
+
+/// num of fused pair kinds
+inline constexpr size_t kind_count = 8;
+
+/// execution counter for each kind of fused pair
+using counters = std::array<std::uint64_t, kind_count>;
+
+/// name of fused pair
+[[nodiscard]]
+std::string_view get_name(kind id);
+
+/**
+ * generic handler of fused pair
+ *
+ * executable only in decoded form: invoke(VM*, const decoded_instruction&)
+ * @tparam Kind kind of pair
+ * @tparam Jump pair ends with jump
+ */
+template<kind Kind, bool Jump>
+struct pair: public interface
+{
+    static constexpr kind id = Kind;
+
+    [[nodiscard]]
+    const InstructionId& get_id() const final
+    {
+        static const InstructionId id{0, opcode::UNKNOWN, no_func_a, no_func_b};
+        return id;
+    }
+    [[nodiscard]]
+    opcode::opcode_t get_code_base() const final { return 0; }
+    [[nodiscard]]
+    opcode::opcode_t get_func_a() const final { return no_func_a; }
+    [[nodiscard]]
+    opcode::opcode_t get_func_b() const final { return no_func_b; }
+    [[nodiscard]]
+    std::string_view get_mnemonic() const final { return get_name(Kind); }
+    [[nodiscard]]
+    std::string get_args(opcode::opcode_t code) const final { return opcode::to_hex(code); }
+    [[nodiscard]]
+    opcode::BaseFormat get_type() const final { return opcode::UNKNOWN; }
+    [[nodiscard]]
+    bool skip() const final { return Jump; }
+
+    void exec(vm_interface*, const opcode::Decoder*) const final
+    {
+        throw std::logic_error{"fused pair can be executed only in decoded form"};
+    }
+};
+
+/// rd = constant
+template<kind Kind>
+struct load_constant: pair<Kind, false>
+{
+    template<typename VM>
+    static void invoke(VM* vm, const decoded_instruction& op)
+    {
+        vm->set_register(op.rd, op.imm);
+    }
+};
+
+/// lui rd, hi; addi rd, rd, lo
+using li = load_constant<kind::lui_addi>;
+/// auipc rd, hi; addi rd, rd, lo
+using la = load_constant<kind::auipc_addi>;
+
+/// slli rt, rs1, imm; add rd2, rt, rs2
+struct shift_add: pair<kind::slli_add, false>
+{
+    template<typename VM>
+    static void invoke(VM* vm, const decoded_instruction& op)
+    {
+        auto value = vm->get_register(op.rs1) << op.imm;
+        vm->set_register(op.rd, value);
+        vm->set_register(op.rd2, value + vm->get_register(op.rs2));
+    }
+};
+
+/// auipc rd, hi; jalr rd2, rd, lo
+/// imm - address of pair, imm2 - jump target
+struct call: pair<kind::auipc_jalr, true>
+{
+    template<typename VM>
+    static void invoke(VM* vm, const decoded_instruction& op)
+    {
+        vm->set_register(op.rd, op.imm + op.code.decode_u());
+        vm->set_register(op.rd2, op.imm + 2 * sizeof(opcode::opcode_t));
+        vm->jump_abs(op.imm2);
+    }
+};
+
+/// slt(u) rd, rs1, rs2; beq/bne rd, zero, offset
+/// imm - address of pair, imm2 - jump target
+template<kind Kind, bool Unsigned, bool Equal>
+struct set_branch: pair<Kind, true>
+{
+    template<typename VM>
+    static void invoke(VM* vm, const decoded_instruction& op)
+    {
+        auto lhs = vm->get_register(op.rs1);
+        auto rhs = vm->get_register(op.rs2);
+        bool value = Unsigned ? (lhs < rhs) : (to_signed(lhs) < to_signed(rhs));
+        vm->set_register(op.rd, value);
+        bool taken = Equal ? !value : value;
+        vm->jump_abs(taken ? op.imm2 : op.imm + 2 * sizeof(opcode::opcode_t));
+    }
+};
+
+using slt_beq  = set_branch<kind::slt_beq,  false, true>;
+using slt_bne  = set_branch<kind::slt_bne,  false, false>;
+using sltu_beq = set_branch<kind::sltu_beq, true,  true>;
+using sltu_bne = set_branch<kind::sltu_bne, true,  false>;
+
+/// handlers of fused pairs
+using handlers = handler_list<li, la, call, shift_add, slt_beq, slt_bne, sltu_beq, sltu_bne>;
+
+/// shared instance of fused pair handler
+template<typename Handler>
+const interface* get_handler()
+{
+    static const Handler handler;
+    return &handler;
+}
+
+/**
+ * fuse pair of instructions
+ * @param first instruction at address
+ * @param second instruction at address + 4
+ * @param address address of first instruction
+ * @return fused instruction, handler is nullptr if pair can not be fused
+ */
+[[nodiscard]]
+decoded_instruction fuse(const decoded_instruction& first, const decoded_instruction& second, register_t address);
+
+} // namespace vm::fusion
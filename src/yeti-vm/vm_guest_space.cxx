@@ -0,0 +1,78 @@
+#include "vm_guest_space.hxx"
+
+#if defined(__unix__) && (UINTPTR_MAX > 0xffff'ffffu)
+#define YETI_GUEST_SPACE 1
+#include <sys/mman.h>
+#endif
+
+namespace vm
+{
+
+guest_space::guest_space(std::uint8_t *base)
+    : base{base}
+{}
+
+#ifdef YETI_GUEST_SPACE
+
+guest_space::~guest_space()
+{
+    munmap(base, space_size + guard_size);
+}
+
+bool guest_space::is_supported()
+{
+    return true;
+}
+
+guest_space::ptr guest_space::reserve()
+{
+    void* host = mmap(nullptr, space_size + guard_size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (host == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    return ptr{new guest_space{static_cast<std::uint8_t*>(host)}};
+}
+
+std::uint8_t *guest_space::commit(address_type address, size_type size)
+{
+    if (size == 0 || !is_aligned(address, size)) [[unlikely]]
+    {
+        return nullptr;
+    }
+    auto* host = base + address;
+    if (mprotect(host, size, PROT_READ | PROT_WRITE) != 0) [[unlikely]]
+    {
+        return nullptr;
+    }
+    return host;
+}
+
+#else // no reservation on host
+
+guest_space::~guest_space() = default;
+
+bool guest_space::is_supported()
+{
+    return false;
+}
+
+guest_space::ptr guest_space::reserve()
+{
+    return nullptr;
+}
+
+std::uint8_t *guest_space::commit(address_type, size_type)
+{
+    return nullptr;
+}
+
+#endif // YETI_GUEST_SPACE
+
+mapped_memory::mapped_memory(guest_space::ptr space, address_type address, size_type size)
+    : host_memory_block(address, size, space->get_base() + address)
+    , space{std::move(space)}
+{}
+
+} // namespace vm
@@ -0,0 +1,92 @@
+/// reserved host mapping of whole guest address space
+#pragma once
+
+#include "vm_memory.hxx"
+
+namespace vm
+{
+
+/**
+ * host mapping of 32-bit guest address space
+ *
+ * whole space is reserved without access, only registered blocks
+ * are committed, so guest address X is located at get_base() + X
+ * and access outside of committed blocks raises SIGSEGV
+ */
+struct guest_space
+{
+    using ptr = std::shared_ptr<guest_space>;
+    using address_type = memory_block::address_type;
+    using size_type = memory_block::size_type;
+
+    /// size of guest address space
+    static constexpr std::uint64_t space_size = std::uint64_t{1} << 32;
+    /// tail after end of space: access of last bytes does not leave mapping
+    static constexpr std::uint64_t guard_size = 64 * 1024;
+    /// granularity of commit
+    static constexpr size_type page_size = memory_management_unit::page_size;
+
+    guest_space(const guest_space&) = delete;
+    guest_space& operator=(const guest_space&) = delete;
+    ~guest_space();
+
+    /// reservation is available on host
+    [[nodiscard]]
+    static bool is_supported();
+
+    /**
+     * reserve address space
+     * @return nullptr if space can not be reserved
+     */
+    [[nodiscard]]
+    static ptr reserve();
+
+    /**
+     * make region accessible
+     * @param address start of region, aligned by page_size
+     * @param size size of region, aligned by page_size
+     * @return host address of region or nullptr
+     */
+    [[nodiscard]]
+    std::uint8_t* commit(address_type address, size_type size);
+
+    /// host address of guest address 0
+    [[nodiscard]]
+    std::uint8_t* get_base() const noexcept
+    {
+        return base;
+    }
+
+    /// host address is inside of reservation
+    [[nodiscard]]
+    bool contains(const void* host) const noexcept
+    {
+        auto offset = static_cast<const std::uint8_t*>(host) - base;
+        return offset >= 0 && static_cast<std::uint64_t>(offset) < space_size + guard_size;
+    }
+
+    /// region can be committed
+    [[nodiscard]]
+    static bool is_aligned(address_type address, size_type size) noexcept
+    {
+        return ((address | size) & (page_size - 1)) == 0;
+    }
+private:
+    explicit guest_space(std::uint8_t* base);
+
+    std::uint8_t* base = nullptr;
+};
+
+/**
+ * RAM block committed in guest space
+ */
+struct mapped_memory: host_memory_block
+{
+    /// space should contain committed region of block
+    mapped_memory(guest_space::ptr space, address_type address, size_type size);
+private:
+    /// keeps mapping alive
+    guest_space::ptr space;
+};
+
+} // namespace vm
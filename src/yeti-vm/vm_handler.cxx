@@ -6,6 +6,8 @@ namespace vm
 
 bool registry::register_handler(interface::ptr handler)
 {
+    ensure(handler->get_code_base() < group_count, handler->get_mnemonic());
+
     auto& id = handler->get_id();
     auto [it, ok] = handlers.try_emplace(id, handler);
 
@@ -16,14 +18,20 @@ bool registry::register_handler(interface::ptr handler)
     if (handler->get_func_b() != no_func_b)
         func_b.insert(handler->get_code_base() | (handler->get_func_a() << 8));
 
+    update_dispatch(handler->get_code_base());
+
     return ok;
 }
 
-registry::handler_ptr registry::find_handler(const opcode::Decoder *code) const
+registry::handler_ptr registry::lookup(const opcode::Decoder *code) const
+{
+    return lookup(code->get_code(), code->get_func3(), code->get_func7());
+}
+
+registry::handler_ptr registry::lookup(opcode::opcode_t op, opcode::opcode_t func_3, opcode::opcode_t func_7) const
 {
-    auto op = code->get_code();
-    auto funcA = func_a.contains(op) ? code->get_func3() : no_func_a;
-    auto funcB = func_b.contains(op | (code->get_func3() << 8)) ? code->get_func7() : no_func_b;
+    auto funcA = func_a.contains(op) ? func_3 : no_func_a;
+    auto funcB = func_b.contains(op | (func_3 << 8)) ? func_7 : no_func_b;
     InstructionId id{op, opcode::UNKNOWN, funcA, funcB};
     const auto handler = handlers.find(id);
     if (handler != handlers.end())
@@ -33,4 +41,31 @@ registry::handler_ptr registry::find_handler(const opcode::Decoder *code) const
 
     return nullptr;
 }
+
+void registry::update_dispatch(opcode::opcode_t op)
+{
+    auto& group = dispatch[op];
+    for (opcode::opcode_t func_3 = 0; func_3 < func_a_count; ++func_3)
+    {
+        auto& entry = group[func_3];
+        if (func_b.contains(op | (func_3 << 8)))
+        {
+            if (entry.func_b == no_func_b_table)
+            {
+                entry.func_b = static_cast<std::uint32_t>(func_b_tables.size());
+                func_b_tables.emplace_back();
+            }
+            auto& table = func_b_tables[entry.func_b];
+            for (opcode::opcode_t func_7 = 0; func_7 < func_b_count; ++func_7)
+            {
+                table[func_7] = lookup(op, func_3, func_7);
+            }
+            entry.handler = nullptr;
+        }
+        else
+        {
+            entry.handler = lookup(op, func_3, 0);
+        }
+    }
+}
 } // namespace vm
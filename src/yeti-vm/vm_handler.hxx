@@ -174,6 +174,34 @@ struct instruction_base : public interface
     bool skip() const override { return false; }
 };
 
+/**
+ * OPCODE handler with statically bound implementation
+ *
+ * Impl provides `template<typename VM, typename Code> static void invoke(VM* vm, const Code* current)`.
+ * exec() instantiates it for vm_interface and opcode::Decoder, VM implementations may instantiate it
+ * for own type to avoid virtual calls and for decoded_instruction to avoid decoding of operands
+ * @tparam Impl final handler type
+ */
+template
+<
+        typename Impl,
+        opcode::opcode_t CodeBase,
+        opcode::BaseFormat Format,
+        opcode::opcode_t FuncA = no_func_a,
+        opcode::opcode_t FuncB = no_func_b
+>
+struct instruction : public instruction_base<CodeBase, Format, FuncA, FuncB>
+{
+    void exec(vm_interface* vm, const opcode::Decoder* current) const final
+    {
+        Impl::invoke(vm, current);
+    }
+};
+
+/// list of handler types
+template<typename... Handlers>
+struct handler_list {};
+
 /**
  * registry of instruction handlers
  */
@@ -182,6 +210,27 @@ struct registry
     using handler_ptr = const interface*;
     using handler_map = std::map<InstructionId, interface::ptr>;
 
+    /// num of opcode groups(7 bits)
+    static constexpr size_t group_count = 1 << 7;
+    /// num of "func A" values(3 bits)
+    static constexpr size_t func_a_count = 1 << 3;
+    /// num of "func B" values(7 bits)
+    static constexpr size_t func_b_count = 1 << 7;
+    /// index of "func B" table for entries without "func B"
+    static constexpr std::uint32_t no_func_b_table = ~0u;
+
+    /// dispatch table entry for [group][func A]
+    struct dispatch_entry
+    {
+        /// handler, used if instruction have no "func B"
+        handler_ptr handler = nullptr;
+        /// index in func_b_tables
+        std::uint32_t func_b = no_func_b_table;
+    };
+    using dispatch_group = std::array<dispatch_entry, func_a_count>;
+    using dispatch_table = std::array<dispatch_group, group_count>;
+    using func_b_table = std::array<handler_ptr, func_b_count>;
+
     /**
      * register handler by type
      * @tparam Handler
@@ -195,8 +244,30 @@ struct registry
     /// register handler by pointer
     bool register_handler(interface::ptr handler);
 
+    /// register list of handlers
+    template<typename... Handlers>
+    inline bool register_handlers(handler_list<Handlers...>)
+    {
+        return (register_handler<Handlers>() && ...);
+    }
+
     /// find handler by instruction code
-    handler_ptr find_handler(const opcode::Decoder* code) const;
+    /// uses dispatch table: group -> func A -> func B
+    [[nodiscard]]
+    handler_ptr find_handler(const opcode::Decoder* code) const
+    {
+        const auto& entry = dispatch[code->get_code()][code->get_func3()];
+        if (entry.func_b != no_func_b_table)
+        {
+            return func_b_tables[entry.func_b][code->get_func7()];
+        }
+        return entry.handler;
+    }
+
+    /// find handler by instruction code
+    /// slow path: lookup in handlers map
+    [[nodiscard]]
+    handler_ptr lookup(const opcode::Decoder* code) const;
 
     /// handlers container
     handler_map handlers;
@@ -204,6 +275,18 @@ struct registry
     std::set<opcode::opcode_t> func_b;
     /// mark that instruction have "func B"
     std::set<opcode::opcode_t> func_a;
+private:
+    /// find handler in handlers map
+    [[nodiscard]]
+    handler_ptr lookup(opcode::opcode_t op, opcode::opcode_t func_3, opcode::opcode_t func_7) const;
+
+    /// rebuild dispatch table for opcode group
+    void update_dispatch(opcode::opcode_t op);
+
+    /// dispatch table
+    dispatch_table dispatch{};
+    /// "func B" tables
+    std::vector<func_b_table> func_b_tables;
 };
 
 
@@ -10,7 +10,7 @@ namespace vm::rv32i
 
 /// load upper immediate
 /// asm: lui dest, const
-struct lui: public instruction_base<opcode::LUI, opcode::U_TYPE> {
+struct lui: public instruction<lui, opcode::LUI, opcode::U_TYPE> {
     [[nodiscard]]
     std::string get_args(const opcode::Decoder* code) const override
     {
@@ -22,7 +22,8 @@ struct lui: public instruction_base<opcode::LUI, opcode::U_TYPE> {
     {
         return "lui";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto data = current->decode_u();
@@ -32,7 +33,7 @@ struct lui: public instruction_base<opcode::LUI, opcode::U_TYPE> {
 };
 /// add upper immediate to PC
 /// asm: auipc dest, const
-struct auipc: public instruction_base<opcode::AUIPC, opcode::U_TYPE> {
+struct auipc: public instruction<auipc, opcode::AUIPC, opcode::U_TYPE> {
     [[nodiscard]]
     std::string get_args(const opcode::Decoder* code) const override
     {
@@ -44,7 +45,8 @@ struct auipc: public instruction_base<opcode::AUIPC, opcode::U_TYPE> {
     {
         return "auipc";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto data = current->decode_u();
@@ -55,11 +57,12 @@ struct auipc: public instruction_base<opcode::AUIPC, opcode::U_TYPE> {
 
 /// jump and link, stores return address in dest
 /// asm: jal dest, const
-struct jal: public instruction_base<opcode::JAL, opcode::J_TYPE> {
+struct jal: public instruction<jal, opcode::JAL, opcode::J_TYPE> {
     [[nodiscard]]
     bool skip() const final { return true; }
 
-    static opcode::signed_t get_data(const opcode::Decoder* code)
+    template<typename Code>
+    static opcode::signed_t get_data(const Code* code)
     {
         return std::bit_cast<opcode::signed_t>(code->decode_j());
     }
@@ -74,7 +77,8 @@ struct jal: public instruction_base<opcode::JAL, opcode::J_TYPE> {
     {
         return "jal";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto offset = get_data(current);
@@ -86,11 +90,12 @@ struct jal: public instruction_base<opcode::JAL, opcode::J_TYPE> {
 
 /// jump and link by register
 /// asm: jalr dest, src, const
-struct jalr: public instruction_base<opcode::JALR, opcode::I_TYPE, 0b0000> {
+struct jalr: public instruction<jalr, opcode::JALR, opcode::I_TYPE, 0b0000> {
     [[nodiscard]]
     bool skip() const final { return true; }
 
-    static opcode::signed_t get_data(const opcode::Decoder* code)
+    template<typename Code>
+    static opcode::signed_t get_data(const Code* code)
     {
         return std::bit_cast<opcode::signed_t>(code->decode_i());
     }
@@ -106,7 +111,8 @@ struct jalr: public instruction_base<opcode::JALR, opcode::I_TYPE, 0b0000> {
     {
         return "jalr";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto src = current->get_rs1();
@@ -120,8 +126,8 @@ struct jalr: public instruction_base<opcode::JALR, opcode::I_TYPE, 0b0000> {
 };
 
 /// branch (conditional jump)
-template<opcode::opcode_t Type>
-struct branch: public instruction_base<opcode::BRANCH, opcode::B_TYPE, Type> {
+template<typename Impl, opcode::opcode_t Type>
+struct branch: public instruction<Impl, opcode::BRANCH, opcode::B_TYPE, Type> {
     [[nodiscard]]
     bool skip() const final { return true; }
 
@@ -133,115 +139,117 @@ struct branch: public instruction_base<opcode::BRANCH, opcode::B_TYPE, Type> {
         return lhs + ", " + rhs + ", " + std::to_string(get_data(code));
     }
 
+    template<typename Code>
     [[nodiscard]]
-    static opcode::signed_t get_data(const opcode::Decoder* current)
+    static opcode::signed_t get_data(const Code* current)
     {
         return std::bit_cast<opcode::signed_t>(current->decode_b());
     }
 
-    [[nodiscard]]
-    virtual bool compare(register_t lhs, register_t rhs) const = 0;
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto lhs = vm->get_register(current->get_rs1());
         auto rhs = vm->get_register(current->get_rs2());
         auto offset = get_data(current);
 
-        vm->jump_if(compare(lhs, rhs), offset);
+        vm->jump_if(Impl::compare(lhs, rhs), offset);
     }
 };
 
 /// jump if eq
-struct beq : branch<0b0000> {
+struct beq : branch<beq, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "beq";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return to_signed(lhs) == to_signed(rhs);
     }
 };
 /// jump if not eq
-struct bne : branch<0b0001> {
+struct bne : branch<bne, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "bne";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return to_signed(lhs) != to_signed(rhs);
     }
 };
 
 /// jump if less
-struct blt : branch<0b0100> {
+struct blt : branch<blt, 0b0100> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "blt";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return to_signed(lhs) < to_signed(rhs);
     }
 };
 
 /// jump if greater or equal
-struct bge : branch<0b0101> {
+struct bge : branch<bge, 0b0101> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "bge";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return to_signed(lhs) >= to_signed(rhs);
     }
 };
 
 /// jump if less (unsigned)
-struct bltu: branch<0b0110> {
+struct bltu: branch<bltu, 0b0110> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "bltu";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return lhs < rhs;
     }
 };
 
 /// jump if greater of equal
-struct bgeu: branch<0b0111> {
+struct bgeu: branch<bgeu, 0b0111> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "bgeu";
     }
     [[nodiscard]]
-    bool compare(register_t lhs, register_t rhs) const override
+    static bool compare(register_t lhs, register_t rhs)
     {
         return lhs >= rhs;
     }
 };
 
 /// load(read) value from memory
-template<opcode::opcode_t Type>
-struct load: public instruction_base<opcode::LOAD, opcode::I_TYPE, Type> {
-    static signed_t get_offset(const opcode::Decoder* current)
+template<typename Impl, opcode::opcode_t Type>
+struct load: public instruction<Impl, opcode::LOAD, opcode::I_TYPE, Type> {
+    template<typename Code>
+    static signed_t get_offset(const Code* current)
     {
         return to_signed(current->decode_i());
     }
-    static vm_interface::address_t get_address(vm_interface *vm, const opcode::Decoder* current)
+    template<typename VM, typename Code>
+    static vm_interface::address_t get_address(VM* vm, const Code* current)
     {
         auto base = vm->get_register(current->get_rs1());
         return base + get_offset(current);
@@ -253,24 +261,25 @@ struct load: public instruction_base<opcode::LOAD, opcode::I_TYPE, Type> {
         std::string base{get_register_alias(code->get_rs1())};
         return dest + ", " + base + ", " + std::to_string(get_offset(code));
     }
-    virtual register_t read_memory(vm_interface* vm, vm_interface::address_t address) const = 0;
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto address = get_address(vm, current);
-        auto value = read_memory(vm, address);
+        auto value = Impl::read_memory(vm, address);
         auto dest = current->get_rd();
         vm->set_register(dest, value);
     }
 };
 
 /// load byte (sign extended)
-struct lb : load<0b0000> {
+struct lb : load<lb, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "lb";
     }
-    register_t read_memory(vm_interface* vm, vm_interface::address_t address) const override
+    template<typename VM>
+    static register_t read_memory(VM* vm, vm_interface::address_t address)
     {
         register_t value = 0;
         vm->read_memory(address, 1, value);
@@ -281,13 +290,14 @@ struct lb : load<0b0000> {
 };
 
 /// load halfword (sign extended)
-struct lh : load<0b0001> {
+struct lh : load<lh, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "lh";
     }
-    register_t read_memory(vm_interface* vm, vm_interface::address_t address) const override
+    template<typename VM>
+    static register_t read_memory(VM* vm, vm_interface::address_t address)
     {
         register_t value = 0;
         vm->read_memory(address, 2, value);
@@ -298,13 +308,14 @@ struct lh : load<0b0001> {
 };
 
 /// load word (sign extended)
-struct lw : load<0b0010> {
+struct lw : load<lw, 0b0010> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "lw";
     }
-    register_t read_memory(vm_interface* vm, vm_interface::address_t address) const override
+    template<typename VM>
+    static register_t read_memory(VM* vm, vm_interface::address_t address)
     {
         register_t value = 0;
         vm->read_memory(address, 4, value);
@@ -313,13 +324,14 @@ struct lw : load<0b0010> {
 };
 
 /// load byte (unsigned)
-struct lbu: load<0b0100> {
+struct lbu: load<lbu, 0b0100> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "lbu";
     }
-    register_t read_memory(vm_interface* vm, vm_interface::address_t address) const override
+    template<typename VM>
+    static register_t read_memory(VM* vm, vm_interface::address_t address)
     {
         register_t value = 0;
         vm->read_memory(address, 1, value);
@@ -328,13 +340,14 @@ struct lbu: load<0b0100> {
 };
 
 /// load halfword (unsigned)
-struct lhu: load<0b0101> {
+struct lhu: load<lhu, 0b0101> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "lhu";
     }
-    register_t read_memory(vm_interface* vm, vm_interface::address_t address) const override
+    template<typename VM>
+    static register_t read_memory(VM* vm, vm_interface::address_t address)
     {
         register_t value = 0;
         vm->read_memory(address, 2, value);
@@ -343,13 +356,15 @@ struct lhu: load<0b0101> {
 };
 
 /// store(write) value into memory
-template<opcode::opcode_t Type>
-struct store: public instruction_base<opcode::STORE, opcode::S_TYPE, Type> {
-    static signed_t get_offset(const opcode::Decoder* current)
+template<typename Impl, opcode::opcode_t Type>
+struct store: public instruction<Impl, opcode::STORE, opcode::S_TYPE, Type> {
+    template<typename Code>
+    static signed_t get_offset(const Code* current)
     {
         return to_signed(current->decode_s());
     }
-    static vm_interface::address_t get_address(vm_interface *vm, const opcode::Decoder* current)
+    template<typename VM, typename Code>
+    static vm_interface::address_t get_address(VM* vm, const Code* current)
     {
         auto base = vm->get_register(current->get_rs1());
         return base + get_offset(current);
@@ -361,58 +376,62 @@ struct store: public instruction_base<opcode::STORE, opcode::S_TYPE, Type> {
         std::string src{get_register_alias(code->get_rs2())};
         return src + ", " + base + ", " + std::to_string(get_offset(code));
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto value = vm->get_register(current->get_rs2());
         auto address = get_address(vm, current);
-        write_memory(vm, address, value);
+        Impl::write_memory(vm, address, value);
     }
-    virtual void write_memory(vm_interface* vm, vm_interface::address_t address, register_t value) const = 0;
 };
 
 /// store byte
-struct sb: store<0b0000> {
+struct sb: store<sb, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sb";
     }
-    void write_memory(vm_interface* vm, vm_interface::address_t address, register_t value) const override
+    template<typename VM>
+    static void write_memory(VM* vm, vm_interface::address_t address, register_t value)
     {
         vm->write_memory(address, 1, value);
     }
 };
 
 /// store halfword
-struct sh: store<0b0001> {
+struct sh: store<sh, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sh";
     }
-    void write_memory(vm_interface* vm, vm_interface::address_t address, register_t value) const override
+    template<typename VM>
+    static void write_memory(VM* vm, vm_interface::address_t address, register_t value)
     {
         vm->write_memory(address, 2, value);
     }
 };
 
 /// store word
-struct sw: store<0b0010> {
+struct sw: store<sw, 0b0010> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sw";
     }
-    void write_memory(vm_interface* vm, vm_interface::address_t address, register_t value) const override
+    template<typename VM>
+    static void write_memory(VM* vm, vm_interface::address_t address, register_t value)
     {
         vm->write_memory(address, 4, value);
     }
 };
 
 /// integer-immediate
-template<opcode::opcode_t Type>
-struct int_imm: public instruction_base<opcode::OP_IMM, opcode::I_TYPE, Type> {
-    static signed_t get_data(const opcode::Decoder* current)
+template<typename Impl, opcode::opcode_t Type>
+struct int_imm: public instruction<Impl, opcode::OP_IMM, opcode::I_TYPE, Type> {
+    template<typename Code>
+    static signed_t get_data(const Code* current)
     {
         return to_signed(current->decode_i());
     }
@@ -427,13 +446,14 @@ struct int_imm: public instruction_base<opcode::OP_IMM, opcode::I_TYPE, Type> {
 
 /// add immediate
 /// asm: addi rd, rs, const
-struct addi : int_imm<0b0000> {
+struct addi : int_imm<addi, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "addi";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto src  = vm->get_register(current->get_rs1());
@@ -445,13 +465,14 @@ struct addi : int_imm<0b0000> {
 /// set if less than immediate
 /// rd = (rs < const) ? 1 : 0;
 /// asm: slti rd, rs, const
-struct slti : int_imm<0b0010> {
+struct slti : int_imm<slti, 0b0010> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "slti";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = to_signed(vm->get_register(current->get_rs1()));
@@ -463,7 +484,7 @@ struct slti : int_imm<0b0010> {
 /// set if less than unsigned immediate
 /// rd = (rs < const) ? 1 : 0;
 /// asm: sltiu rd, rs, const
-struct sltiu: int_imm<0b0011> {
+struct sltiu: int_imm<sltiu, 0b0011> {
     [[nodiscard]]
     std::string get_args(const opcode::Decoder* code) const override
     {
@@ -476,7 +497,8 @@ struct sltiu: int_imm<0b0011> {
     {
         return "sltiu";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -487,13 +509,14 @@ struct sltiu: int_imm<0b0011> {
 
 /// xor
 /// asm: xor rd, rs, const
-struct xori: int_imm<0b0100> {
+struct xori: int_imm<xori, 0b0100> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "xori";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -503,13 +526,14 @@ struct xori: int_imm<0b0100> {
 };
 
 /// asm: or rd, rs, const
-struct ori : int_imm<0b0110> {
+struct ori : int_imm<ori, 0b0110> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "ori";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -519,13 +543,14 @@ struct ori : int_imm<0b0110> {
 };
 
 /// asm: and rd, rs, const
-struct andi: int_imm<0b0111> {
+struct andi: int_imm<andi, 0b0111> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "andi";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -535,9 +560,10 @@ struct andi: int_imm<0b0111> {
 };
 
 /// shift by immediate
-template<opcode::opcode_t Type, opcode::opcode_t Variant>
-struct shift_imm: public instruction_base<opcode::OP_IMM, opcode::R_TYPE, Type, (Variant << 5)> {
-    static register_t get_data(const opcode::Decoder* current)
+template<typename Impl, opcode::opcode_t Type, opcode::opcode_t Variant>
+struct shift_imm: public instruction<Impl, opcode::OP_IMM, opcode::R_TYPE, Type, (Variant << 5)> {
+    template<typename Code>
+    static register_t get_data(const Code* current)
     {
         return current->decode_i_u() & opcode::mask_value<0, 5>;
     }
@@ -551,13 +577,14 @@ struct shift_imm: public instruction_base<opcode::OP_IMM, opcode::R_TYPE, Type,
 };
 
 /// asm: sll rd, rs, const
-struct slli: shift_imm<0b0001, 0> {
+struct slli: shift_imm<slli, 0b0001, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "slli";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -567,13 +594,14 @@ struct slli: shift_imm<0b0001, 0> {
 };
 
 /// asm: srl rd, rs, const
-struct srli: shift_imm<0b0101, 0> {
+struct srli: shift_imm<srli, 0b0101, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "srli";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -584,13 +612,14 @@ struct srli: shift_imm<0b0101, 0> {
 
 /// arithmetic shift
 /// asm: sra rd, rs, const
-struct srai: shift_imm<0b0101, 1> {
+struct srai: shift_imm<srai, 0b0101, 1> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "srai";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto value = vm->get_register(current->get_rs1());
@@ -600,8 +629,8 @@ struct srai: shift_imm<0b0101, 1> {
 };
 
 /// integer-register
-template<opcode::opcode_t Type, opcode::opcode_t Variant>
-struct int_r: public instruction_base<opcode::OP, opcode::R_TYPE, Type, (Variant << 5)> {
+template<typename Impl, opcode::opcode_t Type, opcode::opcode_t Variant>
+struct int_r: public instruction<Impl, opcode::OP, opcode::R_TYPE, Type, (Variant << 5)> {
     [[nodiscard]]
     std::string get_args(const opcode::Decoder* code) const override
     {
@@ -610,55 +639,54 @@ struct int_r: public instruction_base<opcode::OP, opcode::R_TYPE, Type, (Variant
         std::string rhs{get_register_alias(code->get_rs2())};
         return dest + ", " + lhs + ", " + rhs;
     }
-    [[nodiscard]]
-    virtual register_t calculate(register_t lhs, register_t rhs) const = 0;
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto lhs = vm->get_register(current->get_rs1());
         auto rhs = vm->get_register(current->get_rs2());
 
-        vm->set_register(dest, calculate(lhs, rhs));
+        vm->set_register(dest, Impl::calculate(lhs, rhs));
     }
 };
 
 /// asm: add rd, rs1, rs2
-struct add_r : int_r<0b0000, 0> {
+struct add_r : int_r<add_r, 0b0000, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "add";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs + rhs;
     }
 };
 
 /// asm: sub rd, rs1, rs2
-struct sub_r : int_r<0b0000, 1> {
+struct sub_r : int_r<sub_r, 0b0000, 1> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sub";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs - rhs;
     }
 };
 
 /// asm: sll rd, rs1, rs2
-struct sll_r : int_r<0b0001, 0> {
+struct sll_r : int_r<sll_r, 0b0001, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sll";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs << rhs;
     }
@@ -666,14 +694,14 @@ struct sll_r : int_r<0b0001, 0> {
 
 /// set rd to 1 if rs1 < rs2, signed
 /// asm: slt rd, rs1, rs2
-struct slt_r : int_r<0b0010, 0> {
+struct slt_r : int_r<slt_r, 0b0010, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "slt";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return to_signed(lhs) < to_signed(rhs);
     }
@@ -681,42 +709,42 @@ struct slt_r : int_r<0b0010, 0> {
 
 /// set rd to 1 if rs1 < rs2, unsigned
 /// asm: sltu rd, rs1, rs2
-struct sltu_r: int_r<0b0011, 0> {
+struct sltu_r: int_r<sltu_r, 0b0011, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sltu";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs < rhs;
     }
 };
 
 /// asm: xor rd, rs1, rs2
-struct xor_r : int_r<0b0100, 0> {
+struct xor_r : int_r<xor_r, 0b0100, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "xor";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs ^ rhs;
     }
 };
 
 /// asm: srl rd, rs1, rs2
-struct srl_r : int_r<0b0101, 0> {
+struct srl_r : int_r<srl_r, 0b0101, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "srl";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs >> rhs;
     }
@@ -724,79 +752,81 @@ struct srl_r : int_r<0b0101, 0> {
 
 /// arithmetic shift
 /// asm: sra rd, rs1, rs2
-struct sra_r : int_r<0b0101, 1> {
+struct sra_r : int_r<sra_r, 0b0101, 1> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "sra";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return opcode::extend_sign(lhs >> rhs, lhs);
     }
 };
 
 /// asm: or rd, rs1, rs2
-struct or_r  : int_r<0b0110, 0> {
+struct or_r  : int_r<or_r, 0b0110, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "or";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs | rhs;
     }
 };
 
 /// asm: and rd, rs1, rs2
-struct and_r : int_r<0b0111, 0> {
+struct and_r : int_r<and_r, 0b0111, 0> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "and";
     }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const override
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         return lhs & rhs;
     }
 };
 
 /// MISC-MEM group
-template<opcode::opcode_t Type>
-struct misc_mem: public instruction_base<opcode::MISC_MEM, opcode::I_TYPE, Type> {};
+template<typename Impl, opcode::opcode_t Type>
+struct misc_mem: public instruction<Impl, opcode::MISC_MEM, opcode::I_TYPE, Type> {};
 
 /// sync data memory
-struct fence  : misc_mem<0b0000> {
+struct fence  : misc_mem<fence, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "fence";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         vm->barrier();
     }
 };
 
 /// sync instruction memory
-struct fence_i: misc_mem<0b0001> {
+struct fence_i: misc_mem<fence_i, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
         return "fence.i";
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         vm->barrier();
     }
 };
 
 // ECALL / EBREAK
-struct env_call: public instruction_base<opcode::SYSTEM, opcode::I_TYPE, 0b0000> {
+struct env_call: public instruction<env_call, opcode::SYSTEM, opcode::I_TYPE, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -814,7 +844,8 @@ struct env_call: public instruction_base<opcode::SYSTEM, opcode::I_TYPE, 0b0000>
         }
         return opcode::to_hex(args);
     }
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         if (current->decode_i_u())
         {
@@ -828,16 +859,17 @@ struct env_call: public instruction_base<opcode::SYSTEM, opcode::I_TYPE, 0b0000>
 };
 
 /// CSR instructions
-template<opcode::opcode_t Type>
-struct csr: public instruction_base<opcode::SYSTEM, opcode::I_TYPE, Type> {
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+template<typename Impl, opcode::opcode_t Type>
+struct csr: public instruction<Impl, opcode::SYSTEM, opcode::I_TYPE, Type> {
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         vm->control();
     }
 };
 
 /// atomic read and write
-struct csrrw : csr<0b0001> {
+struct csrrw : csr<csrrw, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -846,7 +878,7 @@ struct csrrw : csr<0b0001> {
 };
 
 /// atomic read and set
-struct csrrs : csr<0b0010> {
+struct csrrs : csr<csrrs, 0b0010> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -855,7 +887,7 @@ struct csrrs : csr<0b0010> {
 };
 
 /// atomic read and clear
-struct csrrc : csr<0b0011> {
+struct csrrc : csr<csrrc, 0b0011> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -864,7 +896,7 @@ struct csrrc : csr<0b0011> {
 };
 
 /// unsigned(?) atomic read and write
-struct csrrwi: csr<0b0101> {
+struct csrrwi: csr<csrrwi, 0b0101> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -873,7 +905,7 @@ struct csrrwi: csr<0b0101> {
 };
 
 /// unsigned(?) atomic read and set
-struct csrrsi: csr<0b0110> {
+struct csrrsi: csr<csrrsi, 0b0110> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -882,7 +914,7 @@ struct csrrsi: csr<0b0110> {
 };
 
 /// unsigned(?) atomic read and clear
-struct csrrci: csr<0b0111> {
+struct csrrci: csr<csrrci, 0b0111> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final
     {
@@ -890,6 +922,19 @@ struct csrrci: csr<0b0111> {
     }
 };
 
+/// RV32I handlers
+using handlers = handler_list<
+        lui, auipc, jal, jalr,
+        beq, bne, blt, bge, bltu, bgeu,
+        lb, lh, lw, lbu, lhu,
+        sb, sh, sw,
+        addi, slti, sltiu, xori, ori, andi,
+        slli, srli, srai,
+        add_r, sub_r, sll_r, slt_r, sltu_r, xor_r, srl_r, sra_r, or_r, and_r,
+        fence, fence_i,
+        env_call, csrrw, csrrs, csrrc, csrrwi, csrrsi, csrrci
+>;
+
 /// register RV32i set in registry
 bool register_rv32i_set(registry* r);
 
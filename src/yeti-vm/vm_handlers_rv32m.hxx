@@ -18,8 +18,8 @@ using result_unsigned_t = std::uint64_t;
 static constexpr result_unsigned_t result_mask = register_t{~0u};
 static constexpr result_unsigned_t result_size = sizeof(register_t) * 8;
 
-template<opcode::opcode_t Type>
-struct math: public instruction_base<opcode::OP, opcode::R_TYPE, Type, 0b000'0001> {
+template<typename Impl, opcode::opcode_t Type>
+struct math: public instruction<Impl, opcode::OP, opcode::R_TYPE, Type, 0b000'0001> {
     using b32 = vm::bit_tools::bits_u32;
     using b64 = vm::bit_tools::bits_u64;
     [[nodiscard]]
@@ -30,24 +30,23 @@ struct math: public instruction_base<opcode::OP, opcode::R_TYPE, Type, 0b000'000
         std::string rhs{get_register_alias(code->get_rs2())};
         return dest + ", " + lhs + ", " + rhs;
     }
-    [[nodiscard]]
-    virtual register_t calculate(register_t lhs, register_t rhs) const = 0;
-    void exec(vm_interface *vm, const opcode::Decoder* current) const override
+    template<typename VM, typename Code>
+    static void invoke(VM* vm, const Code* current)
     {
         auto dest = current->get_rd();
         auto lhs = vm->get_register(current->get_rs1());
         auto rhs = vm->get_register(current->get_rs2());
 
-        vm->set_register(dest, calculate(lhs, rhs));
+        vm->set_register(dest, Impl::calculate(lhs, rhs));
     }
 };
 
 /// lower bits of (signed * signed)
-struct mul: math<0b0000> {
+struct mul: math<mul, 0b0000> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "mul"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         result_signed_t result = b32::to_signed(lhs) * b32::to_signed(rhs);
         return result & result_mask;
@@ -55,11 +54,11 @@ struct mul: math<0b0000> {
 };
 
 /// upper bits of (signed * signed)
-struct mulh: math<0b0001> {
+struct mulh: math<mulh, 0b0001> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "mulh"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         result_signed_t result = b32::to_signed(lhs);
         result *= b32::to_signed(rhs);
@@ -68,11 +67,11 @@ struct mulh: math<0b0001> {
 };
 
 /// upper bits of (signed * unsigned)
-struct mulhsu: math<0b0010> {
+struct mulhsu: math<mulhsu, 0b0010> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "mulhsu"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         result_unsigned_t result = b32::to_signed(lhs) * b64::to_unsigned(rhs);
         return (result >> result_size) & result_mask;
@@ -80,11 +79,11 @@ struct mulhsu: math<0b0010> {
 };
 
 /// upper bits of (unsigned * unsigned)
-struct mulhu: math<0b0011> {
+struct mulhu: math<mulhu, 0b0011> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "mulhu"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         result_unsigned_t result = lhs;
         result *= rhs;
@@ -93,11 +92,11 @@ struct mulhu: math<0b0011> {
 };
 
 /// (signed / signed)
-struct div: math<0b0100> {
+struct div: math<div, 0b0100> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "div"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         auto l = to_signed(lhs);
         auto r = to_signed(rhs);
@@ -111,11 +110,11 @@ struct div: math<0b0100> {
 };
 
 /// (unsigned / unsigned)
-struct divu: math<0b0101> {
+struct divu: math<divu, 0b0101> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "divu"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         // rhs == 0 -> uint_max
         if (rhs == 0) return unsigned_limits::max();
@@ -125,11 +124,11 @@ struct divu: math<0b0101> {
 };
 
 /// (signed % signed)
-struct rem: math<0b0110> {
+struct rem: math<rem, 0b0110> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "rem"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         auto l = to_signed(lhs);
         auto r = to_signed(rhs);
@@ -143,11 +142,11 @@ struct rem: math<0b0110> {
 };
 
 /// (unsigned % unsigned)
-struct remu: math<0b0111> {
+struct remu: math<remu, 0b0111> {
     [[nodiscard]]
     std::string_view get_mnemonic() const final { return "remu"; }
     [[nodiscard]]
-    register_t calculate(register_t lhs, register_t rhs) const final
+    static register_t calculate(register_t lhs, register_t rhs)
     {
         if (rhs == 0) return lhs;
         result_unsigned_t result = lhs % rhs;
@@ -155,6 +154,9 @@ struct remu: math<0b0111> {
     }
 };
 
+/// RV32M handlers
+using handlers = handler_list<mul, mulh, mulhsu, mulhu, div, divu, rem, remu>;
+
 /// register RV32M set in registry
 bool register_rv32m_set(registry* r);
 } // namespace vm::rv32m
@@ -0,0 +1,321 @@
+#include "vm_io_ring.hxx"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define YETI_HOST_FILES 1
+#include <unistd.h>
+#endif
+
+namespace vm
+{
+
+namespace
+{
+
+/// errors of guest, as in Linux
+constexpr std::int32_t error_bad_file = 9;
+constexpr std::int32_t error_fault = 14;
+constexpr std::int32_t error_busy = 16;
+constexpr std::int32_t error_invalid = 22;
+
+constexpr register_t to_error(std::int32_t code)
+{
+    return static_cast<register_t>(-code);
+}
+
+// layout is shared with guest
+static_assert(sizeof(io_ring::header) == 16);
+static_assert(sizeof(io_ring::submission) == 16);
+static_assert(sizeof(io_ring::completion) == 8);
+
+} // namespace
+
+#ifdef YETI_HOST_FILES
+
+struct io_ring::calls
+{
+    static io_ring& ring_of(void* context)
+    {
+        return *static_cast<io_ring*>(context);
+    }
+
+    /// registered in registry of basic_vm only
+    static basic_vm& machine_of(vm_interface* vm)
+    {
+        return *static_cast<basic_vm*>(vm);
+    }
+
+    static void post(io_ring& ring, std::span<std::byte> view, const completion& value)
+    {
+        const auto slot = ring.cq_tail++ & (ring.entries - 1);
+        const auto offset = sizeof(header) + ring.entries * sizeof(submission) + slot * sizeof(completion);
+        std::memcpy(view.data() + offset, &value, sizeof(value));
+    }
+
+    /// post results of worker
+    static void post_done(io_ring& ring, std::span<std::byte> view)
+    {
+        std::lock_guard guard{ring.lock};
+        for (const auto& value: ring.done)
+        {
+            post(ring, view, value);
+        }
+        ring.in_flight -= static_cast<std::uint32_t>(ring.done.size());
+        ring.done.clear();
+    }
+
+    /**
+     * resolve file and buffer of request
+     * @return false if request is completed, result is set
+     */
+    static bool prepare(basic_vm& machine, const io_ring& ring, const submission& request, job& task, std::int32_t& result)
+    {
+        result = 0;
+        if (request.opcode == op_nop) return false;
+        if (request.opcode != op_read && request.opcode != op_write)
+        {
+            result = -error_invalid;
+            return false;
+        }
+        if (request.size > static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max()))
+        {
+            // result of request is not representable
+            result = -error_invalid;
+            return false;
+        }
+        const bool is_read = request.opcode == op_read;
+        const int file = ring.files.find_file(request.fd);
+        if (file == linux_abi::console_fd && !is_read)
+        {
+            // console is not shared with worker
+            bool ok = ring.files.get_console().write(machine, request.address, request.size);
+            result = ok ? static_cast<std::int32_t>(request.size) : -error_fault;
+            return false;
+        }
+        if (file < 0)
+        {
+            result = -error_bad_file;
+            return false;
+        }
+        std::byte* data = nullptr;
+        if (is_read)
+        {
+            auto buffer = machine.get_guest_span(request.address, request.size);
+            data = buffer ? buffer->data() : nullptr;
+        }
+        else
+        {
+            // buffer of write is not changed, code in it is not invalidated
+            auto buffer = std::as_const(machine).get_guest_span(request.address, request.size);
+            data = buffer ? const_cast<std::byte*>(buffer->data()) : nullptr;
+        }
+        if (!data)
+        {
+            result = -error_fault;
+            return false;
+        }
+        if (is_read && file == STDIN_FILENO)
+        {
+            ring.files.get_console().flush(); // prompt is visible before input
+        }
+        task = {file, is_read, data, request.size, request.user_data};
+        return true;
+    }
+
+    static void setup(vm_interface* vm, void* context)
+    {
+        auto& ring = ring_of(context);
+        const auto address = vm->get_register(RegAlias::a0);
+        const auto count = vm->get_register(RegAlias::a1);
+        if (ring.in_flight != 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_busy));
+            return;
+        }
+        if (count == 0 || count > max_entries || (count & (count - 1)) != 0 || address % alignof(header) != 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_invalid));
+            return;
+        }
+        auto view = machine_of(vm).get_guest_span(address, get_ring_size(count));
+        if (!view)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_fault));
+            return;
+        }
+        ring.ring_address = address;
+        ring.entries = count;
+        ring.sq_head = 0;
+        ring.cq_tail = 0;
+        std::memset(view->data(), 0, sizeof(header));
+        vm->set_register(RegAlias::a0, 0);
+    }
+
+    static void enter(vm_interface* vm, void* context)
+    {
+        auto& ring = ring_of(context);
+        auto& machine = machine_of(vm);
+        const auto min_complete = vm->get_register(RegAlias::a0);
+        if (ring.entries == 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_invalid));
+            return;
+        }
+        // ring is resolved by each call: predecoded code in it is invalidated as by store
+        auto view = machine.get_guest_span(ring.ring_address, get_ring_size(ring.entries));
+        if (!view)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_fault));
+            return;
+        }
+        header state{};
+        std::memcpy(&state, view->data(), sizeof(state));
+        if (state.sq_tail - ring.sq_head > ring.entries || ring.cq_tail - state.cq_head > ring.entries)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_invalid));
+            return;
+        }
+        if (ring.use_worker)
+        {
+            post_done(ring, *view);
+        }
+
+        // submissions are consumed while completion has free slot
+        const auto* queue = view->data() + sizeof(header);
+        register_t consumed = 0;
+        while (ring.sq_head != state.sq_tail && ring.cq_tail - state.cq_head + ring.in_flight < ring.entries)
+        {
+            submission request{};
+            std::memcpy(&request, queue + (ring.sq_head++ & (ring.entries - 1)) * sizeof(submission), sizeof(request));
+            ++consumed;
+            job task{};
+            std::int32_t result = 0;
+            if (!prepare(machine, ring, request, task, result))
+            {
+                post(ring, *view, {request.user_data, result});
+            }
+            else if (ring.use_worker)
+            {
+                ring.batch.push_back(task);
+                ++ring.in_flight;
+            }
+            else
+            {
+                post(ring, *view, {request.user_data, execute(task)});
+            }
+        }
+        ring.requests += consumed;
+
+        if (!ring.batch.empty())
+        {
+            {
+                std::lock_guard guard{ring.lock};
+                ring.jobs.insert(ring.jobs.end(), ring.batch.begin(), ring.batch.end());
+            }
+            ring.changed.notify_all();
+            ring.batch.clear();
+        }
+        while (ring.in_flight != 0 && ring.cq_tail - state.cq_head < min_complete)
+        {
+            {
+                std::unique_lock guard{ring.lock};
+                ring.changed.wait(guard, [&ring] { return !ring.done.empty(); });
+            }
+            post_done(ring, *view);
+        }
+
+        state.sq_head = ring.sq_head;
+        state.cq_tail = ring.cq_tail;
+        std::memcpy(view->data(), &state, sizeof(state));
+        vm->set_register(RegAlias::a0, consumed);
+    }
+};
+
+std::int32_t io_ring::execute(const job &request)
+{
+    const auto result = request.is_read
+        ? ::read(request.file, request.data, request.size)
+        : ::write(request.file, request.data, request.size);
+    return result < 0 ? -errno : static_cast<std::int32_t>(result);
+}
+
+bool io_ring::register_syscalls(basic_vm &machine)
+{
+    auto& sys = machine.get_syscalls();
+    if (!sys.is_free({setup_id, enter_id})) return false;
+    bool ok = sys.register_handler(setup_id, "ring_setup", calls::setup, this);
+    ok = ok && sys.register_handler(enter_id, "ring_enter", calls::enter, this);
+    return ok;
+}
+
+#else // YETI_HOST_FILES
+
+std::int32_t io_ring::execute(const job &)
+{
+    return -error_bad_file;
+}
+
+bool io_ring::register_syscalls(basic_vm &)
+{
+    return false;
+}
+
+#endif // YETI_HOST_FILES
+
+io_ring::io_ring(linux_abi &files, bool use_worker)
+    : files{files}
+    , use_worker{use_worker}
+{
+    if (use_worker)
+    {
+        worker = std::thread{&io_ring::run_worker, this};
+    }
+}
+
+io_ring::~io_ring()
+{
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard guard{lock};
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+void io_ring::wait()
+{
+    std::unique_lock guard{lock};
+    changed.wait(guard, [this] { return done.size() == in_flight; });
+}
+
+void io_ring::run_worker()
+{
+    std::vector<job> tasks;
+    std::vector<completion> results;
+    std::unique_lock guard{lock};
+    while (true)
+    {
+        changed.wait(guard, [this] { return stopping || !jobs.empty(); });
+        // queue is finished before stop
+        if (jobs.empty()) return;
+        // whole queue is taken, guest is woken once per batch
+        tasks.assign(jobs.begin(), jobs.end());
+        jobs.clear();
+        guard.unlock();
+        results.clear();
+        for (const auto& task: tasks)
+        {
+            results.push_back({task.user_data, execute(task)});
+        }
+        guard.lock();
+        done.insert(done.end(), results.begin(), results.end());
+        changed.notify_all();
+    }
+}
+
+} // namespace vm
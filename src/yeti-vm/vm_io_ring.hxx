@@ -0,0 +1,161 @@
+/// batched guest I/O by shared submission and completion queues
+#pragma once
+
+#include "vm_basic.hxx"
+#include "vm_linux_abi.hxx"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vm
+{
+
+/**
+ * ring of I/O requests in guest RAM, like io_uring of Linux
+ *
+ * ring_setup(address, entries) places ring at address:
+ * header, then `entries` submissions, then `entries` completions.
+ * guest fills submissions, moves sq_tail and calls ring_enter(min_complete):
+ * one ecall for whole batch. host moves sq_head, posts completions at cq_tail,
+ * guest reads them and moves cq_head.
+ * results of worker are posted by ring_enter, it waits for min_complete completions.
+ *
+ * ring and buffers should not cross boundary of memory blocks.
+ * buffer and file of request should not be used by guest until completion is posted.
+ * files are resolved by linux_abi, console output is written at submission.
+ */
+struct io_ring
+{
+    /// syscall IDs, as io_uring_setup/io_uring_enter of Linux
+    enum syscall_id: register_t
+    {
+        /// ring_setup(address, entries): 0 or -errno
+        setup_id = 425,
+        /// ring_enter(min_complete): count of consumed submissions or -errno
+        enter_id = 426,
+    };
+
+    /// operations of submission
+    enum operation: std::uint16_t
+    {
+        op_nop = 0,
+        /// read(fd, address, size)
+        op_read = 1,
+        /// write(fd, address, size)
+        op_write = 2,
+    };
+
+    /// shared header, indexes are not wrapped: slot is index % entries
+    struct header
+    {
+        /// next submission of host, moved by host
+        std::uint32_t sq_head;
+        /// end of submissions, moved by guest
+        std::uint32_t sq_tail;
+        /// next completion of guest, moved by guest
+        std::uint32_t cq_head;
+        /// end of completions, moved by host
+        std::uint32_t cq_tail;
+    };
+
+    /// request of guest
+    struct submission
+    {
+        std::uint16_t opcode;
+        std::uint16_t fd;
+        std::uint32_t address;
+        /// size above INT32_MAX is rejected with -EINVAL
+        std::uint32_t size;
+        /// copied to completion
+        std::uint32_t user_data;
+    };
+
+    /// result of request
+    struct completion
+    {
+        std::uint32_t user_data;
+        /// as result of syscall: size or -errno
+        std::int32_t result;
+    };
+
+    /// max count of entries, count should be power of 2
+    static constexpr std::uint32_t max_entries = 4096;
+
+    /// size of ring with `entries` submissions and completions
+    [[nodiscard]]
+    static constexpr register_t get_ring_size(std::uint32_t entries) noexcept
+    {
+        return sizeof(header) + entries * (sizeof(submission) + sizeof(completion));
+    }
+
+    /**
+     * @param files files of guest
+     * @param use_worker files are read and written by worker thread, guest runs meanwhile
+     */
+    explicit io_ring(linux_abi& files, bool use_worker = false);
+    io_ring(const io_ring&) = delete;
+    io_ring& operator=(const io_ring&) = delete;
+    /// requests in flight are finished
+    ~io_ring();
+
+    /**
+     * register syscalls, ring should outlive machine
+     * @return false if host has no file API or ID is used, nothing is registered
+     */
+    [[nodiscard]]
+    bool register_syscalls(basic_vm& machine);
+
+    /// wait for requests in flight, guest memory should not be released before
+    void wait();
+
+    /// count of requests processed by host
+    [[nodiscard]]
+    size_t get_requests() const noexcept
+    {
+        return requests;
+    }
+private:
+    /// bodies of syscalls
+    struct calls;
+
+    /// host read or write
+    struct job
+    {
+        int file;
+        bool is_read;
+        std::byte* data;
+        size_t size;
+        std::uint32_t user_data;
+    };
+
+    [[nodiscard]]
+    static std::int32_t execute(const job& request);
+    void run_worker();
+
+    linux_abi& files;
+
+    register_t ring_address = 0;
+    std::uint32_t entries = 0;
+    /// host copies of indexes moved by host
+    std::uint32_t sq_head = 0;
+    std::uint32_t cq_tail = 0;
+    /// requests passed to worker and not posted
+    std::uint32_t in_flight = 0;
+    size_t requests = 0;
+    /// requests of current batch
+    std::vector<job> batch;
+
+    bool use_worker;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<job> jobs;
+    std::vector<completion> done;
+    bool stopping = false;
+    std::thread worker;
+};
+
+} // namespace vm
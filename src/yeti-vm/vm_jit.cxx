@@ -0,0 +1,889 @@
+#include "vm_jit.hxx"
+#include "vm_basic.hxx"
+#include "vm_handlers_rv32i.hxx"
+#include "vm_handlers_rv32m.hxx"
+#include "vm_fusion.hxx"
+#include "vm_guest_space.hxx"
+
+#include <cstddef>
+#include <cstring>
+#include <typeindex>
+#include <unordered_map>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define YETI_JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+#if defined(YETI_JIT_X86_64) && defined(__linux__)
+#define YETI_JIT_DIRECT_MEMORY 1
+#include <algorithm>
+#include <mutex>
+#include <csignal>
+#include <ucontext.h>
+#endif
+
+namespace vm
+{
+
+#ifdef YETI_JIT_X86_64
+namespace
+{
+
+using context = jit_compiler::context;
+using address_t = jit_compiler::address_t;
+using binary_fn = register_t (*)(register_t, register_t);
+
+/// host registers
+enum reg: std::uint8_t
+{
+    rax = 0, rcx = 1, rdx = 2, rbx = 3, rsi = 6, rdi = 7, r12 = 12, r13 = 13,
+};
+
+/// condition codes for jcc/setcc
+enum cond: std::uint8_t
+{
+    cc_b = 0x2, cc_ae = 0x3, cc_e = 0x4, cc_ne = 0x5, cc_l = 0xc, cc_ge = 0xd,
+};
+
+/// "op r/m32, r32" opcodes, (op >> 3) is extension for "op r/m32, imm32"
+enum alu: std::uint8_t
+{
+    alu_add = 0x01, alu_or = 0x09, alu_and = 0x21, alu_sub = 0x29, alu_xor = 0x31, alu_cmp = 0x39,
+};
+
+/// extensions of shift group
+enum shift: std::uint8_t
+{
+    shift_shl = 4, shift_shr = 5, shift_sar = 7,
+};
+
+constexpr std::int32_t registers_offset = offsetof(context, registers);
+constexpr std::int32_t target_offset = offsetof(context, target);
+constexpr std::int32_t value_offset = offsetof(context, value);
+constexpr std::int32_t executed_offset = offsetof(context, executed);
+constexpr std::int32_t memory_offset = offsetof(context, memory);
+constexpr std::int32_t code_start_offset = offsetof(context, code_start);
+constexpr std::int32_t code_size_offset = offsetof(context, code_size);
+
+/**
+ * x86-64 machine code writer
+ *
+ * rbx - guest register file, r12 - context, r13 - guest memory
+ */
+struct emitter
+{
+    std::vector<std::uint8_t> code;
+    /// memory is accessed by r13 instead of helpers
+    bool direct = false;
+    /// offsets of direct memory access and its recovery code
+    std::vector<std::pair<size_t, size_t>> sites;
+
+    void byte(std::uint8_t value) { code.push_back(value); }
+    void dword(std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) byte(value >> (i * 8));
+    }
+    void qword(std::uint64_t value)
+    {
+        dword(value);
+        dword(value >> 32);
+    }
+    void modrm(std::uint8_t mod, std::uint8_t r, std::uint8_t rm)
+    {
+        byte((mod << 6) | ((r & 7) << 3) | (rm & 7));
+    }
+    /// [rbx + disp32]
+    void at_rbx(std::uint8_t r, std::int32_t disp)
+    {
+        modrm(0b10, r, rbx);
+        dword(disp);
+    }
+    /// [r12 + disp32]
+    void at_r12(std::uint8_t r, std::int32_t disp)
+    {
+        modrm(0b10, r, 0b100);
+        byte(0x24); // SIB: base = r12, no index
+        dword(disp);
+    }
+
+    /// mov dst, guest[r]
+    void load_guest(reg dst, register_no r)
+    {
+        byte(0x8b);
+        at_rbx(dst, r * sizeof(register_t));
+    }
+    /// mov guest[r], src
+    void store_guest(register_no r, reg src)
+    {
+        byte(0x89);
+        at_rbx(src, r * sizeof(register_t));
+    }
+    /// mov guest[r], imm32
+    void store_guest(register_no r, std::uint32_t value)
+    {
+        byte(0xc7);
+        at_rbx(0, r * sizeof(register_t));
+        dword(value);
+    }
+    /// mov dst, context[offset]
+    void load_context(reg dst, std::int32_t offset)
+    {
+        byte(0x41);
+        byte(0x8b);
+        at_r12(dst, offset);
+    }
+    /// mov context[offset], src
+    void store_context(std::int32_t offset, reg src)
+    {
+        byte(0x41);
+        byte(0x89);
+        at_r12(src, offset);
+    }
+    /// mov context[offset], imm32
+    void store_context(std::int32_t offset, std::uint32_t value)
+    {
+        byte(0x41);
+        byte(0xc7);
+        at_r12(0, offset);
+        dword(value);
+    }
+    /// mov dst, imm32
+    void mov(reg dst, std::uint32_t value)
+    {
+        byte(0xb8 + dst);
+        dword(value);
+    }
+    /// mov dst, src
+    void mov(reg dst, reg src)
+    {
+        byte(0x89);
+        modrm(0b11, src, dst);
+    }
+    /// op dst, context[offset]
+    void op_context(alu code, reg dst, std::int32_t offset)
+    {
+        byte(0x41);
+        byte(code + 2);
+        at_r12(dst, offset);
+    }
+    /// op dst, src
+    void op(alu code, reg dst, reg src)
+    {
+        byte(code);
+        modrm(0b11, src, dst);
+    }
+    /// op dst, imm32
+    void op(alu code, reg dst, std::uint32_t value)
+    {
+        byte(0x81);
+        modrm(0b11, code >> 3, dst);
+        dword(value);
+    }
+    /// shift dst, cl
+    void shift_cl(shift code, reg dst)
+    {
+        byte(0xd3);
+        modrm(0b11, code, dst);
+    }
+    /// shift dst, imm8
+    void shift_imm(shift code, reg dst, std::uint8_t count)
+    {
+        byte(0xc1);
+        modrm(0b11, code, dst);
+        byte(count);
+    }
+    /// setcc dst8; movzx dst, dst8
+    void set_if(cond cc, reg dst)
+    {
+        byte(0x0f);
+        byte(0x90 | cc);
+        modrm(0b11, 0, dst);
+        byte(0x0f);
+        byte(0xb6);
+        modrm(0b11, dst, dst);
+    }
+    /// imul dst, src
+    void imul(reg dst, reg src)
+    {
+        byte(0x0f);
+        byte(0xaf);
+        modrm(0b11, dst, src);
+    }
+    /// test r, r
+    void test(reg r)
+    {
+        byte(0x85);
+        modrm(0b11, r, r);
+    }
+    /// test r, imm32
+    void test(reg r, std::uint32_t value)
+    {
+        byte(0xf7);
+        modrm(0b11, 0, r);
+        dword(value);
+    }
+    /// [r13 + rsi], REX prefix is written by caller
+    void at_memory(std::uint8_t r)
+    {
+        modrm(0b01, r, 0b100);
+        byte((rsi << 3) | (r13 & 7)); // SIB: base = r13, index = rsi
+        byte(0);                      // r13 as base requires disp8
+    }
+    /// load from guest memory by rsi, type is funct3 of load
+    void load_memory(reg dst, std::uint8_t type)
+    {
+        byte(0x41);
+        switch (type)
+        {
+        case 0b000: byte(0x0f); byte(0xbe); break; // movsx r32, m8
+        case 0b001: byte(0x0f); byte(0xbf); break; // movsx r32, m16
+        case 0b100: byte(0x0f); byte(0xb6); break; // movzx r32, m8
+        case 0b101: byte(0x0f); byte(0xb7); break; // movzx r32, m16
+        default:    byte(0x8b); break;             // mov r32, m32
+        }
+        at_memory(dst);
+    }
+    /// store to guest memory by rsi
+    void store_memory(reg src, std::uint8_t size)
+    {
+        if (size == 2) byte(0x66);
+        byte(0x41);
+        byte(size == 1 ? 0x88 : 0x89);
+        at_memory(src);
+    }
+    /// mov rdi, r12
+    void context_arg()
+    {
+        byte(0x4c);
+        byte(0x89);
+        modrm(0b11, 4, rdi);
+    }
+    /// mov rax, imm64; call rax
+    void call(const void* fn)
+    {
+        byte(0x48);
+        byte(0xb8);
+        qword(reinterpret_cast<std::uintptr_t>(fn));
+        byte(0xff);
+        modrm(0b11, 2, rax);
+    }
+    /// jcc rel32
+    /// @return label for bind()
+    size_t jump_if(cond cc)
+    {
+        byte(0x0f);
+        byte(0x80 | cc);
+        dword(0);
+        return code.size();
+    }
+    /// jmp rel32
+    /// @return label for bind()
+    size_t jump()
+    {
+        byte(0xe9);
+        dword(0);
+        return code.size();
+    }
+    /// set target of jump to current position
+    void bind(size_t label)
+    {
+        auto rel = static_cast<std::int32_t>(code.size() - label);
+        std::memcpy(&code[label - sizeof(rel)], &rel, sizeof(rel));
+    }
+
+    void prologue()
+    {
+        byte(0x53);               // push rbx
+        byte(0x41); byte(0x54);   // push r12
+        byte(0x41); byte(0x55);   // push r13
+        byte(0x49); byte(0x89); modrm(0b11, rdi, r12); // mov r12, rdi
+        byte(0x49); byte(0x8b); at_r12(rbx, registers_offset); // mov rbx, [r12 + registers]
+        byte(0x4d); byte(0x8b); at_r12(r13, memory_offset);    // mov r13, [r12 + memory]
+    }
+    void epilogue()
+    {
+        byte(0x41); byte(0x5d);   // pop r13
+        byte(0x41); byte(0x5c);   // pop r12
+        byte(0x5b);               // pop rbx
+        byte(0xc3);               // ret
+    }
+
+    /// num of guest instructions retired before current one
+    std::uint32_t retired_before = 0;
+    /// num of guest instructions retired after current one
+    std::uint32_t retired_after = 0;
+
+    /// leave native code, PC = instruction address
+    void exit(address_t pc, address_t target, jit_compiler::exit_code result)
+    {
+        store_guest(RegAlias::pc, pc);
+        store_context(target_offset, target);
+        store_context(executed_offset, result == jit_compiler::exit_interpret ? retired_before : retired_after);
+        mov(rax, result);
+        epilogue();
+    }
+    /// leave native code if helper failed, rax = exit code
+    void exit_on_error(address_t pc)
+    {
+        test(rax);
+        auto ok = jump_if(cc_e);
+        store_guest(RegAlias::pc, pc);
+        store_context(target_offset, pc + sizeof(opcode::opcode_t));
+        store_context(executed_offset, retired_before);
+        epilogue();
+        bind(ok);
+    }
+
+    /**
+     * direct memory access, address in rsi
+     *
+     * misaligned address, store into translated code and fault
+     * of access exit to interpreter
+     * @param size size of access
+     * @param is_store store checks translated code
+     * @param access emits instruction of access
+     * @param done emits code after successful access
+     */
+    template<typename Access, typename Done>
+    void access_memory(address_t pc, std::uint8_t size, bool is_store, Access access, Done done)
+    {
+        std::vector<size_t> slow;
+        if (size > 1)
+        {
+            test(rsi, size - 1);
+            slow.push_back(jump_if(cc_ne));
+        }
+        if (is_store)
+        {
+            // (address - code_start) < code_size
+            mov(rax, rsi);
+            op_context(alu_sub, rax, code_start_offset);
+            op_context(alu_cmp, rax, code_size_offset);
+            slow.push_back(jump_if(cc_b));
+        }
+        const auto site = code.size();
+        access();
+        done();
+        const auto ok = jump();
+        for (auto label: slow) bind(label);
+        sites.emplace_back(site, code.size());
+        exit(pc, pc, jit_compiler::exit_interpret);
+        bind(ok);
+    }
+};
+
+/// kind of translation
+enum class op_kind: std::uint8_t
+{
+    alu_reg, alu_imm, shift_reg, shift_imm, set_reg, set_imm, mul, math,
+    lui, auipc, load, store, branch, jal, jalr,
+    constant, shift_add, call, set_branch,
+};
+
+struct op_info
+{
+    op_kind kind;
+    std::uint8_t param = 0;
+    binary_fn fn = nullptr;
+    /// condition of branch for set_branch
+    std::uint8_t branch = 0;
+};
+
+/// supported handlers
+const op_info* find_info(const decoded_instruction& op)
+{
+    using namespace rv32i;
+    using namespace rv32m;
+    static const std::unordered_map<std::type_index, op_info> known{
+        {typeid(add_r),  {op_kind::alu_reg, alu_add}},
+        {typeid(sub_r),  {op_kind::alu_reg, alu_sub}},
+        {typeid(xor_r),  {op_kind::alu_reg, alu_xor}},
+        {typeid(or_r),   {op_kind::alu_reg, alu_or}},
+        {typeid(and_r),  {op_kind::alu_reg, alu_and}},
+        {typeid(sll_r),  {op_kind::shift_reg, shift_shl}},
+        {typeid(srl_r),  {op_kind::shift_reg, shift_shr}},
+        {typeid(sra_r),  {op_kind::shift_reg, shift_sar}},
+        {typeid(slt_r),  {op_kind::set_reg, cc_l}},
+        {typeid(sltu_r), {op_kind::set_reg, cc_b}},
+        {typeid(addi),   {op_kind::alu_imm, alu_add}},
+        {typeid(xori),   {op_kind::alu_imm, alu_xor}},
+        {typeid(ori),    {op_kind::alu_imm, alu_or}},
+        {typeid(andi),   {op_kind::alu_imm, alu_and}},
+        {typeid(slli),   {op_kind::shift_imm, shift_shl}},
+        {typeid(srli),   {op_kind::shift_imm, shift_shr}},
+        {typeid(srai),   {op_kind::shift_imm, shift_sar}},
+        {typeid(slti),   {op_kind::set_imm, cc_l}},
+        {typeid(sltiu),  {op_kind::set_imm, cc_b}},
+        {typeid(rv32m::mul), {op_kind::mul}},
+        {typeid(mulh),   {op_kind::math, 0, &mulh::calculate}},
+        {typeid(mulhsu), {op_kind::math, 0, &mulhsu::calculate}},
+        {typeid(mulhu),  {op_kind::math, 0, &mulhu::calculate}},
+        {typeid(rv32m::div), {op_kind::math, 0, &rv32m::div::calculate}},
+        {typeid(divu),   {op_kind::math, 0, &divu::calculate}},
+        {typeid(rem),    {op_kind::math, 0, &rem::calculate}},
+        {typeid(remu),   {op_kind::math, 0, &remu::calculate}},
+        {typeid(lui),    {op_kind::lui}},
+        {typeid(auipc),  {op_kind::auipc}},
+        {typeid(lb),     {op_kind::load, 0b000}},
+        {typeid(lh),     {op_kind::load, 0b001}},
+        {typeid(lw),     {op_kind::load, 0b010}},
+        {typeid(lbu),    {op_kind::load, 0b100}},
+        {typeid(lhu),    {op_kind::load, 0b101}},
+        {typeid(sb),     {op_kind::store, 1}},
+        {typeid(sh),     {op_kind::store, 2}},
+        {typeid(sw),     {op_kind::store, 4}},
+        {typeid(beq),    {op_kind::branch, cc_e}},
+        {typeid(bne),    {op_kind::branch, cc_ne}},
+        {typeid(blt),    {op_kind::branch, cc_l}},
+        {typeid(bge),    {op_kind::branch, cc_ge}},
+        {typeid(bltu),   {op_kind::branch, cc_b}},
+        {typeid(bgeu),   {op_kind::branch, cc_ae}},
+        {typeid(jal),    {op_kind::jal}},
+        {typeid(jalr),   {op_kind::jalr}},
+        {typeid(fusion::li),        {op_kind::constant}},
+        {typeid(fusion::la),        {op_kind::constant}},
+        {typeid(fusion::shift_add), {op_kind::shift_add}},
+        {typeid(fusion::call),      {op_kind::call}},
+        {typeid(fusion::slt_beq),   {op_kind::set_branch, cc_l, nullptr, cc_e}},
+        {typeid(fusion::slt_bne),   {op_kind::set_branch, cc_l, nullptr, cc_ne}},
+        {typeid(fusion::sltu_beq),  {op_kind::set_branch, cc_b, nullptr, cc_e}},
+        {typeid(fusion::sltu_bne),  {op_kind::set_branch, cc_b, nullptr, cc_ne}},
+    };
+    auto it = known.find(typeid(*op.handler));
+    return it != known.end() ? &it->second : nullptr;
+}
+
+/**
+ * translate instruction
+ * @return false if instruction ends native code
+ */
+bool emit(emitter& out, const op_info& info, const decoded_instruction& op, address_t pc)
+{
+    constexpr address_t next = sizeof(opcode::opcode_t);
+    switch (info.kind)
+    {
+    case op_kind::alu_reg:
+    case op_kind::shift_reg:
+    case op_kind::set_reg:
+    case op_kind::mul:
+        if (op.rd == 0) break;
+        out.load_guest(rax, op.rs1);
+        out.load_guest(rcx, op.rs2);
+        if (info.kind == op_kind::alu_reg) out.op(alu(info.param), rax, rcx);
+        if (info.kind == op_kind::shift_reg) out.shift_cl(shift(info.param), rax);
+        if (info.kind == op_kind::mul) out.imul(rax, rcx);
+        if (info.kind == op_kind::set_reg)
+        {
+            out.op(alu_cmp, rax, rcx);
+            out.set_if(cond(info.param), rax);
+        }
+        out.store_guest(op.rd, rax);
+        break;
+    case op_kind::math:
+        if (op.rd == 0) break;
+        out.load_guest(rdi, op.rs1);
+        out.load_guest(rsi, op.rs2);
+        out.call(reinterpret_cast<const void*>(info.fn));
+        out.store_guest(op.rd, rax);
+        break;
+    case op_kind::alu_imm:
+    case op_kind::shift_imm:
+    case op_kind::set_imm:
+        if (op.rd == 0) break;
+        out.load_guest(rax, op.rs1);
+        if (info.kind == op_kind::alu_imm) out.op(alu(info.param), rax, op.imm);
+        if (info.kind == op_kind::shift_imm) out.shift_imm(shift(info.param), rax, op.imm & 0x1f);
+        if (info.kind == op_kind::set_imm)
+        {
+            out.op(alu_cmp, rax, op.imm);
+            out.set_if(cond(info.param), rax);
+        }
+        out.store_guest(op.rd, rax);
+        break;
+    case op_kind::lui:
+        if (op.rd != 0) out.store_guest(op.rd, op.imm);
+        break;
+    case op_kind::auipc:
+        if (op.rd != 0) out.store_guest(op.rd, op.imm + pc);
+        break;
+    case op_kind::load:
+        out.load_guest(rsi, op.rs1);
+        out.op(alu_add, rsi, op.imm);
+        if (out.direct)
+        {
+            out.access_memory(pc, 1 << (info.param & 0b11), false,
+                [&] { out.load_memory(rax, info.param); },
+                [&] { if (op.rd != 0) out.store_guest(op.rd, rax); });
+            break;
+        }
+        out.mov(rdx, info.param);
+        out.context_arg();
+        out.call(reinterpret_cast<const void*>(&jit_compiler::load));
+        out.exit_on_error(pc);
+        if (op.rd != 0)
+        {
+            out.load_context(rax, value_offset);
+            out.store_guest(op.rd, rax);
+        }
+        break;
+    case op_kind::store:
+        out.load_guest(rsi, op.rs1);
+        out.op(alu_add, rsi, op.imm);
+        out.load_guest(rcx, op.rs2);
+        if (out.direct)
+        {
+            out.access_memory(pc, info.param, true,
+                [&] { out.store_memory(rcx, info.param); },
+                [] {});
+            break;
+        }
+        out.mov(rdx, info.param);
+        out.context_arg();
+        out.call(reinterpret_cast<const void*>(&jit_compiler::store));
+        out.exit_on_error(pc);
+        break;
+    case op_kind::branch:
+    {
+        out.load_guest(rax, op.rs1);
+        out.load_guest(rcx, op.rs2);
+        out.op(alu_cmp, rax, rcx);
+        auto taken = out.jump_if(cond(info.param));
+        out.exit(pc, pc + next, jit_compiler::exit_next);
+        out.bind(taken);
+        out.exit(pc, pc + op.imm, jit_compiler::exit_jump);
+        return false;
+    }
+    case op_kind::jal:
+        if (op.rd != 0) out.store_guest(op.rd, pc + next);
+        out.exit(pc, pc + op.imm, jit_compiler::exit_jump);
+        return false;
+    case op_kind::jalr:
+        out.load_guest(rax, op.rs1);
+        out.op(alu_add, rax, op.imm);
+        out.op(alu_and, rax, ~1u);
+        out.store_context(target_offset, rax);
+        if (op.rd != 0) out.store_guest(op.rd, pc + next);
+        out.store_guest(RegAlias::pc, pc);
+        out.store_context(executed_offset, out.retired_after);
+        out.mov(rax, jit_compiler::exit_jump);
+        out.epilogue();
+        return false;
+    case op_kind::constant:
+        out.store_guest(op.rd, op.imm);
+        break;
+    case op_kind::shift_add:
+        out.load_guest(rax, op.rs1);
+        out.shift_imm(shift_shl, rax, op.imm);
+        out.store_guest(op.rd, rax);
+        if (op.rd2 == 0) break;
+        out.load_guest(rcx, op.rs2);
+        out.op(alu_add, rax, rcx);
+        out.store_guest(op.rd2, rax);
+        break;
+    case op_kind::call:
+        out.store_guest(op.rd, op.imm + op.code.decode_u());
+        if (op.rd2 != 0) out.store_guest(op.rd2, pc + 2 * next);
+        out.exit(pc, op.imm2, jit_compiler::exit_jump);
+        return false;
+    case op_kind::set_branch:
+    {
+        out.load_guest(rax, op.rs1);
+        out.load_guest(rcx, op.rs2);
+        out.op(alu_cmp, rax, rcx);
+        out.set_if(cond(info.param), rax);
+        out.store_guest(op.rd, rax);
+        out.test(rax);
+        auto taken = out.jump_if(cond(info.branch));
+        out.exit(pc, pc + 2 * next, jit_compiler::exit_next);
+        out.bind(taken);
+        out.exit(pc, op.imm2, jit_compiler::exit_jump);
+        return false;
+    }
+    }
+    return true;
+}
+
+} // namespace
+
+jit_compiler::jit_compiler()
+{
+    void* ptr = mmap(nullptr, buffer_size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED)
+    {
+        buffer = static_cast<std::uint8_t*>(ptr);
+    }
+    full = buffer == nullptr;
+}
+
+jit_compiler::~jit_compiler()
+{
+    if (buffer)
+    {
+        munmap(buffer, buffer_size);
+    }
+}
+
+bool jit_compiler::is_supported()
+{
+    return true;
+}
+
+jit_compiler::function jit_compiler::compile(const basic_block &block)
+{
+    if (full) [[unlikely]] return nullptr;
+
+    emitter out;
+    out.direct = direct;
+    out.prologue();
+    address_t pc = block.start;
+    bool open = true;
+    for (const auto& op: block.ops)
+    {
+        out.retired_before = out.retired_after;
+        out.retired_after += op.size;
+        auto info = find_info(op);
+        if (!info)
+        {
+            if (pc == block.start) return nullptr; // nothing to compile
+            out.exit(pc, pc, exit_interpret);
+            open = false;
+            break;
+        }
+        open = emit(out, *info, op, pc);
+        if (!open) break;
+        pc += op.size * sizeof(opcode::opcode_t);
+    }
+    if (open)
+    {
+        // block ends without jump
+        out.retired_before = out.retired_after;
+        out.exit(pc - sizeof(opcode::opcode_t), pc, exit_next);
+    }
+
+    constexpr size_t alignment = 16;
+    const size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (start + out.code.size() > buffer_size) [[unlikely]]
+    {
+        full = true;
+        return nullptr;
+    }
+    // W^X: buffer is writable only while code is copied
+    if (mprotect(buffer, buffer_size, PROT_READ | PROT_WRITE) != 0) [[unlikely]]
+    {
+        full = true;
+        return nullptr;
+    }
+    std::memcpy(buffer + start, out.code.data(), out.code.size());
+    if (mprotect(buffer, buffer_size, PROT_READ | PROT_EXEC) != 0) [[unlikely]]
+    {
+        full = true;
+        return nullptr;
+    }
+    used = start + out.code.size();
+    const auto base = reinterpret_cast<std::uintptr_t>(buffer + start);
+    for (auto [site, recovery]: out.sites)
+    {
+        sites.push_back({base + site, base + recovery});
+    }
+    return reinterpret_cast<function>(buffer + start);
+}
+
+void jit_compiler::reset()
+{
+    used = 0;
+    full = buffer == nullptr;
+    sites.clear();
+}
+
+#ifdef YETI_JIT_DIRECT_MEMORY
+
+namespace
+{
+/// native code running on this thread
+thread_local const jit_compiler* active_compiler = nullptr;
+thread_local const jit_compiler::context* active_context = nullptr;
+
+struct sigaction previous_segv{};
+struct sigaction previous_bus{};
+
+void on_fault(int signal, siginfo_t* info, void* ucontext)
+{
+    if (jit_compiler::recover(info->si_addr, ucontext))
+    {
+        return;
+    }
+    const auto& previous = signal == SIGBUS ? previous_bus : previous_segv;
+    if (previous.sa_flags & SA_SIGINFO)
+    {
+        previous.sa_sigaction(signal, info, ucontext);
+    }
+    else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+    {
+        previous.sa_handler(signal);
+    }
+    else
+    {
+        // fault is raised again with default action
+        std::signal(signal, SIG_DFL);
+    }
+}
+
+void install_fault_handler()
+{
+    static std::once_flag installed;
+    std::call_once(installed, []
+    {
+        struct sigaction action{};
+        action.sa_sigaction = &on_fault;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &previous_segv);
+        sigaction(SIGBUS, &action, &previous_bus);
+    });
+}
+} // namespace
+
+bool jit_compiler::enable_direct_memory(bool enable)
+{
+    if (enable)
+    {
+        install_fault_handler();
+    }
+    direct = enable;
+    return true;
+}
+
+std::uint32_t jit_compiler::execute(function fn, context &ctx) const
+{
+    const auto* compiler = active_compiler;
+    const auto* state = active_context;
+    active_compiler = this;
+    active_context = &ctx;
+    const auto result = fn(&ctx);
+    active_compiler = compiler;
+    active_context = state;
+    return result;
+}
+
+bool jit_compiler::recover(const void *address, void *ucontext) noexcept
+{
+    if (!active_compiler || !active_context || !active_context->memory)
+    {
+        return false;
+    }
+    const auto offset = static_cast<const std::uint8_t*>(address) - active_context->memory;
+    if (offset < 0 || static_cast<std::uint64_t>(offset) >= guest_space::space_size + guest_space::guard_size)
+    {
+        return false;
+    }
+    auto& registers = static_cast<ucontext_t*>(ucontext)->uc_mcontext.gregs;
+    const auto ip = static_cast<std::uintptr_t>(registers[REG_RIP]);
+    const auto& sites = active_compiler->sites;
+    auto it = std::lower_bound(sites.begin(), sites.end(), ip,
+                               [](const fault_site& site, std::uintptr_t value) { return site.address < value; });
+    if (it == sites.end() || it->address != ip)
+    {
+        return false;
+    }
+    registers[REG_RIP] = static_cast<greg_t>(it->recovery);
+    return true;
+}
+
+#endif // YETI_JIT_DIRECT_MEMORY
+
+#else // no native backend for host
+
+jit_compiler::jit_compiler() = default;
+
+jit_compiler::~jit_compiler() = default;
+
+bool jit_compiler::is_supported()
+{
+    return false;
+}
+
+jit_compiler::function jit_compiler::compile(const basic_block&)
+{
+    return nullptr;
+}
+
+void jit_compiler::reset()
+{
+}
+
+#endif // YETI_JIT_X86_64
+
+#ifndef YETI_JIT_DIRECT_MEMORY
+
+bool jit_compiler::enable_direct_memory(bool enable)
+{
+    direct = false;
+    return !enable;
+}
+
+std::uint32_t jit_compiler::execute(function fn, context &ctx) const
+{
+    return fn(&ctx);
+}
+
+bool jit_compiler::recover(const void*, void*) noexcept
+{
+    return false;
+}
+
+#endif // YETI_JIT_DIRECT_MEMORY
+
+bool jit_compiler::is_full() const
+{
+    return full;
+}
+
+std::uint32_t jit_compiler::load(context *ctx, address_t address, std::uint32_t type) noexcept
+{
+    const std::uint8_t size = 1 << (type & 0b11);
+    const bool is_signed = (type & 0b100) == 0;
+    register_t value = 0;
+    try
+    {
+        ctx->vm->read_memory(address, size, value);
+    }
+    catch (...)
+    {
+        return exit_interpret; // interpreter reports error
+    }
+    if (ctx->vm->pending) [[unlikely]]
+    {
+        return exit_interpret;
+    }
+    if (is_signed && size < sizeof(value))
+    {
+        const auto sign_bit = register_t{1} << (size * 8 - 1);
+        if (value & sign_bit)
+        {
+            value |= ~((sign_bit << 1) - 1);
+        }
+    }
+    ctx->value = value;
+    return 0;
+}
+
+std::uint32_t jit_compiler::store(context *ctx, address_t address, std::uint32_t size, register_t value) noexcept
+{
+    try
+    {
+        ctx->vm->write_memory(address, size, value);
+    }
+    catch (...)
+    {
+        return exit_interpret; // interpreter reports error
+    }
+    if (ctx->vm->pending) [[unlikely]]
+    {
+        return exit_interpret;
+    }
+    // code was modified or VM stopped
+    return ctx->vm->block_interrupt ? static_cast<std::uint32_t>(exit_interrupt) : 0;
+}
+
+} // namespace vm
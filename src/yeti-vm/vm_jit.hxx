@@ -0,0 +1,128 @@
+/// native code generation for hot basic blocks
+#pragma once
+
+#include "vm_base_types.hxx"
+#include "vm_blocks.hxx"
+
+namespace vm
+{
+
+struct basic_vm;
+
+/**
+ * x86-64 backend: compiles basic blocks into machine code
+ *
+ * guest registers are kept in register file of VM,
+ * memory access calls back into basic_vm or uses reserved guest space directly,
+ * system instructions and faults exit to interpreter
+ */
+struct jit_compiler
+{
+    using address_t = std::uint32_t;
+    using function = basic_block::native_function;
+
+    /// state passed to native code
+    struct context
+    {
+        /// register file of VM
+        register_t* registers = nullptr;
+        /// VM for memory access
+        basic_vm* vm = nullptr;
+        /// next PC value
+        address_t target = 0;
+        /// result of load
+        register_t value = 0;
+        /// num of retired guest instructions
+        std::uint32_t executed = 0;
+        /// host address of guest address 0 for direct memory access
+        std::uint8_t* memory = nullptr;
+        /// translated code, direct store into it exits to interpreter
+        address_t code_start = 0;
+        address_t code_size = 0;
+    };
+
+    /// result of native code
+    enum exit_code: std::uint32_t
+    {
+        /// continue from target
+        exit_next = 1,
+        /// jump to target
+        exit_jump = 2,
+        /// execute instruction at PC by interpreter
+        exit_interpret = 3,
+        /// instruction at PC is done, continue from target
+        exit_interrupt = 4,
+    };
+
+    /// num of block executions before compilation
+    static constexpr std::uint32_t threshold = 16;
+    /// size of buffer for machine code
+    static constexpr size_t buffer_size = 4 * 1024 * 1024;
+
+    jit_compiler();
+    ~jit_compiler();
+
+    jit_compiler(const jit_compiler&) = delete;
+    jit_compiler& operator=(const jit_compiler&) = delete;
+
+    /// native code can be generated for host
+    [[nodiscard]]
+    static bool is_supported();
+
+    /// compile block
+    /// @return nullptr if block can not be compiled
+    [[nodiscard]]
+    function compile(const basic_block& block);
+
+    /// drop all compiled code
+    void reset();
+
+    /// no space for new code, reset() required
+    [[nodiscard]]
+    bool is_full() const;
+
+    /**
+     * access memory by context::memory instead of helpers
+     *
+     * faults of native code are recovered by signal handler,
+     * faulting instruction is executed by interpreter.
+     * applied on next compilation, call reset() before
+     * @return false if direct access is not supported on host
+     */
+    bool enable_direct_memory(bool enable);
+
+    /// run compiled code with fault recovery
+    std::uint32_t execute(function fn, context& ctx) const;
+
+    /**
+     * redirect faulting memory access of active native code to exit
+     * @param address faulting host address
+     * @param ucontext context of signal handler
+     * @return false if fault is not caused by native code
+     */
+    static bool recover(const void* address, void* ucontext) noexcept;
+
+    /// load helper, called from native code
+    /// @return 0 on success or exit code
+    static std::uint32_t load(context* ctx, address_t address, std::uint32_t type) noexcept;
+
+    /// store helper, called from native code
+    /// @return 0 on success or exit code
+    static std::uint32_t store(context* ctx, address_t address, std::uint32_t size, register_t value) noexcept;
+private:
+    /// memory access of native code which may fault
+    struct fault_site
+    {
+        std::uintptr_t address;
+        std::uintptr_t recovery;
+    };
+
+    std::uint8_t* buffer = nullptr;
+    size_t used = 0;
+    bool full = false;
+    bool direct = false;
+    /// sorted by address
+    std::vector<fault_site> sites;
+};
+
+} // namespace vm
@@ -0,0 +1,438 @@
+#include "vm_linux_abi.hxx"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define YETI_HOST_FILES 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/openat2.h>)
+#define YETI_OPENAT2 1
+#include <linux/openat2.h>
+#include <sys/syscall.h>
+#endif
+
+namespace vm
+{
+
+namespace
+{
+
+/// errors of guest, as in Linux
+constexpr register_t error_bad_file = 9;
+constexpr register_t error_access = 13;
+constexpr register_t error_fault = 14;
+constexpr register_t error_name = 36;
+constexpr register_t error_overflow = 75;
+
+/// dirfd of openat() for current directory
+constexpr auto guest_cwd = static_cast<register_t>(-100);
+
+/// flags of openat(), asm-generic
+constexpr register_t guest_access_mode = 03;
+constexpr register_t guest_write_only = 01;
+constexpr register_t guest_read_write = 02;
+constexpr register_t guest_create = 0100;
+constexpr register_t guest_exclusive = 0200;
+constexpr register_t guest_truncate = 01000;
+constexpr register_t guest_append = 02000;
+constexpr register_t guest_directory = 0200000;
+
+/// max length of path
+constexpr register_t max_path = 4096;
+
+/// struct stat of libgloss for RISC-V(kernel_stat), 64-bit fields
+struct guest_stat
+{
+    std::uint64_t dev;
+    std::uint64_t ino;
+    std::uint32_t mode;
+    std::uint32_t nlink;
+    std::uint32_t uid;
+    std::uint32_t gid;
+    std::uint64_t rdev;
+    std::uint64_t pad1;
+    std::int64_t size;
+    std::int32_t blksize;
+    std::int32_t pad2;
+    std::int64_t blocks;
+    /// atime, mtime, ctime: seconds and nanoseconds
+    struct { std::int64_t sec; std::int32_t nsec; std::int32_t pad; } times[3];
+    std::int32_t reserved[2];
+};
+static_assert(sizeof(guest_stat) == 128);
+
+/// file type of char device
+constexpr std::uint32_t guest_char_device = 0020000;
+
+constexpr register_t to_error(register_t code)
+{
+    return static_cast<register_t>(-static_cast<std::int32_t>(code));
+}
+
+} // namespace
+
+#ifdef YETI_HOST_FILES
+
+struct linux_abi::calls
+{
+    static linux_abi& abi_of(void* context)
+    {
+        return *static_cast<linux_abi*>(context);
+    }
+
+    /// registered in registry of basic_vm only
+    static basic_vm& machine_of(vm_interface* vm)
+    {
+        return *static_cast<basic_vm*>(vm);
+    }
+
+    static void set_result(vm_interface* vm, std::int64_t result)
+    {
+        vm->set_register(RegAlias::a0, result < 0 ? to_error(errno) : static_cast<register_t>(result));
+    }
+
+    /// read zero-terminated path from guest memory
+    static register_t read_path(const basic_vm& machine, register_t address, std::string& path)
+    {
+        for (register_t i = 0; i < max_path; ++i)
+        {
+            auto view = machine.get_guest_span(address + i, 1);
+            if (!view) return error_fault;
+            const auto value = static_cast<char>(view->front());
+            if (value == '\0') return 0;
+            path.push_back(value);
+        }
+        return error_name;
+    }
+
+    /// path is relative and does not leave root
+    static bool is_allowed(const std::string& path)
+    {
+        const std::filesystem::path value{path};
+        return value.is_relative()
+            && std::none_of(value.begin(), value.end(), [](const auto& part) { return part == ".."; });
+    }
+
+    /// open path by components, symlinks are not followed
+    static int open_nofollow(int dir_fd, const std::string& path, int flags, mode_t mode)
+    {
+        const std::filesystem::path value{path};
+        int current = dir_fd;
+        for (const auto& part: value.parent_path())
+        {
+            const int next = ::openat(current, part.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            const int error = errno;
+            if (current != dir_fd) ::close(current);
+            if (next < 0)
+            {
+                errno = error;
+                return next;
+            }
+            current = next;
+        }
+        // "dir/" opens directory itself
+        const auto leaf = (value.filename().empty() && !path.empty()) ? std::filesystem::path{"."} : value.filename();
+        const int fd = ::openat(current, leaf.c_str(), flags | O_NOFOLLOW, mode);
+        const int error = errno;
+        if (current != dir_fd) ::close(current);
+        errno = error;
+        return fd;
+    }
+
+    /// open path beneath directory, symlinks do not lead out of it
+    static int open_beneath(int dir_fd, const std::string& path, int flags, mode_t mode)
+    {
+#ifdef YETI_OPENAT2
+        open_how how{};
+        how.flags = static_cast<std::uint64_t>(flags);
+        how.mode = (flags & O_CREAT) ? mode : 0;
+        how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+        const auto fd = ::syscall(SYS_openat2, dir_fd, path.c_str(), &how, sizeof(how));
+        // kernel before 5.6 or syscall is filtered
+        if (fd >= 0 || errno != ENOSYS) return static_cast<int>(fd);
+#endif
+        return open_nofollow(dir_fd, path, flags, mode);
+    }
+
+    static int to_host_flags(register_t flags)
+    {
+        int result = O_RDONLY;
+        if ((flags & guest_access_mode) == guest_write_only) result = O_WRONLY;
+        if ((flags & guest_access_mode) == guest_read_write) result = O_RDWR;
+        if (flags & guest_create) result |= O_CREAT;
+        if (flags & guest_exclusive) result |= O_EXCL;
+        if (flags & guest_truncate) result |= O_TRUNC;
+        if (flags & guest_append) result |= O_APPEND;
+        if (flags & guest_directory) result |= O_DIRECTORY;
+        return result | O_CLOEXEC;
+    }
+
+    static void open_at(vm_interface* vm, linux_abi& abi, register_t dir, register_t address, register_t flags, register_t mode)
+    {
+        const int dir_fd = (dir == guest_cwd) ? abi.root_fd : abi.find_file(dir);
+        if (dir_fd < 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        std::string path;
+        if (auto error = read_path(machine_of(vm), address, path); error != 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error));
+            return;
+        }
+        if (!is_allowed(path))
+        {
+            vm->set_register(RegAlias::a0, to_error(error_access));
+            return;
+        }
+        const int fd = open_beneath(dir_fd, path, to_host_flags(flags), static_cast<mode_t>(mode & 07777));
+        if (fd < 0)
+        {
+            set_result(vm, fd);
+            return;
+        }
+        // lowest free guest fd
+        auto it = std::find(abi.files.begin(), abi.files.end(), closed_fd);
+        if (it == abi.files.end())
+        {
+            it = abi.files.insert(it, closed_fd);
+        }
+        *it = fd;
+        vm->set_register(RegAlias::a0, static_cast<register_t>(it - abi.files.begin()));
+    }
+
+    static void openat(vm_interface* vm, void* context)
+    {
+        open_at(vm, abi_of(context), vm->get_register(RegAlias::a0), vm->get_register(RegAlias::a1),
+                vm->get_register(RegAlias::a2), vm->get_register(RegAlias::a3));
+    }
+
+    static void open(vm_interface* vm, void* context)
+    {
+        open_at(vm, abi_of(context), guest_cwd, vm->get_register(RegAlias::a0),
+                vm->get_register(RegAlias::a1), vm->get_register(RegAlias::a2));
+    }
+
+    static void close(vm_interface* vm, void* context)
+    {
+        auto& abi = abi_of(context);
+        const auto fd = vm->get_register(RegAlias::a0);
+        const int file = abi.find_file(fd);
+        if (file == closed_fd)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        abi.files[fd] = closed_fd;
+        // stdin and console of host are not closed, file opened into slot 0..2 is
+        set_result(vm, (file == STDIN_FILENO || file == console_fd) ? 0 : ::close(file));
+    }
+
+    static void read(vm_interface* vm, void* context)
+    {
+        auto& abi = abi_of(context);
+        const int file = abi.find_file(vm->get_register(RegAlias::a0));
+        if (file < 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        auto buffer = machine_of(vm).get_guest_span(vm->get_register(RegAlias::a1), vm->get_register(RegAlias::a2));
+        if (!buffer)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_fault));
+            return;
+        }
+        if (file == STDIN_FILENO)
+        {
+            abi.out.flush(); // prompt is visible before input
+        }
+        set_result(vm, ::read(file, buffer->data(), buffer->size()));
+    }
+
+    static void write(vm_interface* vm, void* context)
+    {
+        auto& abi = abi_of(context);
+        const auto address = vm->get_register(RegAlias::a1);
+        const auto size = vm->get_register(RegAlias::a2);
+        const int file = abi.find_file(vm->get_register(RegAlias::a0));
+        if (file == console_fd)
+        {
+            bool ok = abi.out.write(machine_of(vm), address, size);
+            vm->set_register(RegAlias::a0, ok ? size : to_error(error_fault));
+            return;
+        }
+        if (file < 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        auto buffer = std::as_const(machine_of(vm)).get_guest_span(address, size);
+        if (!buffer)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_fault));
+            return;
+        }
+        set_result(vm, ::write(file, buffer->data(), buffer->size()));
+    }
+
+    static void lseek(vm_interface* vm, void* context)
+    {
+        const int file = abi_of(context).find_file(vm->get_register(RegAlias::a0));
+        if (file < 0)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        const auto result = ::lseek(file, to_signed(vm->get_register(RegAlias::a1)),
+                                    static_cast<int>(vm->get_register(RegAlias::a2)));
+        if (result > std::numeric_limits<std::int32_t>::max())
+        {
+            vm->set_register(RegAlias::a0, to_error(error_overflow));
+            return;
+        }
+        set_result(vm, result);
+    }
+
+    static void fstat(vm_interface* vm, void* context)
+    {
+        const int file = abi_of(context).find_file(vm->get_register(RegAlias::a0));
+        if (file == closed_fd)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_bad_file));
+            return;
+        }
+        auto buffer = machine_of(vm).get_guest_span(vm->get_register(RegAlias::a1), sizeof(guest_stat));
+        if (!buffer)
+        {
+            vm->set_register(RegAlias::a0, to_error(error_fault));
+            return;
+        }
+
+        guest_stat result{};
+        if (file == console_fd)
+        {
+            // newlib uses line buffering for terminals
+            result.mode = guest_char_device | 0620;
+            result.blksize = static_cast<std::int32_t>(console::capacity);
+        }
+        else
+        {
+            struct stat host{};
+            if (::fstat(file, &host) < 0)
+            {
+                set_result(vm, -1);
+                return;
+            }
+            result.dev = host.st_dev;
+            result.ino = host.st_ino;
+            result.mode = host.st_mode;
+            result.nlink = static_cast<std::uint32_t>(host.st_nlink);
+            result.uid = host.st_uid;
+            result.gid = host.st_gid;
+            result.rdev = host.st_rdev;
+            result.size = host.st_size;
+            result.blksize = static_cast<std::int32_t>(host.st_blksize);
+            result.blocks = host.st_blocks;
+            result.times[0].sec = host.st_atime;
+            result.times[1].sec = host.st_mtime;
+            result.times[2].sec = host.st_ctime;
+        }
+        std::memcpy(buffer->data(), &result, sizeof(result));
+        vm->set_register(RegAlias::a0, 0);
+    }
+
+    static void brk(vm_interface* vm, void* context)
+    {
+        auto& abi = abi_of(context);
+        const auto address = vm->get_register(RegAlias::a0);
+        // break is not changed on failure, guest checks result
+        if (address >= abi.heap_start && address <= abi.heap_limit)
+        {
+            abi.heap_break = address;
+        }
+        vm->set_register(RegAlias::a0, abi.heap_break);
+    }
+
+    static void exit(vm_interface* vm, void* context)
+    {
+        auto& abi = abi_of(context);
+        abi.exited = true;
+        abi.exit_code = to_signed(vm->get_register(RegAlias::a0));
+        abi.out.flush();
+        vm->halt();
+    }
+};
+
+linux_abi::linux_abi(console &out, const std::filesystem::path &root)
+    : out{out}
+    , root_fd{::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)}
+    , files{STDIN_FILENO, console_fd, console_fd}
+{}
+
+linux_abi::~linux_abi()
+{
+    for (const int file: files)
+    {
+        if (file >= 0 && file != STDIN_FILENO)
+            ::close(file);
+    }
+    if (root_fd >= 0)
+        ::close(root_fd);
+}
+
+bool linux_abi::register_syscalls(basic_vm &machine)
+{
+    if (root_fd < 0) return false;
+    auto& sys = machine.get_syscalls();
+    if (!sys.is_free({openat_id, open_id, close_id, lseek_id, read_id, write_id, fstat_id,
+                      exit_id, exit_group_id, brk_id}))
+    {
+        return false;
+    }
+    bool ok = sys.register_handler(openat_id, "openat", calls::openat, this);
+    ok = ok && sys.register_handler(open_id, "open", calls::open, this);
+    ok = ok && sys.register_handler(close_id, "close", calls::close, this);
+    ok = ok && sys.register_handler(lseek_id, "lseek", calls::lseek, this);
+    ok = ok && sys.register_handler(read_id, "read", calls::read, this);
+    ok = ok && sys.register_handler(write_id, "write", calls::write, this);
+    ok = ok && sys.register_handler(fstat_id, "fstat", calls::fstat, this);
+    ok = ok && sys.register_handler(exit_id, "exit", calls::exit, this);
+    ok = ok && sys.register_handler(exit_group_id, "exit_group", calls::exit, this);
+    ok = ok && sys.register_handler(brk_id, "brk", calls::brk, this);
+    return ok;
+}
+
+#else // YETI_HOST_FILES
+
+linux_abi::linux_abi(console &out, const std::filesystem::path &)
+    : out{out}
+{}
+
+linux_abi::~linux_abi() = default;
+
+bool linux_abi::register_syscalls(basic_vm &)
+{
+    return false;
+}
+
+#endif // YETI_HOST_FILES
+
+void linux_abi::set_heap(register_t start, register_t limit)
+{
+    heap_start = start;
+    heap_limit = std::max(start, limit);
+    heap_break = start;
+}
+
+} // namespace vm
@@ -0,0 +1,120 @@
+/// Linux/newlib syscall ABI of RV32 guest backed by host files
+#pragma once
+
+#include "vm_basic.hxx"
+#include "vm_console.hxx"
+
+#include <filesystem>
+#include <vector>
+
+namespace vm
+{
+
+/**
+ * syscalls of guest built by RISC-V GCC toolchain(newlib/libgloss)
+ *
+ * IDs and errors follow Linux RV32: result is returned in a0, -errno on error.
+ * files are opened by host relative to root directory, absolute paths and ".." are rejected.
+ * symlinks do not lead out of root: Linux resolves them beneath root, other hosts do not follow them.
+ * data is moved by views of guest memory: buffer should not cross boundary of blocks.
+ * fd 1 and 2 are written to console, fd 0 is read from host stdin
+ */
+struct linux_abi
+{
+    /// syscall IDs
+    enum syscall_id: register_t
+    {
+        openat_id = 56,
+        close_id = 57,
+        lseek_id = 62,
+        read_id = 63,
+        write_id = 64,
+        fstat_id = 80,
+        exit_id = 93,
+        exit_group_id = 94,
+        brk_id = 214,
+        /// legacy open(path, flags, mode) of newlib
+        open_id = 1024,
+    };
+
+    /// stack reserved at end of data block, heap does not grow into it
+    static constexpr register_t def_stack_size = 64 * 1024;
+
+    /// host fd of guest fd 1 and 2
+    static constexpr int console_fd = -2;
+    /// closed guest fd
+    static constexpr int closed_fd = -1;
+
+    /**
+     * @param out console for fd 1 and 2
+     * @param root directory of guest files
+     */
+    linux_abi(console& out, const std::filesystem::path& root);
+    linux_abi(const linux_abi&) = delete;
+    linux_abi& operator=(const linux_abi&) = delete;
+    /// files opened by guest are closed
+    ~linux_abi();
+
+    /// set range of heap for brk(), break is set to start
+    void set_heap(register_t start, register_t limit);
+
+    /// current program break
+    [[nodiscard]]
+    register_t get_break() const noexcept
+    {
+        return heap_break;
+    }
+
+    /// exit() is called by guest
+    [[nodiscard]]
+    bool is_exited() const noexcept
+    {
+        return exited;
+    }
+
+    /// code passed to exit()
+    [[nodiscard]]
+    int get_exit_code() const noexcept
+    {
+        return exit_code;
+    }
+
+    /// host fd of guest fd, console_fd or closed_fd if guest fd is not host file
+    [[nodiscard]]
+    int find_file(register_t fd) const noexcept
+    {
+        return fd < files.size() ? files[fd] : closed_fd;
+    }
+
+    /// console of fd 1 and 2
+    [[nodiscard]]
+    console& get_console() const noexcept
+    {
+        return out;
+    }
+
+    /**
+     * register syscalls, layer should outlive machine
+     * @return false if host has no file API or ID is used, nothing is registered
+     */
+    [[nodiscard]]
+    bool register_syscalls(basic_vm& machine);
+private:
+    /// bodies of syscalls
+    struct calls;
+
+    console& out;
+    /// host fd of root directory
+    int root_fd = closed_fd;
+    /// host fd by guest fd
+    std::vector<int> files;
+
+    register_t heap_start = 0;
+    register_t heap_limit = 0;
+    register_t heap_break = 0;
+
+    bool exited = false;
+    int exit_code = 0;
+};
+
+} // namespace vm
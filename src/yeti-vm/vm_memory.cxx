@@ -1,4 +1,14 @@
 #include "vm_memory.hxx"
+#include "vm_program_image.hxx"
+
+#include <new>
+
+#if defined(__unix__)
+#define YETI_SPARSE_MEMORY 1
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 namespace vm
 {
@@ -10,20 +20,84 @@ bool memory_management_unit::add_block(memory_management_unit::value_type block)
     if (block->get_size() == 0)
         return false;
 
-    const auto& k = block->get_params();
+    if (!is_free(block->get_params()))
+        return false;
+    auto [it, ok] = memory.try_emplace(block->get_params(), block);
+    if (ok)
+    {
+        map_pages(block.get());
+    }
+    return ok;
+}
+
+std::uint64_t memory_management_unit::get_committed_size() const
+{
+    std::uint64_t result = 0;
+    for (const auto& pair: memory)
+    {
+        result += pair.second->get_committed_size();
+    }
+    return result;
+}
+
+bool memory_management_unit::is_free(const memory_management_unit::key_type &region) const
+{
     for (const auto& pair: memory)
     {
-        if (pair.first.is_overlap(k))
+        if (pair.first.is_overlap(region))
         {
             return false;
         }
     }
-    auto [it, ok] = memory.try_emplace(block->get_params(), block);
-    return ok;
+    return true;
+}
+
+void memory_management_unit::map_pages(memory_management_unit::pointer block)
+{
+    const std::uint64_t start = block->get_start_address();
+    const std::uint64_t end = start + block->get_size();
+    auto* host = block->get_host_memory();
+    for (std::uint64_t page = start & ~std::uint64_t{page_mask}; page < end; page += page_size)
+    {
+        auto& table = directory[page >> (page_bits + table_bits)];
+        if (!table)
+        {
+            table = std::make_unique<page_table>();
+        }
+        auto& entry = (*table)[(page >> page_bits) & (table_size - 1)];
+        if (page >= start && page + page_size <= end)
+        {
+            entry.block = block;
+            entry.host = host ? host + (page - start) : nullptr;
+        }
+        else
+        {
+            entry.shared = true;
+        }
+    }
 }
 
 memory_management_unit::pointer
 memory_management_unit::find_block(memory_block::address_type address, memory_block::size_type size) const
+{
+    const auto* page = find_page(address);
+    if (!page) [[unlikely]]
+    {
+        return nullptr;
+    }
+    if (page->block) [[likely]]
+    {
+        return page->block->get_params().in_range(address, size) ? page->block : nullptr;
+    }
+    if (page->shared)
+    {
+        return scan(address, size);
+    }
+    return nullptr;
+}
+
+memory_management_unit::pointer
+memory_management_unit::scan(memory_block::address_type address, memory_block::size_type size) const
 {
     for (const auto& pair: memory)
     {
@@ -70,6 +144,11 @@ generic_memory::generic_memory(memory_block::address_type address, memory_block:
         , data(size, 0)
 {}
 
+std::uint8_t *generic_memory::get_host_memory()
+{
+    return data.data();
+}
+
 const void *generic_memory::get_ro(memory_block::address_type address, memory_block::size_type size) const
 {
     if (!get_params().in_range(address, size))
@@ -84,6 +163,174 @@ void *generic_memory::get_rw(memory_block::address_type address, memory_block::s
     return data.data() + get_params().offset(address);
 }
 
+#ifdef YETI_SPARSE_MEMORY
+
+sparse_memory::sparse_memory(address_type address, size_type size)
+        : host_memory_block(address, size)
+{
+    if (size == 0)
+        return;
+    void* host = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (host == MAP_FAILED)
+    {
+        throw std::bad_alloc{};
+    }
+    data = static_cast<std::uint8_t*>(host);
+}
+
+sparse_memory::~sparse_memory()
+{
+    if (data)
+        munmap(data, get_size());
+}
+
+std::uint64_t get_private_size(const void *host, std::uint64_t size)
+{
+    const auto page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto start = reinterpret_cast<std::uintptr_t>(host) & ~(page_size - 1);
+    const auto end = reinterpret_cast<std::uintptr_t>(host) + size;
+    const auto count = (end - start + page_size - 1) / page_size;
+    if (count == 0)
+    {
+        return 0;
+    }
+    std::int64_t pages = -1;
+#ifdef __linux__
+    // entry of page map: bit 63 - present, bit 61 - file or shared page, bit 56 - exclusively mapped
+    if (int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC); fd >= 0)
+    {
+        std::vector<std::uint64_t> entries(count);
+        const auto bytes = static_cast<ssize_t>(entries.size() * sizeof(std::uint64_t));
+        if (pread(fd, entries.data(), bytes, static_cast<off_t>(start / page_size * sizeof(std::uint64_t))) == bytes)
+        {
+            pages = std::count_if(entries.begin(), entries.end(), [](auto entry)
+            {
+                constexpr std::uint64_t mask = (std::uint64_t{1} << 63) | (std::uint64_t{1} << 61) | (std::uint64_t{1} << 56);
+                constexpr std::uint64_t expected = (std::uint64_t{1} << 63) | (std::uint64_t{1} << 56);
+                return (entry & mask) == expected;
+            });
+        }
+        close(fd);
+    }
+#endif
+    if (pages < 0)
+    {
+        std::vector<unsigned char> flags(count);
+        if (mincore(reinterpret_cast<void*>(start), end - start, flags.data()) != 0)
+        {
+            return size;
+        }
+        pages = std::count_if(flags.begin(), flags.end(), [](auto flag) { return flag & 1; });
+    }
+    return std::min<std::uint64_t>(pages * page_size, size);
+}
+
+void prefault_pages(void *host, std::uint64_t size)
+{
+#ifdef MADV_POPULATE_WRITE
+    const auto page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto start = reinterpret_cast<std::uintptr_t>(host) & ~(page_size - 1);
+    const auto end = (reinterpret_cast<std::uintptr_t>(host) + size + page_size - 1) & ~(page_size - 1);
+    // error is not critical: pages are committed on first write
+    [[maybe_unused]] int status = madvise(reinterpret_cast<void*>(start), end - start, MADV_POPULATE_WRITE);
+#endif
+}
+
+#else // no lazy commit on host
+
+sparse_memory::sparse_memory(address_type address, size_type size)
+        : host_memory_block(address, size, new std::uint8_t[size]{})
+{}
+
+sparse_memory::~sparse_memory()
+{
+    delete[] data;
+}
+
+std::uint64_t get_private_size(const void*, std::uint64_t size)
+{
+    return size;
+}
+
+void prefault_pages(void*, std::uint64_t)
+{}
+
+#endif // YETI_SPARSE_MEMORY
+
+host_memory_block::host_memory_block(address_type address, size_type size, std::uint8_t *data)
+        : memory_block(address, size)
+        , data{data}
+{}
+
+bool host_memory_block::load(address_type address, void *dest, size_type size) const
+{
+    auto* ptr = get_ro(address, size);
+    if (!ptr)
+        return false;
+    std::memcpy(dest, ptr, size);
+    return true;
+}
+
+bool host_memory_block::store(address_type address, const void *source, size_type size)
+{
+    auto* ptr = get_rw(address, size);
+    if (!ptr)
+        return false;
+    std::memcpy(ptr, source, size);
+    return true;
+}
+
+std::uint8_t *host_memory_block::get_host_memory()
+{
+    return data;
+}
+
+std::uint64_t host_memory_block::get_committed_size() const
+{
+    return get_private_size(data, get_size());
+}
+
+bool host_memory_block::map_image(address_type address, const program_image &image)
+{
+    auto* target = find_image_target(data, address, image);
+    return target && image.map(target);
+}
+
+const void *host_memory_block::get_ro(address_type address, size_type size) const
+{
+    if (!get_params().in_range(address, size))
+        return nullptr;
+    return data + get_params().offset(address);
+}
+
+void *host_memory_block::get_rw(address_type address, size_type size)
+{
+    if (!get_params().in_range(address, size))
+        return nullptr;
+    return data + get_params().offset(address);
+}
+
+void memory_block::prefault(address_type address, size_type size)
+{
+    auto* host = get_host_memory();
+    if (host && get_params().in_range(address, size))
+    {
+        prefault_pages(host + get_params().offset(address), size);
+    }
+}
+
+std::uint8_t *memory_block::find_image_target(std::uint8_t *host, address_type address, const program_image &image) const
+{
+    const auto& params = get_params();
+    if (!host || !params.in_range(address) || image.get_mapped_size() > params.block_size - params.offset(address))
+        return nullptr;
+    auto* target = host + params.offset(address);
+    if (reinterpret_cast<std::uintptr_t>(target) % program_image::get_page_size())
+        return nullptr;
+    return target;
+}
+
 bool memory_block::params::is_overlap(memory_block::address_type address, memory_block::size_type size) const noexcept
 {
     if (address < block_start)
@@ -6,6 +6,8 @@
 namespace vm
 {
 
+struct program_image;
+
 template<typename T>
 concept standard_layout = std::is_standard_layout_v<T>;
 
@@ -82,6 +84,43 @@ struct memory_block
     [[nodiscard]]
     virtual bool store(memory_block::address_type address, const void * source, memory_block::size_type size) = 0;
 
+    /**
+     * host memory of block for direct access by VM
+     *
+     * blocks with side effects on load/store(MMIO) should return nullptr
+     * @return pointer to first byte of block or nullptr
+     */
+    [[nodiscard]]
+    virtual std::uint8_t * get_host_memory()
+    {
+        return nullptr;
+    }
+
+    /// num of bytes backed by host memory
+    [[nodiscard]]
+    virtual std::uint64_t get_committed_size() const
+    {
+        return get_size();
+    }
+
+    /**
+     * commit host pages of range before bulk write
+     *
+     * hint only, blocks without host memory ignore it
+     */
+    void prefault(address_type address, size_type size);
+
+    /**
+     * map private copy of image instead of copying it
+     * @param address start of image
+     * @return false if block can not map image, content is not changed
+     */
+    [[nodiscard]]
+    virtual bool map_image([[maybe_unused]] address_type address, [[maybe_unused]] const program_image& image)
+    {
+        return false;
+    }
+
     template<standard_layout Type>
     [[nodiscard]]
     const Type * get_ro_ptr(address_type address) const
@@ -98,6 +137,14 @@ struct memory_block
 
     virtual ~memory_block();
 protected:
+    /**
+     * check that image can replace pages of block
+     * @param host host memory of block
+     * @return host address of image or nullptr
+     */
+    [[nodiscard]]
+    std::uint8_t* find_image_target(std::uint8_t* host, address_type address, const program_image& image) const;
+
     explicit memory_block(address_type address, size_type size);
 
     [[nodiscard]]
@@ -108,12 +155,39 @@ protected:
     params block_params;
 };
 
+/**
+ * memory map of VM
+ *
+ * two-level page table over 32-bit address space gives O(1) lookup,
+ * pages covered by several blocks are resolved by list of blocks
+ */
 struct memory_management_unit
 {
     using key_type = memory_block::params;
     using value_type = memory_block::ptr;
     using pointer = memory_block *;
     using memory_blocks =  std::map<key_type, value_type>;
+    using address_type = memory_block::address_type;
+    using size_type = memory_block::size_type;
+
+    /// page size is 4 KiB
+    static constexpr size_type page_bits = 12;
+    static constexpr size_type page_size = size_type{1} << page_bits;
+    static constexpr size_type page_mask = page_size - 1;
+    /// 1024 entries in table of each level
+    static constexpr size_type table_bits = 10;
+    static constexpr size_type table_size = size_type{1} << table_bits;
+
+    /// translation of page
+    struct page_entry
+    {
+        /// block which covers whole page
+        pointer block = nullptr;
+        /// host address of page for RAM-backed block, nullptr for MMIO
+        std::uint8_t* host = nullptr;
+        /// page is covered partially, lookup by list of blocks
+        bool shared = false;
+    };
 
     template<typename BlockType, typename... Args>
     [[nodiscard]]
@@ -125,11 +199,50 @@ struct memory_management_unit
 
     [[nodiscard]]
     bool add_block(value_type block);
+
+    /// num of bytes backed by host memory in all blocks
+    [[nodiscard]]
+    std::uint64_t get_committed_size() const;
+
+    /// no blocks are added
+    [[nodiscard]]
+    bool is_empty() const noexcept
+    {
+        return memory.empty();
+    }
+
+    /// region does not overlap any block
+    [[nodiscard]]
+    bool is_free(const key_type& region) const;
+
     [[nodiscard]]
     pointer find_block(memory_block::address_type address, memory_block::size_type size) const;
 
+    /// get translation of page
+    /// @return nullptr if page is not mapped
+    [[nodiscard]]
+    const page_entry* find_page(address_type address) const noexcept
+    {
+        const auto& table = directory[address >> (page_bits + table_bits)];
+        if (!table) [[unlikely]]
+        {
+            return nullptr;
+        }
+        return &(*table)[(address >> page_bits) & (table_size - 1)];
+    }
+
 private:
+    using page_table = std::array<page_entry, table_size>;
+
+    /// add pages of block into page table
+    void map_pages(pointer block);
+
+    /// find block by list of blocks
+    [[nodiscard]]
+    pointer scan(memory_block::address_type address, memory_block::size_type size) const;
+
     memory_blocks memory;
+    std::array<std::unique_ptr<page_table>, table_size> directory;
 };
 
 struct generic_memory: public memory_block
@@ -140,6 +253,9 @@ struct generic_memory: public memory_block
 
     bool store(memory_block::address_type address, const void *source, memory_block::size_type size) override;
 
+    [[nodiscard]]
+    std::uint8_t * get_host_memory() override;
+
 protected:
     [[nodiscard]]
     const void * get_ro(address_type address, size_type size) const override;
@@ -151,4 +267,145 @@ private:
     storage_type data;
 };
 
+/**
+ * RAM block in contiguous host memory
+ *
+ * memory is allocated or reserved by subclass
+ */
+struct host_memory_block: public memory_block
+{
+    bool load(address_type address, void *dest, size_type size) const override;
+
+    bool store(address_type address, const void *source, size_type size) override;
+
+    [[nodiscard]]
+    std::uint8_t * get_host_memory() override;
+
+    /// num of bytes in pages written by VM
+    [[nodiscard]]
+    std::uint64_t get_committed_size() const override;
+
+    /// image should start at host page boundary
+    [[nodiscard]]
+    bool map_image(address_type address, const program_image& image) override;
+
+protected:
+    /// @param data first byte of block, owned by subclass
+    host_memory_block(address_type address, size_type size, std::uint8_t* data = nullptr);
+
+    [[nodiscard]]
+    const void * get_ro(address_type address, size_type size) const override;
+    [[nodiscard]]
+    void * get_rw(address_type address, size_type size) override;
+
+    std::uint8_t* data;
+};
+
+/**
+ * RAM block with pages committed on demand
+ *
+ * host memory is reserved without commit, host commits page on first write,
+ * untouched pages are read as zero
+ */
+struct sparse_memory: public host_memory_block
+{
+    sparse_memory(address_type address, size_type size);
+    ~sparse_memory() override;
+
+    sparse_memory(const sparse_memory&) = delete;
+    sparse_memory& operator=(const sparse_memory&) = delete;
+};
+
+/**
+ * get num of bytes of host region in private pages of process
+ *
+ * pages which were only read, shared with other mappings or backed by file are not counted,
+ * on hosts without page map resident pages are counted
+ * @return size of region if residency is unknown on host
+ */
+[[nodiscard]]
+std::uint64_t get_private_size(const void* host, std::uint64_t size);
+
+/**
+ * commit host pages of region for write at once instead of fault per page
+ *
+ * does nothing if host can not populate pages
+ */
+void prefault_pages(void* host, std::uint64_t size);
+
+/**
+ * direct-mapped software TLB
+ *
+ * caches host address of RAM-backed pages from page table of MMU,
+ * MMIO pages are never cached
+ */
+struct memory_tlb
+{
+    using address_type = memory_management_unit::address_type;
+    using size_type = memory_management_unit::size_type;
+
+    /// num of entries, power of 2
+    static constexpr size_type entries_count = 64;
+
+    /// lookup counters
+    struct stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    /**
+     * get host address
+     * @param address guest address
+     * @return host address or nullptr on miss
+     */
+    [[nodiscard]]
+    std::uint8_t* find(address_type address) noexcept
+    {
+        const auto page = address >> memory_management_unit::page_bits;
+        const auto& entry = entries[page & (entries_count - 1)];
+        if (entry.tag == page) [[likely]]
+        {
+            ++counters.hits;
+            return entry.host + (address & memory_management_unit::page_mask);
+        }
+        ++counters.misses;
+        return nullptr;
+    }
+
+    /**
+     * cache page
+     * @param address guest address inside of page
+     * @param host host address of page start
+     */
+    void fill(address_type address, std::uint8_t* host) noexcept
+    {
+        const auto page = address >> memory_management_unit::page_bits;
+        entries[page & (entries_count - 1)] = {page, host};
+    }
+
+    /// drop all entries and counters
+    void flush() noexcept
+    {
+        entries.fill({});
+        counters = {};
+    }
+
+    [[nodiscard]]
+    const stats& get_stats() const noexcept
+    {
+        return counters;
+    }
+private:
+    struct entry_type
+    {
+        /// page number, never matches by default
+        address_type tag = ~address_type{0};
+        std::uint8_t* host = nullptr;
+    };
+
+    std::array<entry_type, entries_count> entries{};
+    stats counters{};
+};
+
 }//namespace vm
@@ -0,0 +1,308 @@
+#include "vm_predecode.hxx"
+#include "vm_program_image.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+#include <unordered_map>
+
+namespace vm
+{
+
+decoded_instruction decoded_instruction::decode(const registry &opcodes, opcode::Decoder code)
+{
+    decoded_instruction result;
+    result.handler = opcodes.find_handler(&code);
+    result.code = code;
+    result.rd = code.get_rd();
+    result.rs1 = code.get_rs1();
+    result.rs2 = code.get_rs2();
+    if (result.handler)
+    {
+        result.imm = decode_immediate(result.handler->get_type(), code);
+    }
+    return result;
+}
+
+register_t decoded_instruction::decode_immediate(opcode::BaseFormat format, opcode::Decoder code)
+{
+    switch (format)
+    {
+    case opcode::R_TYPE: return code.decode_i(); // shifts by immediate use I-type field
+    case opcode::I_TYPE: return code.decode_i();
+    case opcode::S_TYPE: return code.decode_s();
+    case opcode::B_TYPE: return code.decode_b();
+    case opcode::U_TYPE: return code.decode_u();
+    case opcode::J_TYPE: return code.decode_j();
+    case opcode::UNKNOWN: break;
+    }
+    return 0;
+}
+
+void predecode_cache::assign(predecode_cache::address_type address, predecode_cache::size_type size)
+{
+    region_start = address;
+    region_size = size;
+    pages.clear();
+    pages.resize((size + page_size - 1) / page_size);
+}
+
+void predecode_cache::clear()
+{
+    for (auto& ptr: pages)
+    {
+        ptr.reset();
+    }
+}
+
+decoded_instruction *predecode_cache::get_slot(predecode_cache::address_type address)
+{
+    if (!contains(address)) [[unlikely]]
+    {
+        return nullptr;
+    }
+    auto offset = address - region_start;
+    auto& ptr = pages[offset / page_size];
+    if (!ptr) [[unlikely]]
+    {
+        ptr = std::make_unique<page>();
+    }
+    return &(*ptr)[(offset % page_size) / sizeof(opcode::opcode_t)];
+}
+
+void predecode_cache::invalidate(predecode_cache::address_type address, predecode_cache::size_type size)
+{
+    if (size == 0) return;
+    auto first = std::max(address, region_start);
+    auto last = std::min<std::uint64_t>(std::uint64_t{address} + size, std::uint64_t{region_start} + region_size);
+    constexpr address_type slot_mask = ~address_type{sizeof(opcode::opcode_t) - 1};
+    for (std::uint64_t slot = region_start + ((first - region_start) & slot_mask); slot < last; slot += sizeof(opcode::opcode_t))
+    {
+        auto offset = static_cast<address_type>(slot - region_start);
+        auto& ptr = pages[offset / page_size];
+        if (ptr)
+        {
+            (*ptr)[(offset % page_size) / sizeof(opcode::opcode_t)] = decoded_instruction{};
+        }
+    }
+}
+
+namespace
+{
+
+/// header of cache file
+struct file_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t key;
+    std::uint64_t fingerprint;
+    /// region
+    std::uint32_t address;
+    std::uint32_t size;
+    /// num of handlers in registry
+    std::uint32_t handlers;
+    std::uint32_t reserved;
+};
+
+/// slot of region, one per instruction
+struct file_record
+{
+    std::uint32_t code;
+    /// index of handler in dispatch order + 1, 0 for empty slot
+    std::uint16_t handler;
+    std::uint16_t reserved;
+};
+
+static_assert(sizeof(file_header) == 48);
+static_assert(sizeof(file_record) == 8);
+
+constexpr char file_magic[8] = {'Y', 'E', 'T', 'I', 'P', 'D', 'C', 0};
+constexpr std::uint32_t file_version = 2;
+constexpr std::uint64_t hash_prime = 0x100000001b3ull;
+constexpr auto slot_size = sizeof(opcode::opcode_t);
+
+template<typename T>
+std::uint64_t hash_value(T value, std::uint64_t seed)
+{
+    std::uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    return predecode_file::hash(bytes, seed);
+}
+
+/// handlers in dispatch order
+std::vector<registry::handler_ptr> list_handlers(const registry& opcodes)
+{
+    std::vector<registry::handler_ptr> list;
+    list.reserve(opcodes.handlers.size());
+    for (const auto& [id, handler]: opcodes.handlers)
+    {
+        list.push_back(handler.get());
+    }
+    return list;
+}
+
+} // namespace
+
+std::uint64_t predecode_file::hash(std::span<const std::uint8_t> data, std::uint64_t seed)
+{
+    // 8 bytes per step, tail by bytes
+    size_t pos = 0;
+    for (; pos + sizeof(std::uint64_t) <= data.size(); pos += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data.data() + pos, sizeof(word));
+        seed = (seed ^ word) * hash_prime;
+    }
+    for (; pos < data.size(); ++pos)
+    {
+        seed = (seed ^ data[pos]) * hash_prime;
+    }
+    return seed;
+}
+
+std::uint64_t predecode_file::get_fingerprint(const registry &opcodes)
+{
+    auto result = hash_value(file_version, hash_basis);
+    for (const auto& [id, handler]: opcodes.handlers)
+    {
+        const auto mnemonic = handler->get_mnemonic();
+        result = hash({reinterpret_cast<const std::uint8_t*>(mnemonic.data()), mnemonic.size()}, result);
+        result = hash_value(handler->get_code_base(), result);
+        result = hash_value(handler->get_func_a(), result);
+        result = hash_value(handler->get_func_b(), result);
+        result = hash_value(handler->get_type(), result);
+    }
+    return result;
+}
+
+std::uint64_t predecode_file::get_key(const registry &opcodes, address_type address, std::span<const std::uint8_t> code)
+{
+    auto result = hash_value(get_fingerprint(opcodes), hash_basis);
+    result = hash_value(address, result);
+    return hash(code, result);
+}
+
+std::filesystem::path predecode_file::get_path(const std::filesystem::path &directory, std::uint64_t key)
+{
+    return directory / std::format("{:016x}.ydc", key);
+}
+
+bool predecode_file::save(const std::filesystem::path &file, std::uint64_t key, const registry &opcodes,
+                          predecode_cache &cache, address_type address, size_type size)
+{
+    const auto list = list_handlers(opcodes);
+    std::unordered_map<registry::handler_ptr, std::uint16_t> index;
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        index[list[i]] = static_cast<std::uint16_t>(i + 1);
+    }
+
+    file_header header{};
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.record_size = sizeof(file_record);
+    header.key = key;
+    header.fingerprint = get_fingerprint(opcodes);
+    header.address = address;
+    header.size = size;
+    header.handlers = static_cast<std::uint32_t>(list.size());
+
+    std::vector<file_record> records(size / slot_size);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const auto* slot = cache.get_slot(static_cast<address_type>(address + i * slot_size));
+        if (!slot || !slot->is_valid() || slot->size != 1) continue;
+        auto& record = records[i];
+        record.code = slot->code.code;
+        record.handler = index[slot->handler];
+    }
+
+    // write to unique temporary file, then replace
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+    auto temp = file;
+    temp += std::format(".{:08x}.tmp", std::random_device{}());
+    {
+        std::ofstream output{temp, std::ios::binary | std::ios::trunc};
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(records.data()),
+                     static_cast<std::streamsize>(records.size() * sizeof(file_record)));
+        if (!output.good())
+        {
+            output.close();
+            std::filesystem::remove(temp, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, file, error);
+    if (error)
+    {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+bool predecode_file::load(const std::filesystem::path &file, std::uint64_t key, const registry &opcodes,
+                          predecode_cache &cache, address_type address, std::span<const std::uint8_t> code,
+                          const bind_fn &bind)
+{
+    const auto image = program_image::open(file);
+    if (!image) return false;
+    const auto data = image->get_data();
+
+    const auto list = list_handlers(opcodes);
+    const auto count = code.size() / slot_size;
+    file_header header{};
+    if (data.size() != sizeof(header) + count * sizeof(file_record)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0
+        || header.version != file_version || header.record_size != sizeof(file_record)
+        || header.key != key || header.fingerprint != get_fingerprint(opcodes)
+        || header.address != address || header.size != code.size() || header.handlers != list.size())
+        return false;
+
+    // records are read from mapped file, all of them are checked before cache is touched
+    const auto* records = data.data() + sizeof(header);
+    auto read_record = [records](size_t i) {
+        file_record record;
+        std::memcpy(&record, records + i * sizeof(file_record), sizeof(record));
+        return record;
+    };
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto record = read_record(i);
+        if (record.handler == 0) continue;
+        opcode::Decoder actual;
+        std::memcpy(&actual.code, code.data() + i * slot_size, slot_size);
+        if (record.code != actual.code || record.handler > list.size()) return false;
+        // handler is the one dispatch would select for this code
+        if (list[record.handler - 1] != opcodes.find_handler(&actual)) return false;
+    }
+
+    std::vector<decoded_instruction::exec_fn> exec(list.size());
+    std::transform(list.begin(), list.end(), exec.begin(), bind);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto record = read_record(i);
+        if (record.handler == 0) continue;
+        auto* slot = cache.get_slot(static_cast<address_type>(address + i * slot_size));
+        if (!slot) return false;
+        *slot = decoded_instruction{};
+        slot->handler = list[record.handler - 1];
+        slot->exec = exec[record.handler - 1];
+        // operands are taken by handlers as is: derived from verified code
+        slot->code = opcode::Decoder{record.code};
+        slot->imm = decoded_instruction::decode_immediate(slot->handler->get_type(), slot->code);
+        slot->rd = slot->code.get_rd();
+        slot->rs1 = slot->code.get_rs1();
+        slot->rs2 = slot->code.get_rs2();
+    }
+    return true;
+}
+
+} // namespace vm
@@ -0,0 +1,202 @@
+/// cache of predecoded instructions
+#pragma once
+
+#include "vm_base_types.hxx"
+#include "vm_opcode.hxx"
+#include "vm_handler.hxx"
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+
+namespace vm
+{
+
+/**
+ * predecoded instruction
+ */
+struct decoded_instruction
+{
+    /// handler body instantiated for concrete VM type
+    using exec_fn = void (*)(vm_interface* vm, const decoded_instruction& op);
+
+    /// resolved handler, nullptr for empty slot
+    const interface* handler = nullptr;
+    /// bound by VM, nullptr if handler->exec() should be used
+    exec_fn exec = nullptr;
+    /// instruction code
+    opcode::Decoder code{0};
+    /// sign extended immediate, depends on encoding format
+    register_t imm = 0;
+    /// rd(dest) register ID
+    register_no rd = 0;
+    /// rs1(lhs) register ID
+    register_no rs1 = 0;
+    /// rs2(rhs) register ID
+    register_no rs2 = 0;
+    /// second dest register ID of fused pair
+    register_no rd2 = 0;
+    /// num of instructions covered, 2 for fused pair
+    std::uint8_t size = 1;
+    /// second immediate of fused pair
+    register_t imm2 = 0;
+
+    /// check that slot is filled
+    [[nodiscard]]
+    bool is_valid() const noexcept
+    {
+        return handler != nullptr;
+    }
+
+    /**
+     * operands in form of opcode::Decoder, handler body reads them without decoding
+     *
+     * immediate is decoded by format of handler, so any decode_x() returns it
+     */
+    [[nodiscard]]
+    register_no get_rd() const noexcept { return rd; }
+    [[nodiscard]]
+    register_no get_rs1() const noexcept { return rs1; }
+    [[nodiscard]]
+    register_no get_rs2() const noexcept { return rs2; }
+    [[nodiscard]]
+    register_t decode_i() const noexcept { return imm; }
+    [[nodiscard]]
+    register_t decode_i_u() const noexcept { return imm; }
+    [[nodiscard]]
+    register_t decode_s() const noexcept { return imm; }
+    [[nodiscard]]
+    register_t decode_b() const noexcept { return imm; }
+    [[nodiscard]]
+    register_t decode_u() const noexcept { return imm; }
+    [[nodiscard]]
+    register_t decode_j() const noexcept { return imm; }
+
+    /**
+     * decode instruction
+     * @param opcodes registry of handlers
+     * @param code instruction code
+     * @return decoded instruction, handler is nullptr if instruction is unknown
+     */
+    [[nodiscard]]
+    static decoded_instruction decode(const registry& opcodes, opcode::Decoder code);
+
+    /// decode immediate by encoding format
+    [[nodiscard]]
+    static register_t decode_immediate(opcode::BaseFormat format, opcode::Decoder code);
+};
+
+/**
+ * cache of predecoded instructions for code region
+ *
+ * slots are allocated by pages and filled lazily on first execution
+ */
+struct predecode_cache
+{
+    using address_type = std::uint32_t;
+    using size_type = std::uint32_t;
+
+    /// size of page in bytes
+    static constexpr size_type page_size = 4096;
+    /// num of slots in page
+    static constexpr size_type page_slots = page_size / sizeof(opcode::opcode_t);
+
+    using page = std::array<decoded_instruction, page_slots>;
+    using page_ptr = std::unique_ptr<page>;
+
+    /// set cached region, drop all slots
+    void assign(address_type address, size_type size);
+
+    /// drop all slots
+    void clear();
+
+    /// address is inside of cached region
+    [[nodiscard]]
+    bool contains(address_type address) const noexcept
+    {
+        return (address - region_start) < region_size;
+    }
+
+    /**
+     * get slot for address
+     * @param address instruction address
+     * @return pointer to slot or nullptr if address outside of region
+     */
+    [[nodiscard]]
+    decoded_instruction* get_slot(address_type address);
+
+    /// invalidate slots in range [address, address + size)
+    void invalidate(address_type address, size_type size);
+
+    /// start of cached region
+    [[nodiscard]]
+    address_type get_start() const noexcept { return region_start; }
+
+    /// size of cached region
+    [[nodiscard]]
+    size_type get_size() const noexcept { return region_size; }
+private:
+    address_type region_start = 0;
+    size_type region_size = 0;
+    std::vector<page_ptr> pages;
+};
+
+/**
+ * predecoded code region stored in file
+ *
+ * file name is key of region: hash of code, its address and registered handlers.
+ * slots keep code and handler index, both are checked on load; operands are decoded again,
+ * exec is resolved by VM once per handler.
+ * stale or broken file is rejected by load() and should be rebuilt by save()
+ */
+struct predecode_file
+{
+    using address_type = predecode_cache::address_type;
+    using size_type = predecode_cache::size_type;
+
+    /// FNV-1a offset basis
+    static constexpr std::uint64_t hash_basis = 0xcbf29ce484222325ull;
+
+    /// FNV-1a hash of data, folds 8 bytes per step
+    [[nodiscard]]
+    static std::uint64_t hash(std::span<const std::uint8_t> data, std::uint64_t seed = hash_basis);
+
+    /// hash of registered handlers in dispatch order, changes with ISA
+    [[nodiscard]]
+    static std::uint64_t get_fingerprint(const registry& opcodes);
+
+    /// key of code region
+    [[nodiscard]]
+    static std::uint64_t get_key(const registry& opcodes, address_type address, std::span<const std::uint8_t> code);
+
+    /// path of cache file for key
+    [[nodiscard]]
+    static std::filesystem::path get_path(const std::filesystem::path& directory, std::uint64_t key);
+
+    /**
+     * write valid slots of region [address, address + size)
+     *
+     * file is replaced atomically, concurrent readers see old or new file
+     * @return false if file can not be written
+     */
+    [[nodiscard]]
+    static bool save(const std::filesystem::path& file, std::uint64_t key, const registry& opcodes,
+                     predecode_cache& cache, address_type address, size_type size);
+
+    /// resolve exec of handler, called once per handler on load
+    using bind_fn = std::function<decoded_instruction::exec_fn(registry::handler_ptr)>;
+
+    /**
+     * fill slots of region from mapped file
+     * @param code content of region starting at address, each slot is checked against it
+     * @param bind resolver of exec for loaded slots
+     * @return false if file is missing, stale or broken, cache is not changed then
+     */
+    [[nodiscard]]
+    static bool load(const std::filesystem::path& file, std::uint64_t key, const registry& opcodes,
+                     predecode_cache& cache, address_type address, std::span<const std::uint8_t> code,
+                     const bind_fn& bind);
+};
+
+} // namespace vm
@@ -0,0 +1,191 @@
+#include "vm_program_image.hxx"
+#include "vm_utility.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#define YETI_SHARED_IMAGE 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vm
+{
+
+#ifdef YETI_SHARED_IMAGE
+
+program_image::~program_image()
+{
+    if (view)
+        munmap(view, mapped_size);
+    if (fd >= 0)
+        close(fd);
+}
+
+size_t program_image::get_page_size()
+{
+    static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+program_image::ptr program_image::create(std::span<const std::uint8_t> bin)
+{
+    const auto page_size = get_page_size();
+    std::shared_ptr<program_image> image{new program_image{}};
+    image->size = bin.size();
+    image->mapped_size = (bin.size() + page_size - 1) & ~(page_size - 1);
+    if (image->mapped_size == 0)
+    {
+        return image;
+    }
+    image->fd = memfd_create("yeti-program", MFD_CLOEXEC);
+    if (image->fd < 0 || ftruncate(image->fd, static_cast<off_t>(image->mapped_size)) != 0)
+    {
+        return nullptr;
+    }
+    void* host = mmap(nullptr, image->mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, image->fd, 0);
+    if (host == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    std::memcpy(host, bin.data(), bin.size());
+    // image is immutable after creation
+    if (mprotect(host, image->mapped_size, PROT_READ) != 0)
+    {
+        munmap(host, image->mapped_size);
+        return nullptr;
+    }
+    image->view = static_cast<std::uint8_t*>(host);
+    return image;
+}
+
+program_image::ptr program_image::open(const std::filesystem::path &file)
+{
+    const auto page_size = get_page_size();
+    std::shared_ptr<program_image> image{new program_image{}};
+    image->fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info{};
+    if (image->fd < 0 || fstat(image->fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        return nullptr;
+    }
+    image->size = static_cast<size_t>(info.st_size);
+    image->mapped_size = (image->size + page_size - 1) & ~(page_size - 1);
+    if (image->mapped_size == 0)
+    {
+        return image;
+    }
+    // tail of last page after end of file is read as zeros
+    void* host = mmap(nullptr, image->mapped_size, PROT_READ, MAP_SHARED, image->fd, 0);
+    if (host == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    image->view = static_cast<std::uint8_t*>(host);
+    return image;
+}
+
+program_image::ptr program_image::get_slice(size_t from, size_t length) const
+{
+    if (from > size || length > size - from)
+    {
+        return nullptr;
+    }
+    const auto page_size = get_page_size();
+    if (fd < 0 || from % page_size != 0)
+    {
+        return create(get_data().subspan(from, length));
+    }
+    std::shared_ptr<program_image> image{new program_image{}};
+    image->size = length;
+    image->mapped_size = (length + page_size - 1) & ~(page_size - 1);
+    image->offset = offset + from;
+    if (image->mapped_size == 0)
+    {
+        return image;
+    }
+    image->fd = dup(fd);
+    if (image->fd < 0)
+    {
+        return nullptr;
+    }
+    void* host = mmap(nullptr, image->mapped_size, PROT_READ, MAP_SHARED, image->fd, static_cast<off_t>(image->offset));
+    if (host == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    image->view = static_cast<std::uint8_t*>(host);
+    return image;
+}
+
+bool program_image::map(void *host) const
+{
+    if (mapped_size == 0)
+    {
+        return true;
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+    void* result = mmap(host, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, static_cast<off_t>(offset));
+    if (result == MAP_FAILED)
+    {
+        return false;
+    }
+    // slice of file: last page continues with data after image
+    if (std::any_of(view + size, view + mapped_size, [](auto value) { return value != 0; }))
+    {
+        std::memset(static_cast<std::uint8_t*>(host) + size, 0, mapped_size - size);
+    }
+    return true;
+}
+
+#else // image is not shared on host
+
+program_image::~program_image()
+{
+    delete[] view;
+}
+
+program_image::ptr program_image::create(std::span<const std::uint8_t> bin)
+{
+    std::shared_ptr<program_image> image{new program_image{}};
+    image->size = bin.size();
+    image->mapped_size = bin.size();
+    image->view = new std::uint8_t[bin.size()];
+    std::memcpy(image->view, bin.data(), bin.size());
+    return image;
+}
+
+program_image::ptr program_image::open(const std::filesystem::path &file)
+{
+    auto bin = load_program(file);
+    return bin ? create(bin.value()) : nullptr;
+}
+
+program_image::ptr program_image::get_slice(size_t from, size_t length) const
+{
+    if (from > size || length > size - from)
+    {
+        return nullptr;
+    }
+    return create(get_data().subspan(from, length));
+}
+
+size_t program_image::get_page_size()
+{
+    return 1;
+}
+
+bool program_image::map(void*) const
+{
+    return false;
+}
+
+#endif // YETI_SHARED_IMAGE
+
+} // namespace vm
@@ -0,0 +1,103 @@
+/// program image shared by many VM instances
+#pragma once
+
+#include "vm_base_types.hxx"
+
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace vm
+{
+
+/**
+ * immutable program image
+ *
+ * image is loaded once and mapped into memory of each VM,
+ * pages are shared until VM writes them(copy-on-write)
+ */
+struct program_image
+{
+    using ptr = std::shared_ptr<const program_image>;
+
+    program_image(const program_image&) = delete;
+    program_image& operator=(const program_image&) = delete;
+    ~program_image();
+
+    /**
+     * create image from binary
+     * @return nullptr if memory can not be allocated
+     */
+    [[nodiscard]]
+    static ptr create(std::span<const std::uint8_t> bin);
+
+    /**
+     * map binary file without copying
+     *
+     * pages of image are pages of file in host page cache,
+     * so they are shared by all processes which run same file.
+     * file should not be truncated while image is in use
+     * @return nullptr if file can not be opened or mapped
+     */
+    [[nodiscard]]
+    static ptr open(const std::filesystem::path& file);
+
+    /**
+     * part of image, e.g. segment of executable file
+     *
+     * slice at offset aligned by host page shares pages with this image,
+     * other slices are copied
+     * @return nullptr if range is out of image or memory can not be allocated
+     */
+    [[nodiscard]]
+    ptr get_slice(size_t offset, size_t length) const;
+
+    /// content of image
+    [[nodiscard]]
+    std::span<const std::uint8_t> get_data() const noexcept
+    {
+        return {view, size};
+    }
+
+    /// size of image in bytes
+    [[nodiscard]]
+    size_t get_size() const noexcept
+    {
+        return size;
+    }
+
+    /// granularity of mapping on host
+    [[nodiscard]]
+    static size_t get_page_size();
+
+    /// size of mapping: size of image rounded up to host page
+    [[nodiscard]]
+    size_t get_mapped_size() const noexcept
+    {
+        return mapped_size;
+    }
+
+    /**
+     * map private copy of image
+     *
+     * replaces host pages at destination, tail of last page is zeroed
+     * @param host destination aligned by host page,
+     *      should be owned by anonymous mapping of size get_mapped_size() at least
+     * @return false if image can not be mapped
+     */
+    [[nodiscard]]
+    bool map(void* host) const;
+private:
+    program_image() = default;
+
+    /// read only view of image
+    std::uint8_t* view = nullptr;
+    size_t size = 0;
+    size_t mapped_size = 0;
+    /// memfd or mapped binary file, -1 if image is not backed by file
+    int fd = -1;
+    /// offset of image in file
+    std::uint64_t offset = 0;
+};
+
+} // namespace vm
@@ -5,10 +5,36 @@ namespace vm
 {
 syscall_interface::~syscall_interface() = default;
 
+namespace
+{
+
+/// call of handler without plain function
+void call_interface(vm_interface* vm, void* handler)
+{
+    static_cast<syscall_interface*>(handler)->exec(vm);
+}
+
+} // namespace
+
 bool syscall_registry::register_handler(syscall_interface::ptr handler)
 {
     auto [it, ok] = handlers.try_emplace(handler->get_id(), handler);
     ensure(ok, it->second->get_name());
+
+    entry call{call_interface, handler.get()};
+    if (auto* function = dynamic_cast<syscall_function*>(handler.get()))
+    {
+        call = {function->get_function(), function->get_context()};
+    }
+    const auto id = handler->get_id();
+    if (id < table_size)
+    {
+        table[id] = call;
+    }
+    else
+    {
+        sparse[id] = call;
+    }
     return ok;
 }
 
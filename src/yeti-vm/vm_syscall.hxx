@@ -1,7 +1,11 @@
 #pragma once
 
 #include "vm_interface.hxx"
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <initializer_list>
+#include <unordered_map>
 
 namespace vm
 {
@@ -57,6 +61,68 @@ private:
     register_t id;
 };
 
+/**
+ * syscall bound to plain function and context
+ *
+ * cheaper than syscall_functor: no std::function in call path
+ */
+struct syscall_function final: public syscall_interface
+{
+    using function_type = void (*)(vm_interface* vm, void* context);
+
+    syscall_function(register_t id, std::string name, function_type function, void* context = nullptr)
+        : function{function}
+        , context{context}
+        , name{std::move(name)}
+        , id{id}
+    {}
+
+    static ptr create(register_t id, std::string name, function_type function, void* context = nullptr)
+    {
+        return std::make_shared<syscall_function>(id, std::move(name), function, context);
+    }
+
+    void exec(vm_interface* vm) final
+    {
+        function(vm, context);
+    }
+
+    [[nodiscard]]
+    register_t get_id() const final
+    {
+        return id;
+    }
+
+    [[nodiscard]]
+    std::string_view get_name() const final
+    {
+        return name;
+    }
+
+    [[nodiscard]]
+    function_type get_function() const noexcept
+    {
+        return function;
+    }
+
+    [[nodiscard]]
+    void* get_context() const noexcept
+    {
+        return context;
+    }
+private:
+    function_type function;
+    void* context;
+    std::string name;
+    register_t id;
+};
+
+/**
+ * registered syscalls
+ *
+ * calls are dispatched by flat table for common IDs(below table_size),
+ * large IDs(e.g. 1024 "open") are looked up in sparse map
+ */
 struct syscall_registry
 {
     using interface = syscall_interface;
@@ -65,6 +131,21 @@ struct syscall_registry
     using syscall_id = register_t;
     using handler_map = std::map<key_type, interface::ptr>;
 
+    /// resolved call: function and its context
+    struct entry
+    {
+        syscall_function::function_type function = nullptr;
+        void* context = nullptr;
+
+        void operator()(vm_interface* vm) const
+        {
+            function(vm, context);
+        }
+    };
+
+    /// num of IDs dispatched by flat table
+    static constexpr size_t table_size = 256;
+
     /**
      * register handler by type
      * @tparam Handler
@@ -78,12 +159,45 @@ struct syscall_registry
     /// register handler by pointer
     bool register_handler(interface::ptr handler);
 
+    /// register plain function, it is called with context
+    bool register_handler(syscall_id id, std::string name, syscall_function::function_type function, void* context = nullptr)
+    {
+        return register_handler(syscall_function::create(id, std::move(name), function, context));
+    }
+
     /// find handler by ID
     [[nodiscard]]
     handler_ptr find_handler(syscall_id id) const;
+    /// find call by ID
+    /// @return nullptr if syscall is not registered
+    [[nodiscard]]
+    const entry* find_entry(syscall_id id) const
+    {
+        if (id < table_size) [[likely]]
+        {
+            const auto& call = table[id];
+            return call.function ? &call : nullptr;
+        }
+        auto it = sparse.find(id);
+        return it != sparse.end() ? &it->second : nullptr;
+    }
+
+    /// none of IDs is registered, register_handler throws on used ID
+    [[nodiscard]]
+    bool is_free(std::initializer_list<syscall_id> ids) const
+    {
+        return std::none_of(ids.begin(), ids.end(), [this](auto id) { return find_entry(id) != nullptr; });
+    }
+
     /// get syscall handler ID
     syscall_id get_syscall_id(const vm_interface* vm) const;
 
+    /// handlers container, owns handlers of table
     handler_map handlers;
+private:
+    /// flat table of common IDs
+    std::array<entry, table_size> table{};
+    /// IDs out of table
+    std::unordered_map<syscall_id, entry> sparse;
 };
 } // namespace vm
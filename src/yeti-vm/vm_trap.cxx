@@ -0,0 +1,54 @@
+#include "vm_trap.hxx"
+
+#include <format>
+
+namespace vm
+{
+
+std::string_view get_name(trap_cause cause)
+{
+    switch (cause)
+    {
+        case trap_cause::none:                return "none";
+        case trap_cause::fetch_error:         return "fetch_error";
+        case trap_cause::illegal_instruction: return "illegal_instruction";
+        case trap_cause::misaligned_jump:     return "misaligned_jump";
+        case trap_cause::code_access:         return "code_access";
+        case trap_cause::misaligned_load:     return "misaligned_load";
+        case trap_cause::load_access:         return "load_access";
+        case trap_cause::misaligned_store:    return "misaligned_store";
+        case trap_cause::store_access:        return "store_access";
+        case trap_cause::unknown_syscall:     return "unknown_syscall";
+    }
+    return "unknown";
+}
+
+std::string trap::get_message() const
+{
+    switch (cause)
+    {
+    case trap_cause::none:
+        return "no trap";
+    case trap_cause::fetch_error:
+        return std::format("unable fetch instruction from {:08x}", address);
+    case trap_cause::illegal_instruction:
+        return std::format("unable find handler for {:08x} at {:08x}", address, pc);
+    case trap_cause::misaligned_jump:
+        return std::format("destination address({:08x}) should be aligned by instruction size", address);
+    case trap_cause::code_access:
+        return std::format("destination address {:08x} outside code region", address);
+    case trap_cause::misaligned_load:
+        return std::format("load: address {:08x} is not aligned", address);
+    case trap_cause::load_access:
+        return std::format("load: address {:08x} out of range", address);
+    case trap_cause::misaligned_store:
+        return std::format("store: address {:08x} is not aligned", address);
+    case trap_cause::store_access:
+        return std::format("store: address {:08x} out of range", address);
+    case trap_cause::unknown_syscall:
+        return std::format("unknown syscall #{:08x}", address);
+    }
+    return std::format("unknown trap #{}", static_cast<unsigned>(cause));
+}
+
+} // namespace vm
@@ -0,0 +1,67 @@
+/// traps: faults of guest code reported without exceptions
+#pragma once
+
+#include "vm_base_types.hxx"
+
+#include <string>
+#include <string_view>
+
+namespace vm
+{
+
+/// cause of trap
+enum class trap_cause: std::uint8_t
+{
+    /// no trap
+    none,
+    /// unable fetch instruction, address - PC
+    fetch_error,
+    /// no handler for instruction, address - instruction code
+    illegal_instruction,
+    /// jump target is not aligned, address - target
+    misaligned_jump,
+    /// jump target outside of code region, address - target
+    code_access,
+    /// load address is not aligned
+    misaligned_load,
+    /// load address out of range or read error
+    load_access,
+    /// store address is not aligned
+    misaligned_store,
+    /// store address out of range or write error
+    store_access,
+    /// no handler for syscall, address - syscall ID
+    unknown_syscall,
+};
+
+/// name of trap cause
+[[nodiscard]]
+std::string_view get_name(trap_cause cause);
+
+/**
+ * compact description of trap
+ *
+ * message is formatted only on request
+ */
+struct trap
+{
+    /// cause of trap
+    trap_cause cause = trap_cause::none;
+    /// faulting address, meaning depends on cause
+    register_t address = 0;
+    /// address of faulting instruction
+    register_t pc = 0;
+
+    /// trap is set
+    [[nodiscard]]
+    explicit operator bool() const noexcept
+    {
+        return cause != trap_cause::none;
+    }
+
+    /// human-readable description
+    [[nodiscard]]
+    std::string get_message() const;
+};
+
+} // namespace vm
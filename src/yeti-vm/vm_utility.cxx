@@ -45,36 +45,122 @@ std::optional<hex_file> parse_hex(std::istream &stream)
 {
     hex_file result;
 
-    std::string tmp;
+    bool ok = parse_hex(stream, [&result](const hex_record_view& record) {
+        result.append(record);
+        return true;
+    });
+    if (!ok)
+    {
+        return std::nullopt;
+    }
+    return result;
+}
+
+namespace
+{
+
+/// result of parsing of complete lines
+enum class parse_status
+{
+    more,
+    finished,
+    failed,
+};
 
-    while (std::getline(stream, tmp))
+/// parse complete lines of hex text
+parse_status parse_lines(std::string_view text, const hex_sink& sink)
+{
+    // ':'<count><address><type><checksum>
+    constexpr size_t min_record_size = 1 + (1 + 2 + 1 + 1) * 2;
+    // count, address, type, data, checksum
+    std::array<uint8_t, 1 + 2 + 1 + 255 + 1> bytes{};
+
+    while (!text.empty())
     {
-        std::string_view line = tmp;
-        constexpr size_t min_record_size = 1 + (1 + 2 + 1 + 1) * 2; // ':'<count><address><type><checksum>
-        size_t record_size = min_record_size;
+        auto eol = text.find('\n');
+        auto line = text.substr(0, eol);
+        text = eol < text.size() ? text.substr(eol + 1) : std::string_view{};
+
         auto pos = line.find(':');
         if (pos > line.size())
         {
             continue;
         }
-        if (record_size > line.size())
+        if (min_record_size > line.size())
         {
-            return std::nullopt;
+            return parse_status::failed;
         }
         line = line.substr(pos);
-        record_size += (from_hex(line[1]) << 4u) | from_hex(line[2]);
-
+        const auto count = static_cast<uint8_t>((from_hex(line[1]) << 4u) | from_hex(line[2]));
+        const size_t record_size = min_record_size + count * 2;
         if (record_size > line.size())
         {
-            return std::nullopt;
+            return parse_status::failed;
+        }
+        // Note: ignore garbage at eol
+        const size_t size = record_size / 2;
+        if (!from_hex(line.substr(1, record_size - 1), bytes.data()))
+        {
+            return parse_status::failed;
         }
-        auto& record = result.emplace_back();
-        record = parse_hex_record(line.substr(1)); // Note: ignore garbage at eol
 
-        if (record.is_eof()) // skip data after EOF record
-            break;
+        hex_record_view record{};
+        record.count = bytes[0];
+        record.offset = (bytes[1] << 8u) | bytes[2];
+        record.type = bytes[3];
+        record.data = std::span{bytes}.subspan(4, count);
+        record.sum_expected = bytes[size - 1];
+        record.sum_actual = hex_checksum(bytes.data(), bytes.data() + size - 1);
+
+        if (!sink(record))
+        {
+            return parse_status::failed;
+        }
+        if (record.type == hex_record::HEX_EOF) // skip data after EOF record
+        {
+            return parse_status::finished;
+        }
     }
-    return result;
+    return parse_status::more;
+}
+
+} // namespace
+
+bool parse_hex(std::string_view text, const hex_sink &sink)
+{
+    return parse_lines(text, sink) != parse_status::failed;
+}
+
+bool parse_hex(std::istream &stream, const hex_sink &sink)
+{
+    constexpr size_t chunk_size = 64 * 1024;
+    std::string buffer;
+    size_t used = 0;
+
+    while (stream)
+    {
+        buffer.resize(used + chunk_size);
+        stream.read(buffer.data() + used, chunk_size);
+        used += static_cast<size_t>(stream.gcount());
+
+        // only complete lines are parsed, tail is kept for next chunk
+        const std::string_view text{buffer.data(), used};
+        const auto last = text.rfind('\n');
+        if (stream && last == std::string_view::npos)
+        {
+            continue;
+        }
+        const size_t complete = stream ? last + 1 : used;
+        switch (parse_lines(text.substr(0, complete), sink))
+        {
+        case parse_status::finished: return true;
+        case parse_status::failed: return false;
+        case parse_status::more: break;
+        }
+        buffer.erase(0, complete);
+        used -= complete;
+    }
+    return true;
 }
 
 hex_record parse_hex_record(std::string_view line)
@@ -139,6 +225,82 @@ std::vector<uint8_t> from_hex(std::string_view hex)
     return result;
 }
 
+namespace
+{
+
+constexpr std::uint64_t repeat(std::uint8_t byte)
+{
+    return 0x0101010101010101ull * byte;
+}
+
+/// high bit is set in each non zero byte
+constexpr std::uint64_t nonzero_bytes(std::uint64_t value)
+{
+    constexpr auto low = repeat(0x7f);
+    return (((value & low) + low) | value) & repeat(0x80);
+}
+
+/**
+ * decode 8 hex digits into 4 bytes(SWAR)
+ * @return false if any char is not hex digit
+ */
+bool from_hex8(const char* hex, uint8_t* dest)
+{
+    std::uint64_t chars;
+    std::memcpy(&chars, hex, sizeof(chars));
+    // value of digit: low nibble, letters have bit 6 set and value + 9
+    const auto letters = (chars >> 6u) & repeat(1);
+    const auto values = (chars & repeat(0x0f)) + letters * 9;
+    // char is digit if it is same as value encoded back in one of cases
+    const auto above_9 = ((values + repeat(0x76)) >> 7u) & repeat(1);
+    const auto lower = values + repeat('0') + above_9 * ('a' - '0' - 10);
+    const auto upper = values + repeat('0') + above_9 * ('A' - '0' - 10);
+    const auto invalid = ((values + repeat(0x70)) & repeat(0x80))
+            | (nonzero_bytes(chars ^ lower) & nonzero_bytes(chars ^ upper));
+    if (invalid != 0) [[unlikely]]
+    {
+        return false;
+    }
+    // first digit of pair is high nibble
+    auto packed = ((values << 4u) | (values >> 8u)) & 0x00ff00ff00ff00ffull;
+    packed = (packed | (packed >> 8u)) & 0x0000ffff0000ffffull;
+    const auto bytes = static_cast<std::uint32_t>(packed | (packed >> 16u));
+    std::memcpy(dest, &bytes, sizeof(bytes));
+    return true;
+}
+
+} // namespace
+
+bool from_hex(std::string_view hex, uint8_t *dest)
+{
+    const char* ptr = hex.data();
+    size_t size = hex.size() / 2;
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        for (; size >= 4; size -= 4)
+        {
+            if (!from_hex8(ptr, dest)) [[unlikely]]
+            {
+                return false;
+            }
+            ptr += 8;
+            dest += 4;
+        }
+    }
+    for (; size > 0; --size)
+    {
+        auto hi = from_hex(ptr[0]);
+        auto lo = from_hex(ptr[1]);
+        if ((hi | lo) > 0x0f) [[unlikely]]
+        {
+            return false;
+        }
+        *dest++ = (hi << 4u) | lo;
+        ptr += 2;
+    }
+    return true;
+}
+
 uint8_t hex_checksum(const uint8_t* first, const uint8_t* last)
 {
     uint8_t sum = 0;
@@ -153,51 +315,65 @@ uint8_t hex_checksum(const uint8_t* first, const uint8_t* last)
     return 1 + sum;
 }
 
-hex_record::record_type hex_record::get_type() const
+void hex_file::append(const hex_record_view &record)
 {
-    if (type < record_type::HEX_UNKNOWN)
+    auto& entry = records.emplace_back();
+    entry.address = extend + record.offset;
+    entry.data_offset = static_cast<uint32_t>(payload.size());
+    entry.offset = record.offset;
+    entry.count = static_cast<uint8_t>(record.data.size());
+    entry.type = record.type;
+    entry.sum_expected = record.sum_expected;
+    // count is size of stored data, so broken record is kept invalid by checksum
+    entry.sum_actual = record.is_valid() ? record.sum_actual : static_cast<uint8_t>(~record.sum_expected);
+    payload.insert(payload.end(), record.data.begin(), record.data.end());
+
+    if (record.get_type() == hex_record::HEX_SEGMENT_EXTEND || record.get_type() == hex_record::HEX_LINEAR_EXTEND)
     {
-        return static_cast<record_type>(type);
+        extend = record.get_extend();
     }
-    return hex_record::HEX_UNKNOWN;
 }
 
-bool hex_record::is_valid() const
+hex_record_view hex_record::get_view() const
 {
-    return (sum_actual == sum_expected) && (count == data.size());
+    return {count, type, sum_expected, sum_actual, offset, data};
 }
 
-std::string_view hex_record::get_type_name() const
+hex_record::record_type hex_record_view::get_type() const
 {
-    switch (get_type())
+    if (type < hex_record::HEX_UNKNOWN)
     {
-        case HEX_DATA: return "HEX_DATA";
-        case HEX_EOF: return "HEX_EOF";
-        case HEX_SEGMENT_EXTEND: return "HEX_SEGMENT_EXTEND";
-        case HEX_SEGMENT_START: return "HEX_SEGMENT_START";
-        case HEX_LINEAR_EXTEND: return "HEX_LINEAR_EXTEND";
-        case HEX_LINEAR_START: return "HEX_LINEAR_START";
-        case HEX_UNKNOWN: return "HEX_UNKNOWN";
+        return static_cast<hex_record::record_type>(type);
     }
-    return "IMPOSSIBLE";
+    return hex_record::HEX_UNKNOWN;
 }
 
-uint32_t hex_record::get_extend() const
+hex_record::record_type hex_record::get_type() const
+{
+    return get_view().get_type();
+}
+
+bool hex_record_view::is_valid() const
+{
+    return (sum_actual == sum_expected) && (count == data.size());
+}
+
+uint32_t hex_record_view::get_extend() const
 {
     if (data.size() == 2) [[likely]]
     {
         uint32_t value = ((data[0] << 8u) | (data[1] << 0u));
-        if (is_extend_segment()) return value <<  4u;
-        if (is_extend_linear() ) return value << 16u;
+        if (type == hex_record::HEX_SEGMENT_EXTEND) return value <<  4u;
+        if (type == hex_record::HEX_LINEAR_EXTEND ) return value << 16u;
     }
     return 0;
 }
 
-uint32_t hex_record::get_start() const
+uint32_t hex_record_view::get_start() const
 {
     if (data.size() == 4) [[likely]]
     {
-        if (is_start_linear() | is_start_segment()) [[likely]]
+        if (type == hex_record::HEX_LINEAR_START || type == hex_record::HEX_SEGMENT_START) [[likely]]
         {
             uint32_t value =  ((data[0] << 24u) | (data[1] << 16u) | (data[2] << 8u) | (data[3] << 0u));
             return value;
@@ -206,6 +382,42 @@ uint32_t hex_record::get_start() const
     return 0;
 }
 
+bool hex_record::is_valid() const
+{
+    return get_view().is_valid();
+}
+
+std::string_view hex_record_view::get_type_name() const
+{
+    using enum hex_record::record_type;
+    switch (get_type())
+    {
+        case HEX_DATA: return "HEX_DATA";
+        case HEX_EOF: return "HEX_EOF";
+        case HEX_SEGMENT_EXTEND: return "HEX_SEGMENT_EXTEND";
+        case HEX_SEGMENT_START: return "HEX_SEGMENT_START";
+        case HEX_LINEAR_EXTEND: return "HEX_LINEAR_EXTEND";
+        case HEX_LINEAR_START: return "HEX_LINEAR_START";
+        case HEX_UNKNOWN: return "HEX_UNKNOWN";
+    }
+    return "IMPOSSIBLE";
+}
+
+std::string_view hex_record::get_type_name() const
+{
+    return get_view().get_type_name();
+}
+
+uint32_t hex_record::get_extend() const
+{
+    return get_view().get_extend();
+}
+
+uint32_t hex_record::get_start() const
+{
+    return get_view().get_start();
+}
+
 bool hex_record::is_data() const
 {
     return get_type() == record_type::HEX_DATA;
@@ -1,6 +1,7 @@
 #pragma once
 #include "vm_base_types.hxx"
 #include <exception>
+#include <functional>
 #include <stdexcept>
 
 namespace vm
@@ -15,6 +16,8 @@ namespace fs = std::filesystem;
  */
 std::optional<vm::program_code_t> load_program(const fs::path& programFile);
 
+struct hex_record_view;
+
 /**
  * @see https://en.wikipedia.org/wiki/Intel_HEX
  *
@@ -88,12 +91,176 @@ struct hex_record
     [[nodiscard]]
     bool is_extend_linear() const;
 
+    /// view of record
+    [[nodiscard]]
+    hex_record_view get_view() const;
+
     /// record payload data
     std::vector<uint8_t> data;
 };
 
-/// records from hex file
-using hex_file = std::vector<hex_record>;
+/**
+ * IntelHEX record decoded in place
+ *
+ * data points into buffer of parser or payload of hex_file
+ */
+struct hex_record_view
+{
+    uint8_t count;
+    uint8_t type;
+    uint8_t sum_expected;
+    uint8_t sum_actual;
+    uint16_t offset;
+    std::span<const uint8_t> data;
+
+    /// convert raw type to record_type
+    [[nodiscard]]
+    hex_record::record_type get_type() const;
+
+    [[nodiscard]]
+    std::string_view get_type_name() const;
+
+    ///@return true if checksums and sizes is same
+    [[nodiscard]]
+    bool is_valid() const;
+
+    ///@return true if it is EOF record
+    [[nodiscard]]
+    bool is_eof() const
+    {
+        return type == hex_record::HEX_EOF;
+    }
+
+    ///@return true if it is DATA record
+    [[nodiscard]]
+    bool is_data() const
+    {
+        return type == hex_record::HEX_DATA;
+    }
+
+    ///@return address extend
+    [[nodiscard]]
+    uint32_t get_extend() const;
+    ///@return start address
+    [[nodiscard]]
+    uint32_t get_start() const;
+};
+
+/**
+ * records from hex file in flat form
+ *
+ * payload of all records is stored in one buffer,
+ * records are packed index into it
+ */
+struct hex_file
+{
+    /// packed record
+    struct entry
+    {
+        /// absolute address of data: offset + last address extend
+        uint32_t address;
+        /// position of data in payload
+        uint32_t data_offset;
+        uint16_t offset;
+        uint8_t count;
+        uint8_t type;
+        uint8_t sum_expected;
+        uint8_t sum_actual;
+    };
+
+    /// iterator over record views
+    struct iterator
+    {
+        using value_type = hex_record_view;
+        using difference_type = std::ptrdiff_t;
+
+        const hex_file* file = nullptr;
+        size_t index = 0;
+
+        hex_record_view operator*() const
+        {
+            return (*file)[index];
+        }
+        iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            auto prev = *this;
+            ++index;
+            return prev;
+        }
+        bool operator==(const iterator& rhs) const = default;
+    };
+
+    /// copy record to end of file
+    void append(const hex_record_view& record);
+
+    [[nodiscard]]
+    size_t size() const noexcept
+    {
+        return records.size();
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return records.empty();
+    }
+
+    [[nodiscard]]
+    hex_record_view operator[](size_t index) const
+    {
+        const auto& record = records[index];
+        return {record.count, record.type, record.sum_expected, record.sum_actual, record.offset,
+                std::span{payload}.subspan(record.data_offset, record.count)};
+    }
+
+    [[nodiscard]]
+    hex_record_view front() const
+    {
+        return (*this)[0];
+    }
+
+    [[nodiscard]]
+    hex_record_view back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    /// absolute address of data record
+    [[nodiscard]]
+    uint32_t get_address(size_t index) const
+    {
+        return records[index].address;
+    }
+
+    [[nodiscard]]
+    iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    [[nodiscard]]
+    iterator end() const noexcept
+    {
+        return {this, size()};
+    }
+
+    /// data of all records
+    [[nodiscard]]
+    std::span<const uint8_t> get_payload() const noexcept
+    {
+        return payload;
+    }
+private:
+    std::vector<entry> records;
+    std::vector<uint8_t> payload;
+    /// address extend for next data records
+    uint32_t extend = 0;
+};
 
 /**
  * parse hex digit
@@ -119,6 +286,15 @@ inline std::vector<uint8_t> from_hex(const std::string& hex)
     return from_hex(std::string_view{hex});
 }
 
+/**
+ * convert hex string to bytes, 8 digits are decoded at once
+ * @param hex hex string, odd digit is ignored
+ * @param dest buffer for hex.size() / 2 bytes
+ * @return false if string contains not hex digit
+ */
+[[nodiscard]]
+bool from_hex(std::string_view hex, uint8_t* dest);
+
 /// calculate checksum for hex file record
 uint8_t hex_checksum(const uint8_t* first, const uint8_t* last);
 
@@ -138,6 +314,29 @@ std::optional<hex_file> parse_hex(std::istream& stream);
 
 hex_record parse_hex_record(std::string_view line);
 
+/**
+ * receives records from streaming parser
+ * @return false to stop parsing
+ */
+using hex_sink = std::function<bool(const hex_record_view& record)>;
+
+/**
+ * parse hex stream without intermediate records
+ *
+ * records are decoded into reused buffer and passed to sink,
+ * parsing is finished after EOF record
+ * @return false if stream is malformed or sink stopped parsing
+ */
+[[nodiscard]]
+bool parse_hex(std::istream& stream, const hex_sink& sink);
+
+/**
+ * parse hex text without intermediate records
+ * @see parse_hex(std::istream&, const hex_sink&)
+ */
+[[nodiscard]]
+bool parse_hex(std::string_view text, const hex_sink& sink);
+
 /// interpret value as signed
 inline signed_t to_signed(unsigned_t value)
 {
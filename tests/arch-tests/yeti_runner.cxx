@@ -9,6 +9,7 @@ struct Runner: protected vm::basic_vm
 {
     bool initProgram(int testIdx, char ** argv)
     {
+        enable_predecode(true);
         bool isa_ok = init_isa();
         bool mem_ok = init_memory();
         mem_ok = mem_ok && add_memory(std::make_shared<DeviceMemory>(this));
@@ -39,8 +40,9 @@ struct Runner: protected vm::basic_vm
         basic_vm::halt();
     }
 
-    bool exec(bool debug = false)
+    bool exec(engine_type engine, bool debug = false)
     {
+        set_engine(engine);
         enable_debugging(debug);
         start();
         try
@@ -125,10 +127,27 @@ protected:
 };
 } // vm::yeti_runner
 
+// usage: yeti-runner [--engine=<name>] <files...>
 int main(int argc, char ** argv)
 {
+    using engine_type = vm::basic_vm::engine_type;
+    constexpr std::string_view engine_option = "--engine=";
+    int firstIdx = 1;
+    auto engine = engine_type::interpreter;
+    if (argc > 1 && std::string_view{argv[1]}.starts_with(engine_option))
+    {
+        auto selected = vm::basic_vm::find_engine(std::string_view{argv[1]}.substr(engine_option.size()));
+        if (!selected)
+        {
+            std::cerr << "Unknown engine: " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        engine = selected.value();
+        ++firstIdx;
+    }
+
     int numFails = 0;
-    for (int testIdx = 1; testIdx < argc; ++testIdx)
+    for (int testIdx = firstIdx; testIdx < argc; ++testIdx)
     {
         vm::yeti_runner::Runner yetiVM;
         if (!yetiVM.initProgram(testIdx, argv))
@@ -136,7 +155,7 @@ int main(int argc, char ** argv)
             std::cerr << "Unable init: " << std::dec << testIdx << " " << argv[testIdx] << std::endl;
             return EXIT_FAILURE;
         }
-        if (!yetiVM.exec(argc == 2)) // single file - enable debug output
+        if (!yetiVM.exec(engine, argc == firstIdx + 1)) // single file - enable debug output
         {
             std::cerr << "Fail: " << std::dec << testIdx << " " << argv[testIdx] << std::endl;
             ++numFails;
@@ -0,0 +1,58 @@
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+
+/// sum of 1..100 with call of subroutine
+std::vector<Code> make_loop_with_call()
+{
+    constexpr std::int32_t data = vm::basic_vm::def_data_base;
+    return {
+        addi(RegAlias::a0, RegAlias::zero, 0),           // 0x00
+        addi(RegAlias::a1, RegAlias::zero, 100),         // 0x04
+        lui(RegAlias::s0, upper_of(data)),               // 0x08
+        jal(RegAlias::ra, 28),                           // 0x0c: loop -> 0x28
+        sw(RegAlias::a0, RegAlias::s0, 0),               // 0x10
+        addi(RegAlias::a1, RegAlias::a1, -1),            // 0x14
+        bne(RegAlias::a1, RegAlias::zero, -12),          // 0x18: -> 0x0c
+        lw(RegAlias::a2, RegAlias::s0, 0),               // 0x1c
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x20
+        ecall(),                                         // 0x24
+        add(RegAlias::a0, RegAlias::a0, RegAlias::a1),   // 0x28: subroutine
+        mul(RegAlias::a3, RegAlias::a0, RegAlias::a1),   // 0x2c
+        jalr(RegAlias::zero, RegAlias::ra, 0),           // 0x30
+    };
+}
+
+/// load from misaligned address in the middle of block
+std::vector<Code> make_misaligned()
+{
+    constexpr std::int32_t data = vm::basic_vm::def_data_base;
+    return {
+        lui(RegAlias::s0, upper_of(data)),               // 0x00
+        addi(RegAlias::a0, RegAlias::zero, 1),           // 0x04
+        lw(RegAlias::a1, RegAlias::s0, 2),               // 0x08: fail
+        addi(RegAlias::a0, RegAlias::zero, 2),           // 0x0c
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x10
+        ecall(),                                         // 0x14
+    };
+}
+
+int main()
+{
+    test_same_result("loop with call", make_loop_with_call(), engine_type::blocks, false);
+    test_same_result("misaligned load", make_misaligned(), engine_type::blocks, true);
+    test_same_result("self modifying", make_self_modifying(), engine_type::blocks, false);
+    test_same_result("fence", make_fence(), engine_type::blocks, false);
+    test_same_result("csr", make_csr(), engine_type::blocks, false);
+    test_register("fence", make_fence(), engine_type::interpreter, RegAlias::a2, 20 * 0x0c);
+    test_register("fence", make_fence(), engine_type::blocks, RegAlias::a2, 20 * 0x0c);
+    test_register("csr", make_csr(), engine_type::interpreter, RegAlias::a1, 0x14);
+    test_register("csr", make_csr(), engine_type::blocks, RegAlias::a1, 0x14);
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
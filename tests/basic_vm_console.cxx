@@ -0,0 +1,106 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "rv32_program.hxx"
+#include "yeti-vm/vm_console.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+
+/// output is written on newline, on full buffer and on flush
+void test_buffer()
+{
+    std::stringstream output;
+    {
+        vm::console out{output};
+        out.put('a');
+        out.write("bc");
+        vm::ensure(output.str().empty(), "buffer: text without newline is written");
+        out.put('\n');
+        vm::ensure(output.str() == "abc\n", "buffer: newline is not written");
+
+        for (size_t i = 0; i < vm::console::capacity; ++i)
+        {
+            out.put('x');
+        }
+        vm::ensure(output.str().size() == 4 + vm::console::capacity, "buffer: full buffer is not written");
+
+        const std::string large(vm::console::capacity + 10, 'y');
+        out.put('z');
+        out.write(large);
+        vm::ensure(output.str().size() == 4 + 2 * vm::console::capacity + 11, "buffer: large text is not written");
+        out.put('w');
+    }
+    vm::ensure(output.str().back() == 'w', "buffer: not written on destruction");
+}
+
+/// write guest text into memory by words
+void put_text(vm::basic_vm& machine, std::uint32_t address, std::string_view text)
+{
+    for (size_t i = 0; i < text.size(); i += sizeof(vm::register_t))
+    {
+        vm::register_t word = 0;
+        std::memcpy(&word, text.data() + i, std::min(sizeof(word), text.size() - i));
+        machine.write_memory(static_cast<std::uint32_t>(address + i), sizeof(word), word);
+    }
+}
+
+/// syscalls of guest
+void test_syscalls()
+{
+    std::stringstream output;
+    vm::console out{output};
+    vm::basic_vm machine;
+    const std::int32_t crossing = -4; // text crosses boundary of code and data blocks
+    vm::ensure(init_vm(machine, {
+        addi(RegAlias::a0, RegAlias::zero, 'A'),             // 0x00
+        addi(RegAlias::a7, RegAlias::zero, 11),              // 0x04
+        ecall(),                                             // 0x08: put_char
+        addi(RegAlias::a0, RegAlias::zero, -42),             // 0x0c
+        addi(RegAlias::a7, RegAlias::zero, 1),               // 0x10
+        ecall(),                                             // 0x14: put_int
+        addi(RegAlias::a0, RegAlias::zero, 1),               // 0x18
+        lui(RegAlias::a1, upper_of(data)),                   // 0x1c
+        addi(RegAlias::a1, RegAlias::a1, crossing),          // 0x20
+        addi(RegAlias::a2, RegAlias::zero, 12),              // 0x24
+        addi(RegAlias::a7, RegAlias::zero, 64),              // 0x28
+        ecall(),                                             // 0x2c: write(1, text, 12)
+        add(RegAlias::s0, RegAlias::a0, RegAlias::zero),     // 0x30
+        addi(RegAlias::a0, RegAlias::zero, 3),               // 0x34
+        ecall(),                                             // 0x38: write(3, ...)
+        add(RegAlias::s1, RegAlias::a0, RegAlias::zero),     // 0x3c
+        addi(RegAlias::a0, RegAlias::zero, 2),               // 0x40
+        lui(RegAlias::a1, upper_of(0x10000000)),             // 0x44
+        ecall(),                                             // 0x48: write(2, unmapped, 12)
+        add(RegAlias::s2, RegAlias::a0, RegAlias::zero),     // 0x4c
+        addi(RegAlias::a0, RegAlias::zero, 'B'),             // 0x50
+        addi(RegAlias::a7, RegAlias::zero, 11),              // 0x54
+        ecall(),                                             // 0x58: put_char, not flushed
+        addi(RegAlias::a7, RegAlias::zero, 10),              // 0x5c
+        ecall(),                                             // 0x60
+    }), "unable init VM");
+    vm::ensure(out.register_syscalls(machine), "unable register console");
+    vm::ensure(!out.register_syscalls(machine) && !out.register_print(machine), "syscalls: used ID is registered");
+    put_text(machine, data + crossing, "text\nmore...");
+    machine.start();
+    machine.run();
+
+    vm::ensure(output.str() == "A-42text\nmore...", std::format("syscalls: wrong output '{}'", output.str()));
+    vm::ensure(machine.get_register(RegAlias::s0) == 12, "syscalls: write returns size");
+    vm::ensure(machine.get_register(RegAlias::s1) == static_cast<vm::register_t>(-9), "syscalls: bad fd");
+    vm::ensure(machine.get_register(RegAlias::s2) == static_cast<vm::register_t>(-14), "syscalls: bad address");
+    out.flush();
+    vm::ensure(output.str() == "A-42text\nmore...B", "syscalls: wrong output after flush");
+}
+
+int main()
+{
+    test_buffer();
+    test_syscalls();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
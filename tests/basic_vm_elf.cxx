@@ -0,0 +1,196 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+constexpr std::uint32_t code_offset = 0x1000;
+/// data segment is not aligned by page, it is copied
+constexpr std::uint32_t data_offset = 0x2010;
+constexpr std::uint32_t symbols_offset = 0x2100;
+constexpr std::uint32_t entry = 0x08;
+
+/// program skips first instructions, sums initialized data and .bss
+std::vector<Code> make_program()
+{
+    return {
+        addi(RegAlias::a0, RegAlias::zero, 100),         // 0x00: skipped
+        ebreak(),                                        // 0x04
+        lui(RegAlias::s0, upper_of(data)),               // 0x08: entry
+        lw(RegAlias::a0, RegAlias::s0, 0x10),            // 0x0c: .data
+        lw(RegAlias::a1, RegAlias::s0, 0x14),            // 0x10
+        add(RegAlias::a0, RegAlias::a0, RegAlias::a1),   // 0x14
+        lw(RegAlias::a2, RegAlias::s0, 0x100),           // 0x18: .bss
+        add(RegAlias::a0, RegAlias::a0, RegAlias::a2),   // 0x1c
+        sw(RegAlias::a0, RegAlias::s0, 0x100),           // 0x20
+        lw(RegAlias::a3, RegAlias::zero, 0x40),          // 0x24: after code, same page
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x28
+        ecall(),                                         // 0x2c
+    };
+}
+
+template<typename T>
+void put(std::vector<std::uint8_t>& file, size_t offset, const T& value)
+{
+    if (file.size() < offset + sizeof(T))
+        file.resize(offset + sizeof(T));
+    std::memcpy(file.data() + offset, &value, sizeof(T));
+}
+
+/// minimal executable: code, data with .bss, symbol table
+std::vector<std::uint8_t> make_elf(std::uint16_t machine = 243)
+{
+    std::vector<std::uint8_t> file;
+    const auto code = to_binary(make_program());
+
+    // ident, type, machine, version, entry, phoff, shoff, flags
+    const std::uint8_t ident[16] = {0x7f, 'E', 'L', 'F', 1, 1, 1};
+    file.assign(std::begin(ident), std::end(ident));
+    put<std::uint16_t>(file, 16, 2);
+    put<std::uint16_t>(file, 18, machine);
+    put<std::uint32_t>(file, 20, 1);
+    put<std::uint32_t>(file, 24, entry);
+    put<std::uint32_t>(file, 28, 52);
+    put<std::uint32_t>(file, 32, symbols_offset + 0x100);
+    put<std::uint32_t>(file, 36, 0);
+    // ehsize, phentsize, phnum, shentsize, shnum, shstrndx
+    put<std::uint16_t>(file, 40, 52);
+    put<std::uint16_t>(file, 42, 32);
+    put<std::uint16_t>(file, 44, 2);
+    put<std::uint16_t>(file, 46, 40);
+    put<std::uint16_t>(file, 48, 3);
+    put<std::uint16_t>(file, 50, 0);
+
+    // program headers: type, offset, vaddr, paddr, filesz, memsz, flags, align
+    const std::uint32_t segments[2][8] = {
+        {1, code_offset, 0, 0, static_cast<std::uint32_t>(code.size()), static_cast<std::uint32_t>(code.size()), 5, 0x1000},
+        {1, data_offset, data + 0x10, data + 0x10, 8, 0x2000, 6, 0x10},
+    };
+    put(file, 52, segments);
+
+    file.resize(code_offset + code.size());
+    std::memcpy(file.data() + code_offset, code.data(), code.size());
+    // garbage after code in same page of file
+    put<std::uint32_t>(file, code_offset + 0x40, 0xdeadbeef);
+    put<std::uint32_t>(file, data_offset, 0x100);
+    put<std::uint32_t>(file, data_offset + 4, 0x23);
+
+    // string table and symbols: name, value, size, info, other, shndx
+    const char names[] = "\0main\0value\0label\0section";
+    put(file, symbols_offset, names);
+    struct symbol { std::uint32_t name, value, size; std::uint8_t info, other; std::uint16_t shndx; };
+    const symbol symbols[] = {
+        {0, 0, 0, 0, 0, 0},
+        {1, entry, 0x24, 0x12, 0, 1},       // main, global function
+        {6, data + 0x10, 8, 0x11, 0, 2},    // value, global object
+        {12, 0x20, 0, 0x10, 0, 1},          // label, no type
+        {18, 0, 0, 0x03, 0, 1},             // section
+    };
+    put(file, symbols_offset + 0x40, symbols);
+
+    // section headers: null, symtab, strtab
+    const std::uint32_t sections[3][10] = {
+        {},
+        {0, 2, 0, 0, symbols_offset + 0x40, sizeof(symbols), 2, 1, 4, sizeof(symbol)},
+        {0, 3, 0, 0, symbols_offset, sizeof(names), 0, 0, 1, 0},
+    };
+    put(file, symbols_offset + 0x100, sections);
+    return file;
+}
+
+vm::program_image::ptr make_image(const std::vector<std::uint8_t>& file)
+{
+    auto image = vm::program_image::create(file);
+    vm::ensure(image != nullptr, "unable create image");
+    return image;
+}
+
+/// VM with loaded executable
+void test_layout(const vm::elf_file& elf)
+{
+    vm::ensure(elf.get_entry() == entry, "layout: wrong entry");
+    const auto& segments = elf.get_segments();
+    vm::ensure(segments.size() == 2, "layout: expected 2 segments");
+    vm::ensure(segments[0].address == 0 && segments[0].image->get_size() == make_program().size() * sizeof(Code),
+               "layout: wrong code segment");
+    vm::ensure(segments[1].address == data + 0x10 && segments[1].memory_size == 0x2000
+               && segments[1].image->get_size() == 8, "layout: wrong data segment");
+
+    const auto& symbols = elf.get_symbols();
+    vm::ensure(symbols.size() == 2, "symbols: expected functions and objects only");
+    vm::ensure(elf.find_symbol(entry + 0x10) && elf.find_symbol(entry + 0x10)->name == "main", "symbols: main");
+    vm::ensure(elf.find_symbol(data + 0x14) && elf.find_symbol(data + 0x14)->name == "value", "symbols: value");
+    vm::ensure(elf.find_symbol(entry + 0x24) == nullptr, "symbols: address after main");
+    vm::ensure(elf.find_symbol(0) == nullptr, "symbols: address before main");
+}
+
+/// each VM gets own copy of segments, .bss is zeroed
+void test_run(const vm::elf_file& elf, engine_type engine)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        fixture vm{elf, engine};
+        vm.machine.run();
+        const auto name = std::format("{}/{}", static_cast<int>(engine), i);
+        vm::ensure(vm.machine.get_register(RegAlias::a1) == 0x23, name + ": wrong data");
+        vm::ensure(vm.machine.get_register(RegAlias::a2) == 0, name + ": .bss is not zeroed");
+        vm::ensure(vm.machine.get_register(RegAlias::a0) == 0x123, name + ": wrong result");
+        vm::ensure(vm.machine.get_register(RegAlias::a3) == 0, name + ": tail of code page is not zeroed");
+    }
+}
+
+void test_invalid()
+{
+    vm::ensure(vm::elf_file::parse(*make_image(make_elf(62))) == nullptr, "invalid: other machine is accepted");
+
+    auto file = make_elf();
+    file.resize(60);
+    vm::ensure(vm::elf_file::parse(*make_image(file)) == nullptr, "invalid: truncated file is accepted");
+
+    file = make_elf();
+    file[4] = 2; // 64-bit
+    vm::ensure(vm::elf_file::parse(*make_image(file)) == nullptr, "invalid: 64-bit file is accepted");
+
+    // segment outside of memory
+    file = make_elf();
+    put<std::uint32_t>(file, 52 + 32 + 8, 0x10000000);
+    auto elf = vm::elf_file::parse(*make_image(file));
+    vm::ensure(elf != nullptr, "invalid: unable parse");
+    vm::basic_vm machine;
+    vm::ensure(machine.init_isa() && machine.init_memory(), "invalid: unable init VM");
+    vm::ensure(!machine.set_program(*elf), "invalid: segment out of memory is loaded");
+}
+
+int main()
+{
+    const auto content = make_elf();
+    const auto path = std::filesystem::temp_directory_path() / std::format("yeti-elf-{}.elf", content.size());
+    {
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+        vm::ensure(file.good(), "unable write executable");
+    }
+    const auto mapped = vm::elf_file::open(path);
+    std::filesystem::remove(path);
+    vm::ensure(mapped != nullptr, "unable open executable");
+    const auto parsed = vm::elf_file::parse(*make_image(content));
+    vm::ensure(parsed != nullptr, "unable parse executable");
+
+    for (const auto* elf: {mapped.get(), parsed.get()})
+    {
+        test_layout(*elf);
+        for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+        {
+            test_run(*elf, engine);
+        }
+    }
+    test_invalid();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+using vm::fusion::kind;
+
+/// hot loop with all kinds of fusible pairs
+std::vector<Code> make_fusible_loop()
+{
+    constexpr Code constant = 0x12345678;
+    constexpr Code offset = 0x1000;
+    return {
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x00
+        addi(RegAlias::a1, RegAlias::zero, 40),                  // 0x04
+        addi(RegAlias::s1, RegAlias::zero, 0),                   // 0x08
+        addi(RegAlias::a2, RegAlias::zero, 20),                  // 0x0c
+        lui(RegAlias::t0, upper_of(constant)),                   // 0x10: loop, li
+        addi(RegAlias::t0, RegAlias::t0, lower_of(constant)),    // 0x14
+        add(RegAlias::s1, RegAlias::s1, RegAlias::t0),           // 0x18
+        auipc(RegAlias::t1, upper_of(offset)),                   // 0x1c: la
+        addi(RegAlias::t1, RegAlias::t1, lower_of(offset)),      // 0x20
+        add(RegAlias::s1, RegAlias::s1, RegAlias::t1),           // 0x24
+        slli(RegAlias::t2, RegAlias::a0, 3),                     // 0x28: shift + add
+        add(RegAlias::s1, RegAlias::t2, RegAlias::s1),           // 0x2c
+        slt(RegAlias::t3, RegAlias::a0, RegAlias::a2),           // 0x30: slt + bne
+        bne(RegAlias::t3, RegAlias::zero, 8),                    // 0x34: -> 0x3c
+        addi(RegAlias::s1, RegAlias::s1, 7),                     // 0x38
+        op_r(RegAlias::t4, RegAlias::a2, RegAlias::a0, 0b011, 0),// 0x3c: sltu + beq
+        beq(RegAlias::zero, RegAlias::t4, 8),                    // 0x40: -> 0x48
+        op_i(RegAlias::s1, RegAlias::s1, 0x55, 0b100),           // 0x44: xori
+        auipc(RegAlias::ra, 0),                                  // 0x48: call
+        jalr(RegAlias::ra, RegAlias::ra, 0x18),                  // 0x4c: -> 0x60
+        addi(RegAlias::a0, RegAlias::a0, 1),                     // 0x50
+        branch(RegAlias::a0, RegAlias::a1, -0x44, 0b100),        // 0x54: blt -> 0x10
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x58
+        ecall(),                                                 // 0x5c
+        slli(RegAlias::t5, RegAlias::a0, 1),                     // 0x60: subroutine
+        add(RegAlias::s1, RegAlias::s1, RegAlias::t5),           // 0x64
+        jalr(RegAlias::zero, RegAlias::ra, 0),                   // 0x68
+    };
+}
+
+/// pairs which should not be fused
+std::vector<Code> make_not_fusible()
+{
+    return {
+        lui(RegAlias::t0, 0x1000),                               // 0x00: other dest
+        addi(RegAlias::t1, RegAlias::t0, 1),                     // 0x04
+        lui(RegAlias::zero, 0x2000),                             // 0x08: dest is zero
+        addi(RegAlias::zero, RegAlias::zero, 1),                 // 0x0c
+        slli(RegAlias::t2, RegAlias::t1, 2),                     // 0x10: add does not use shift
+        add(RegAlias::t3, RegAlias::t1, RegAlias::t0),           // 0x14
+        slt(RegAlias::t4, RegAlias::t0, RegAlias::t1),           // 0x18: compare with non zero
+        beq(RegAlias::t4, RegAlias::t1, 8),                      // 0x1c: -> 0x24
+        addi(RegAlias::s1, RegAlias::zero, 1),                   // 0x20
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x24
+        ecall(),                                                 // 0x28
+    };
+}
+
+/// call with misaligned target traps at jalr
+std::vector<Code> make_misaligned_call()
+{
+    return {
+        addi(RegAlias::a0, RegAlias::zero, 5),                   // 0x00
+        auipc(RegAlias::t0, 0),                                  // 0x04
+        jalr(RegAlias::ra, RegAlias::t0, 0x0a),                  // 0x08: -> 0x0e
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x0c
+        ecall(),                                                 // 0x10
+    };
+}
+
+/// taken branch with misaligned target traps at bne
+std::vector<Code> make_misaligned_branch()
+{
+    return {
+        addi(RegAlias::a0, RegAlias::zero, 1),                   // 0x00
+        slt(RegAlias::t0, RegAlias::zero, RegAlias::a0),         // 0x04
+        bne(RegAlias::t0, RegAlias::zero, 6),                    // 0x08: -> 0x0e
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x0c
+        ecall(),                                                 // 0x10
+    };
+}
+
+/// run program until trap, result of run and registers are returned
+std::pair<vm::basic_vm::run_result, vm::register_file> run_trapped(
+    const std::vector<Code>& program, engine_type engine, bool fusion)
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, program), "unable init VM");
+    machine.set_engine(engine);
+    machine.enable_fusion(fusion);
+    machine.start();
+    auto result = machine.run_for(std::numeric_limits<std::uint64_t>::max());
+    vm::register_file registers{};
+    for (vm::register_no r = 0; r < vm::register_count; ++r)
+    {
+        registers[r] = machine.get_register(r);
+    }
+    for (auto hits: machine.get_fusion_stats())
+    {
+        vm::ensure(hits == 0, "misaligned jump: pair is fused");
+    }
+    return {result, registers};
+}
+
+/// trap of misaligned jump is same with and without fusion
+void test_misaligned(std::string_view name, const std::vector<Code>& program)
+{
+    const auto [expected, expected_registers] = run_trapped(program, engine_type::interpreter, false);
+    vm::ensure(expected.fault.cause == vm::trap_cause::misaligned_jump && expected.fault.pc == 0x08,
+               std::format("{}: trap at jump expected", name));
+    for (auto engine: {engine_type::blocks, engine_type::jit})
+    {
+        for (bool fusion: {false, true})
+        {
+            const auto [actual, registers] = run_trapped(program, engine, fusion);
+            const auto id = std::format("{}, engine {}, fusion {}", name, static_cast<int>(engine), fusion);
+            vm::ensure(actual.reason == expected.reason && actual.executed == expected.executed,
+                       std::format("{}: executed {}, expected {}", id, actual.executed, expected.executed));
+            vm::ensure(actual.fault.cause == expected.fault.cause && actual.fault.pc == expected.fault.pc &&
+                       actual.fault.address == expected.fault.address,
+                       std::format("{}: trap at {:08x}, expected {:08x}", id, actual.fault.pc, expected.fault.pc));
+            vm::ensure(registers == expected_registers, std::format("{}: wrong registers", id));
+        }
+    }
+}
+
+/// run program by blocks engine, return fusion stats
+vm::fusion::counters run_fused(const std::vector<Code>& program, bool enable)
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, program), "unable init VM");
+    machine.set_engine(engine_type::blocks);
+    machine.enable_fusion(enable);
+    machine.start();
+    machine.run();
+    return machine.get_fusion_stats();
+}
+
+size_t get_hits(const vm::fusion::counters& stats, kind id)
+{
+    return stats[static_cast<size_t>(id)];
+}
+
+int main()
+{
+    const auto program = make_fusible_loop();
+    test_same_result("fusible loop, blocks", program, engine_type::blocks, false);
+    test_same_result("fusible loop, jit", program, engine_type::jit, false);
+    test_same_result("not fusible, blocks", make_not_fusible(), engine_type::blocks, false);
+
+    const auto stats = run_fused(program, true);
+    for (auto id: {kind::lui_addi, kind::auipc_addi, kind::auipc_jalr, kind::slt_bne, kind::sltu_beq})
+    {
+        vm::ensure(get_hits(stats, id) == 40, std::format("{}: expected 40 hits", vm::fusion::get_name(id)));
+    }
+    // loop body and subroutine
+    vm::ensure(get_hits(stats, kind::slli_add) == 80, "slli+add: expected 80 hits");
+    vm::ensure(get_hits(stats, kind::slt_beq) == 0, "slt+beq: unexpected hits");
+
+    test_misaligned("misaligned call", make_misaligned_call());
+    test_misaligned("misaligned branch", make_misaligned_branch());
+
+    for (auto hits: run_fused(make_not_fusible(), true))
+    {
+        vm::ensure(hits == 0, "not fusible: unexpected hits");
+    }
+    for (auto hits: run_fused(program, false))
+    {
+        vm::ensure(hits == 0, "fusion disabled: unexpected hits");
+    }
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
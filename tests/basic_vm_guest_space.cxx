@@ -0,0 +1,135 @@
+#include <iostream>
+
+#include "device_memory.hxx"
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+using vm::trap_cause;
+using tests::device_memory;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+constexpr std::int32_t device = 0x2000'0010;
+constexpr vm::register_t device_value = 0x5a5a'0001;
+
+/// guest space is reserved if `reserve`, device block is added
+fixture::setup_fn make_setup(bool reserve)
+{
+    return [reserve](vm::basic_vm& machine) {
+        if (reserve)
+        {
+            vm::ensure(machine.enable_guest_space(), "unable reserve guest space");
+        }
+        vm::ensure(machine.add_memory(std::make_shared<device_memory>(device, 0x10, device_value)), "unable add device");
+    };
+}
+
+/// walk over data block by pages: a0 = sum of loaded words, trap after end of block
+std::vector<Code> make_walk(std::int32_t offset)
+{
+    return {
+        lui(RegAlias::s0, upper_of(data)),                       // 0x00
+        addi(RegAlias::s0, RegAlias::s0, offset),                // 0x04
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x08
+        addi(RegAlias::t0, RegAlias::zero, 3),                   // 0x0c
+        sw(RegAlias::t0, RegAlias::s0, 0),                       // 0x10: loop
+        load(RegAlias::t1, RegAlias::s0, 0, 0b010),              // 0x14
+        add(RegAlias::a0, RegAlias::a0, RegAlias::t1),           // 0x18
+        lui(RegAlias::t2, 0x1000),                               // 0x1c
+        add(RegAlias::s0, RegAlias::s0, RegAlias::t2),           // 0x20
+        jal(RegAlias::zero, -20),                                // 0x24: -> 0x10
+    };
+}
+
+/// direct access of compiled code traps at end of block, result matches interpreter
+void test_walk(std::int32_t offset, trap_cause cause, vm::register_t fault_pc)
+{
+    std::vector<vm::trap> traps;
+    std::vector<vm::register_file> states;
+    for (auto [engine, reserve]: {std::pair{engine_type::interpreter, false},
+                                  std::pair{engine_type::interpreter, true},
+                                  std::pair{engine_type::jit, true}})
+    {
+        fixture vm{make_walk(offset), engine, make_setup(reserve)};
+        traps.push_back(vm.machine.run_until_trap());
+        vm::register_file state{};
+        for (vm::register_no r = 0; r < vm::register_count; ++r)
+        {
+            state[r] = vm.machine.get_register(r);
+        }
+        states.push_back(state);
+        if (engine == engine_type::jit)
+        {
+            // loads and stores of compiled code bypass VM
+            const auto& stats = vm.machine.get_tlb_stats();
+            vm::ensure(stats.hits + stats.misses < 100, "walk: direct access is not used");
+        }
+    }
+    const auto name = std::format("walk {}", offset);
+    for (size_t i = 0; i < traps.size(); ++i)
+    {
+        vm::ensure(traps[i].cause == cause,
+                   std::format("{}/{}: cause {}, expected {}", name, i, vm::get_name(traps[i].cause), vm::get_name(cause)));
+        vm::ensure(traps[i].pc == fault_pc, std::format("{}/{}: pc {:08x}", name, i, traps[i].pc));
+        vm::ensure(traps[i].address == traps[0].address, std::format("{}/{}: wrong address", name, i));
+        vm::ensure(states[i] == states[0], std::format("{}/{}: state differs from interpreter", name, i));
+    }
+}
+
+/// compiled code reads device and patches own loop
+void test_side_effects()
+{
+    const Code patched = addi(RegAlias::a0, RegAlias::a0, 100);
+    const std::vector<Code> program{
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x00
+        addi(RegAlias::a1, RegAlias::zero, 40),                  // 0x04
+        lui(RegAlias::t0, upper_of(patched)),                    // 0x08
+        addi(RegAlias::t0, RegAlias::t0, lower_of(patched)),     // 0x0c
+        lui(RegAlias::s2, upper_of(data)),                       // 0x10
+        addi(RegAlias::s3, RegAlias::zero, 0x24),                // 0x14
+        sub(RegAlias::s3, RegAlias::s3, RegAlias::s2),           // 0x18: code - data
+        addi(RegAlias::a1, RegAlias::a1, -1),                    // 0x1c: loop
+        addi(RegAlias::t1, RegAlias::a1, -20),                   // 0x20
+        addi(RegAlias::a0, RegAlias::a0, 1),                     // 0x24: patched
+        op_i(RegAlias::t1, RegAlias::t1, 1, 0b011),              // 0x28: sltiu
+        mul(RegAlias::t2, RegAlias::t1, RegAlias::s3),           // 0x2c
+        add(RegAlias::t2, RegAlias::t2, RegAlias::s2),           // 0x30: data or code
+        sw(RegAlias::t0, RegAlias::t2, 0),                       // 0x34
+        lui(RegAlias::t3, upper_of(device)),                     // 0x38
+        lw(RegAlias::t4, RegAlias::t3, lower_of(device)),        // 0x3c: device
+        add(RegAlias::s4, RegAlias::s4, RegAlias::t4),           // 0x40
+        bne(RegAlias::a1, RegAlias::zero, -0x28),                // 0x44: -> 0x1c
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x48
+        ecall(),                                                 // 0x4c
+    };
+    fixture vm{program, engine_type::jit, make_setup(true)};
+    vm.machine.run();
+    vm::ensure(vm.machine.get_register(RegAlias::a0) == 20 + 20 * 100, "patched code is not executed");
+    vm::ensure(vm.machine.get_register(RegAlias::s4) == 40 * device_value, "device is not read");
+}
+
+int main()
+{
+    if (!vm::guest_space::is_supported())
+    {
+        std::cout << "ok: guest space is not supported" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    {
+        vm::basic_vm machine;
+        vm::ensure(init_vm(machine, {ecall()}), "unable init VM");
+        vm::ensure(!machine.enable_guest_space(), "reservation after memory should fail");
+        vm::ensure(!machine.is_guest_space_enabled(), "guest space should be disabled");
+    }
+
+    // out of data block
+    test_walk(0, trap_cause::store_access, 0x10);
+    // misaligned
+    test_walk(2, trap_cause::misaligned_store, 0x10);
+    test_side_effects();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
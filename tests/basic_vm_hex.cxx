@@ -0,0 +1,170 @@
+#include <iostream>
+#include <sstream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+
+/// write IntelHEX record
+void put_record(std::ostream& hex, std::uint8_t type, std::uint16_t offset, std::span<const std::uint8_t> payload)
+{
+    std::vector<std::uint8_t> bytes{static_cast<std::uint8_t>(payload.size()),
+                                    static_cast<std::uint8_t>(offset >> 8u), static_cast<std::uint8_t>(offset), type};
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    bytes.push_back(vm::hex_checksum(bytes.data(), bytes.data() + bytes.size()));
+    hex << ':';
+    for (auto byte: bytes)
+    {
+        hex << std::format("{:02X}", byte);
+    }
+    hex << "\r\n";
+}
+
+/// write binary at address by records of record_size bytes, record should not cross 64K boundary
+void put_data(std::ostream& hex, std::uint32_t address, std::span<const std::uint8_t> bin, size_t record_size)
+{
+    for (size_t pos = 0; pos < bin.size(); pos += record_size)
+    {
+        const auto current = static_cast<std::uint32_t>(address + pos);
+        if (pos == 0 || (current & 0xffffu) == 0)
+        {
+            const std::uint8_t extend[] = {static_cast<std::uint8_t>(current >> 24u), static_cast<std::uint8_t>(current >> 16u)};
+            put_record(hex, vm::hex_record::HEX_LINEAR_EXTEND, 0, extend);
+        }
+        put_record(hex, vm::hex_record::HEX_DATA, static_cast<std::uint16_t>(current),
+                   bin.subspan(pos, std::min(record_size, bin.size() - pos)));
+    }
+}
+
+/// code and initialized data, entry point is not at start of code
+std::string make_hex()
+{
+    const auto code = to_binary({
+        addi(RegAlias::a0, RegAlias::zero, 100),         // 0x00: skipped
+        lui(RegAlias::s0, upper_of(data)),               // 0x04: entry
+        lw(RegAlias::a0, RegAlias::s0, 0),               // 0x08
+        lw(RegAlias::a1, RegAlias::s0, 0x20),            // 0x0c
+        add(RegAlias::a0, RegAlias::a0, RegAlias::a1),   // 0x10
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x14
+        ecall(),                                         // 0x18
+    });
+    std::vector<std::uint8_t> values(0x24);
+    values[0] = 0x11;
+    values[0x20] = 0x22;
+
+    std::stringstream hex;
+    put_data(hex, 0, code, 16);
+    put_data(hex, data, values, 32);
+    const std::uint8_t start[] = {0, 0, 0, 4};
+    put_record(hex, vm::hex_record::HEX_LINEAR_START, 0, start);
+    put_record(hex, vm::hex_record::HEX_EOF, 0, {});
+    return hex.str();
+}
+
+/// VM without program
+struct empty_fixture
+{
+    vm::basic_vm machine;
+
+    empty_fixture()
+    {
+        vm::ensure(init_machine(machine), "unable init VM");
+    }
+
+    void run(std::string_view name)
+    {
+        machine.start();
+        vm::ensure(machine.get_pc() == 4, std::format("{}: wrong entry point", name));
+        machine.run();
+        vm::ensure(machine.get_register(RegAlias::a0) == 0x33, std::format("{}: wrong result", name));
+    }
+};
+
+/// records are loaded from parsed file and straight from stream
+void test_load()
+{
+    const auto text = make_hex();
+    {
+        std::stringstream stream{text};
+        auto hex = vm::parse_hex(stream);
+        vm::ensure(hex.has_value(), "records: unable parse");
+        empty_fixture vm;
+        vm::ensure(vm.machine.set_program(hex.value()), "records: unable load");
+        vm.run("records");
+    }
+    {
+        std::stringstream stream{text};
+        empty_fixture vm;
+        vm::ensure(vm.machine.set_program(stream), "stream: unable load");
+        vm.run("stream");
+    }
+}
+
+/// contiguous records are written by runs, run may cross boundary of blocks
+void test_runs()
+{
+    std::vector<std::uint8_t> bin(0x30000);
+    for (size_t i = 0; i < bin.size(); ++i)
+    {
+        bin[i] = static_cast<std::uint8_t>(i * 13 + 1);
+    }
+    const std::uint32_t address = data - 0x8000;
+
+    std::stringstream hex;
+    put_data(hex, 0, to_binary({addi(RegAlias::a7, RegAlias::zero, 10), ecall()}), 16);
+    put_data(hex, address, bin, 16);
+    put_record(hex, vm::hex_record::HEX_EOF, 0, {});
+
+    empty_fixture vm;
+    vm::ensure(vm.machine.set_program(hex), "runs: unable load");
+    for (size_t i = 0; i < bin.size(); i += sizeof(vm::register_t))
+    {
+        vm::register_t expected = 0;
+        std::memcpy(&expected, bin.data() + i, sizeof(expected));
+        vm::register_t actual = 0;
+        vm.machine.read_memory(address + i, sizeof(actual), actual);
+        vm::ensure(actual == expected, std::format("runs: wrong value at {:08x}", address + i));
+    }
+}
+
+void test_invalid()
+{
+    const auto text = make_hex();
+    {
+        // broken checksum of first data record
+        auto broken = text;
+        auto pos = broken.find("\r\n", broken.find("\r\n") + 1);
+        broken[pos - 1] = broken[pos - 1] == '0' ? '1' : '0';
+        std::stringstream stream{broken};
+        empty_fixture vm;
+        vm::ensure(!vm.machine.set_program(stream), "checksum: broken record is loaded");
+    }
+    {
+        // no EOF record
+        std::stringstream stream{text.substr(0, text.rfind(':'))};
+        empty_fixture vm;
+        vm::ensure(!vm.machine.set_program(stream), "EOF: program without EOF record is loaded");
+    }
+    {
+        // data outside of memory
+        std::stringstream hex;
+        const std::uint8_t values[] = {1, 2, 3, 4};
+        put_data(hex, 0x10000000, values, 16);
+        put_record(hex, vm::hex_record::HEX_EOF, 0, {});
+        empty_fixture vm;
+        vm::ensure(!vm.machine.set_program(hex), "range: data outside of memory is loaded");
+    }
+}
+
+int main()
+{
+    test_load();
+    test_runs();
+    test_invalid();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "rv32_program.hxx"
+#include "yeti-vm/vm_io_ring.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using enum vm::RegAlias;
+using ring = vm::io_ring;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+constexpr std::uint32_t entries = 8;
+constexpr std::uint32_t texts = data + 0x400;
+constexpr std::uint32_t path = data + 0x600;
+
+/// guest opens file, submits prepared requests by two batches
+std::vector<Code> make_program()
+{
+    return {
+        lui(s0, upper_of(data)),
+        // s2 = open("ring.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644)
+        addi(a0, s0, 0x600), addi(a1, zero, 01101), addi(a2, zero, 0644),
+        addi(a7, zero, 1024), ecall(), add(s2, a0, zero),
+        // s1 = ring_setup(data, 8)
+        addi(a0, s0, 0), addi(a1, zero, entries),
+        addi(a7, zero, ring::setup_id), ecall(), add(s1, a0, zero),
+        // sq_tail = 8, s3 = ring_enter(8)
+        addi(t0, zero, 8), sw(t0, s0, 4),
+        addi(a0, zero, 8), addi(a7, zero, ring::enter_id), ecall(), add(s3, a0, zero),
+        // write(3, texts, 2 GiB) with user_data 9 wraps to slot 0: size is rejected
+        lui(t1, upper_of(0x3'0002)), addi(t1, t1, lower_of(0x3'0002)), sw(t1, s0, 16),
+        lui(t1, 0x8000'0000), sw(t1, s0, 24),
+        addi(t0, zero, 9), sw(t0, s0, 28),
+        // sq_tail = 9, s4 = ring_enter(0): completion queue is full
+        sw(t0, s0, 4),
+        addi(a0, zero, 0), ecall(), add(s4, a0, zero),
+        // cq_head = 8, s5 = ring_enter(1)
+        addi(t0, zero, 8), sw(t0, s0, 8),
+        addi(a0, zero, 1), ecall(), add(s5, a0, zero),
+        // s6 = ring_setup(data, 3)
+        addi(a0, s0, 0), addi(a1, zero, 3),
+        addi(a7, zero, ring::setup_id), ecall(), add(s6, a0, zero),
+        // close(s2)
+        add(a0, s2, zero), addi(a7, zero, 57), ecall(),
+        addi(a7, zero, 10), ecall(),
+    };
+}
+
+/// write bytes into guest memory
+void put_bytes(vm::basic_vm& machine, std::uint32_t address, const void* bytes, size_t size)
+{
+    auto view = machine.get_guest_span(address, size);
+    vm::ensure(view.has_value(), "unable write guest memory");
+    std::memcpy(view->data(), bytes, size);
+}
+
+std::string read_file(const std::filesystem::path& file_path)
+{
+    std::ifstream file{file_path, std::ios::binary};
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+void test_ring(bool use_worker)
+{
+    const auto name = use_worker ? "worker" : "inline";
+    const auto root = std::filesystem::temp_directory_path() / std::format("yeti-ring-{:08x}", std::random_device{}());
+    std::filesystem::create_directories(root);
+
+    std::stringstream output;
+    vm::console out{output};
+    vm::linux_abi abi{out, root};
+    ring io{abi, use_worker};
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, make_program()), "unable init VM");
+    vm::ensure(abi.register_syscalls(machine), "unable register syscalls");
+    vm::ensure(io.register_syscalls(machine), "unable register ring");
+    vm::ensure(!io.register_syscalls(machine), std::format("{}: used ID is registered", name));
+
+    put_bytes(machine, texts, "first second!console\n", 21);
+    put_bytes(machine, path, "ring.txt", 9);
+    // fd 3 is opened by guest, last request is written by guest
+    const ring::submission requests[] = {
+        {ring::op_write, 3, texts, 6, 1},
+        {ring::op_write, 3, texts + 6, 6, 2},
+        {ring::op_nop, 0, 0, 0, 3},
+        {ring::op_read, 9, texts, 4, 4},
+        {ring::op_write, 1, texts + 13, 8, 5},
+        {7, 3, texts, 4, 6},
+        {ring::op_write, 3, 0x10000000, 4, 7},
+        {ring::op_write, 3, texts + 12, 1, 8},
+    };
+    const std::map<std::uint32_t, std::int32_t> expected{
+        {1, 6}, {2, 6}, {3, 0}, {4, -9}, {5, 8}, {6, -22}, {7, -14}, {8, 1}, {9, -22},
+    };
+    const auto queue = data + sizeof(ring::header);
+    for (std::uint32_t i = 0; i < entries; ++i)
+    {
+        put_bytes(machine, queue + i * sizeof(ring::submission), &requests[i], sizeof(ring::submission));
+    }
+
+    machine.start();
+    machine.run();
+    io.wait();
+
+    auto reg = [&](RegAlias r) { return machine.get_register(r); };
+    vm::ensure(reg(s2) == 3, std::format("{}: file is not opened", name));
+    vm::ensure(reg(s1) == 0, std::format("{}: setup failed", name));
+    vm::ensure(reg(s3) == entries, std::format("{}: batch is not consumed", name));
+    vm::ensure(reg(s4) == 0, std::format("{}: request is consumed with full completion queue", name));
+    vm::ensure(reg(s5) == 1, std::format("{}: wrapped request is not consumed", name));
+    vm::ensure(reg(s6) == static_cast<vm::register_t>(-22), std::format("{}: size is not checked", name));
+    vm::ensure(io.get_requests() == entries + 1, std::format("{}: wrong count of requests", name));
+
+    ring::header state{};
+    std::memcpy(&state, machine.get_guest_span(data, sizeof(state))->data(), sizeof(state));
+    vm::ensure(state.sq_head == entries + 1 && state.cq_tail == entries + 1, std::format("{}: wrong indexes", name));
+    const auto completions = queue + entries * sizeof(ring::submission);
+    std::set<std::uint32_t> seen;
+    for (std::uint32_t i = 0; i < entries; ++i)
+    {
+        ring::completion value{};
+        std::memcpy(&value, machine.get_guest_span(completions + i * sizeof(value), sizeof(value))->data(), sizeof(value));
+        auto it = expected.find(value.user_data);
+        vm::ensure(it != expected.end() && it->second == value.result,
+                   std::format("{}: wrong completion {} = {}", name, value.user_data, value.result));
+        seen.insert(value.user_data);
+    }
+    vm::ensure(seen.size() == entries, std::format("{}: completion is posted twice", name));
+
+    vm::ensure(read_file(root / "ring.txt") == "first second!", std::format("{}: wrong file content", name));
+    vm::ensure(output.str() == "console\n", std::format("{}: wrong console output", name));
+    std::filesystem::remove_all(root);
+}
+
+int main()
+{
+    test_ring(false);
+    test_ring(true);
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
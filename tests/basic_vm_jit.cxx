@@ -0,0 +1,168 @@
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+constexpr std::int32_t iterations = 40;
+
+/// all ALU and memory operations in hot loop
+std::vector<Code> make_all_ops()
+{
+    using R = RegAlias;
+    std::vector<Code> program{
+        lui(R::s0, upper_of(data)),
+        addi(R::a0, R::zero, iterations),
+        lui(R::t0, upper_of(0x12345678)),
+        addi(R::t0, R::t0, lower_of(0x12345678)),
+        addi(R::t1, R::zero, -7),
+        addi(R::s1, R::zero, 0),
+    };
+    const auto loop = program.size();
+    // each result is accumulated in s1
+    const std::vector<Code> operations{
+        op_r(R::t2, R::t0, R::t1, 0b000, 0b0000000),     // add
+        op_r(R::t2, R::t0, R::t1, 0b000, 0b0100000),     // sub
+        op_r(R::t2, R::s1, R::t1, 0b100, 0b0000000),     // xor
+        op_r(R::t2, R::s1, R::t1, 0b110, 0b0000000),     // or
+        op_r(R::t2, R::s1, R::t0, 0b111, 0b0000000),     // and
+        op_r(R::t2, R::t0, R::a0, 0b001, 0b0000000),     // sll
+        op_r(R::t2, R::t1, R::a0, 0b101, 0b0000000),     // srl
+        op_r(R::t2, R::t1, R::a0, 0b101, 0b0100000),     // sra
+        op_r(R::t2, R::t1, R::t0, 0b010, 0b0000000),     // slt
+        op_r(R::t2, R::t1, R::t0, 0b011, 0b0000000),     // sltu
+        op_i(R::t2, R::t0, -100, 0b100),                 // xori
+        op_i(R::t2, R::t0, 0x70f, 0b110),                // ori
+        op_i(R::t2, R::t1, 0x3f0, 0b111),                // andi
+        op_i(R::t2, R::t0, 7, 0b001),                    // slli
+        op_i(R::t2, R::t1, 9, 0b101),                    // srli
+        op_i(R::t2, R::t1, 0x400 | 9, 0b101),            // srai
+        op_i(R::t2, R::t1, -8, 0b010),                   // slti
+        op_i(R::t2, R::t0, -1, 0b011),                   // sltiu
+        op_r(R::t2, R::t0, R::t1, 0b000, 0b0000001),     // mul
+        op_r(R::t2, R::t0, R::t1, 0b001, 0b0000001),     // mulh
+        op_r(R::t2, R::t0, R::t1, 0b010, 0b0000001),     // mulhsu
+        op_r(R::t2, R::t0, R::t1, 0b011, 0b0000001),     // mulhu
+        op_r(R::t2, R::t0, R::t1, 0b100, 0b0000001),     // div
+        op_r(R::t2, R::t0, R::zero, 0b101, 0b0000001),   // divu by zero
+        op_r(R::t2, R::t0, R::t1, 0b110, 0b0000001),     // rem
+        op_r(R::t2, R::t0, R::zero, 0b111, 0b0000001),   // remu by zero
+        store(R::t1, R::s0, 0, 0b010),                   // sw
+        store(R::t0, R::s0, 5, 0b000),                   // sb
+        store(R::s1, R::s0, 6, 0b001),                   // sh
+        load(R::t2, R::s0, 0, 0b010),                    // lw
+        load(R::t2, R::s0, 5, 0b000),                    // lb
+        load(R::t2, R::s0, 6, 0b001),                    // lh
+        load(R::t2, R::s0, 5, 0b100),                    // lbu
+        load(R::t2, R::s0, 6, 0b101),                    // lhu
+        lui(R::t2, 0xabcde000),
+        auipc(R::t2, 0x2000),
+        auipc(R::zero, 0x1000),                          // no effect
+    };
+    for (auto code: operations)
+    {
+        program.push_back(code);
+        program.push_back(add(R::s1, R::s1, R::t2));
+    }
+    // mix values for next iteration
+    program.push_back(add(R::t0, R::t0, R::s1));
+    program.push_back(op_r(R::t1, R::t1, R::t0, 0b100, 0b0000000));
+    program.push_back(addi(R::a0, R::a0, -1));
+    const auto offset = static_cast<std::int32_t>(loop - program.size()) * 4;
+    program.push_back(bne(R::a0, R::zero, offset));
+    program.push_back(addi(R::a7, R::zero, 10));
+    program.push_back(ecall());
+    return program;
+}
+
+/// all branch conditions and calls in hot loop
+std::vector<Code> make_branches()
+{
+    using R = RegAlias;
+    return {
+        addi(R::a0, R::zero, iterations),                // 0x00
+        addi(R::a1, R::zero, 0),                         // 0x04
+        addi(R::a2, R::zero, -3),                        // 0x08
+        // loop:
+        branch(R::a0, R::a2, 8, 0b100),                  // 0x0c: blt -> 0x14
+        addi(R::a1, R::a1, 1),                           // 0x10
+        branch(R::a0, R::a2, 8, 0b110),                  // 0x14: bltu -> 0x1c
+        addi(R::a1, R::a1, 2),                           // 0x18
+        branch(R::a0, R::a2, 8, 0b101),                  // 0x1c: bge -> 0x24
+        addi(R::a1, R::a1, 4),                           // 0x20
+        branch(R::a0, R::a2, 8, 0b111),                  // 0x24: bgeu -> 0x2c
+        addi(R::a1, R::a1, 8),                           // 0x28
+        jal(R::ra, 36),                                  // 0x2c: -> 0x50
+        addi(R::a0, R::a0, -1),                          // 0x30
+        op_i(R::t0, R::a0, 1, 0b111),                    // 0x34: andi
+        branch(R::t0, R::zero, 8, 0b000),                // 0x38: beq -> 0x40
+        addi(R::a1, R::a1, 16),                          // 0x3c
+        bne(R::a0, R::zero, -52),                        // 0x40: -> 0x0c
+        addi(R::a7, R::zero, 10),                        // 0x44
+        ecall(),                                         // 0x48
+        ebreak(),                                        // 0x4c
+        op_r(R::a2, R::a2, R::a0, 0b000, 0b0000000),     // 0x50: subroutine
+        jalr(R::t1, R::ra, 1),                           // 0x54: lowest bit ignored
+    };
+}
+
+/// misaligned load after block was compiled
+std::vector<Code> make_hot_fault()
+{
+    using R = RegAlias;
+    return {
+        lui(R::s0, upper_of(data)),                      // 0x00
+        addi(R::a0, R::zero, iterations),                // 0x04
+        // loop:
+        op_i(R::t0, R::a0, 10, 0b010),                   // 0x08: slti, 1 if a0 < 10
+        add(R::t1, R::s0, R::t0),                        // 0x0c
+        addi(R::a1, R::a1, 1),                           // 0x10
+        lw(R::a2, R::t1, 0),                             // 0x14: fail
+        addi(R::a0, R::a0, -1),                          // 0x18
+        bne(R::a0, R::zero, -20),                        // 0x1c: -> 0x08
+        addi(R::a7, R::zero, 10),                        // 0x20
+        ecall(),                                         // 0x24
+    };
+}
+
+/// compiled block patches code
+std::vector<Code> make_hot_patch()
+{
+    using R = RegAlias;
+    const Code patched = addi(R::a0, R::a0, 100);
+    return {
+        addi(R::a0, R::zero, 0),                         // 0x00
+        addi(R::a1, R::zero, 30),                        // 0x04
+        lui(R::t0, upper_of(patched)),                   // 0x08
+        addi(R::t0, R::t0, lower_of(patched)),           // 0x0c
+        lui(R::s2, upper_of(data)),                      // 0x10
+        addi(R::t1, R::zero, 10),                        // 0x14
+        addi(R::a0, R::a0, 1),                           // 0x18: loop, patched instruction
+        addi(R::a1, R::a1, -1),                          // 0x1c
+        sw(R::t0, R::s2, 0),                             // 0x20: data, then code
+        bne(R::a1, R::t1, 8),                            // 0x24: -> 0x2c
+        addi(R::s2, R::zero, 0x18),                      // 0x28
+        bne(R::a1, R::zero, -20),                        // 0x2c: -> 0x18
+        addi(R::a7, R::zero, 10),                        // 0x30
+        ecall(),                                         // 0x34
+    };
+}
+
+int main()
+{
+    test_same_result("all operations", make_all_ops(), engine_type::jit, false);
+    test_same_result("branches", make_branches(), engine_type::jit, false);
+    test_same_result("fault in compiled code", make_hot_fault(), engine_type::jit, true);
+    test_same_result("compiled code patches itself", make_hot_patch(), engine_type::jit, false);
+    test_same_result("self modifying", make_self_modifying(), engine_type::jit, false);
+    test_same_result("fence", make_fence(), engine_type::jit, false);
+    test_same_result("csr", make_csr(), engine_type::jit, false);
+    test_register("fence", make_fence(), engine_type::jit, RegAlias::a2, 20 * 0x0c);
+    test_register("csr", make_csr(), engine_type::jit, RegAlias::a1, 0x14);
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
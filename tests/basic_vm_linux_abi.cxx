@@ -0,0 +1,240 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "rv32_program.hxx"
+#include "yeti-vm/vm_linux_abi.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using enum vm::RegAlias;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+constexpr std::uint32_t buffer = data + 0x100;
+constexpr std::uint32_t stat = data + 0x200;
+constexpr std::uint32_t heap = data + 0x10000;
+const std::string content = "hello from host file";
+
+/// guest copies input file to output file and console
+std::vector<Code> make_program()
+{
+    return {
+        lui(s0, upper_of(data)),
+        // s1 = openat(AT_FDCWD, "input.bin", O_RDONLY)
+        addi(a0, zero, -100), addi(a1, s0, 0), addi(a2, zero, 0), addi(a3, zero, 0),
+        addi(a7, zero, 56), ecall(), add(s1, a0, zero),
+        // s2 = read(s1, buffer, 64)
+        add(a0, s1, zero), addi(a1, s0, 0x100), addi(a2, zero, 64),
+        addi(a7, zero, 63), ecall(), add(s2, a0, zero),
+        // s3 = fstat(s1, stat)
+        add(a0, s1, zero), addi(a1, s0, 0x200),
+        addi(a7, zero, 80), ecall(), add(s3, a0, zero),
+        // s4 = lseek(s1, 2, SEEK_SET)
+        add(a0, s1, zero), addi(a1, zero, 2), addi(a2, zero, 0),
+        addi(a7, zero, 62), ecall(), add(s4, a0, zero),
+        // close(s1)
+        add(a0, s1, zero), addi(a7, zero, 57), ecall(),
+        // s5 = open("out.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644)
+        addi(a0, s0, 0x20), addi(a1, zero, 01101), addi(a2, zero, 0644),
+        addi(a7, zero, 1024), ecall(), add(s5, a0, zero),
+        // s6 = write(s5, buffer, s2)
+        add(a0, s5, zero), addi(a1, s0, 0x100), add(a2, s2, zero),
+        addi(a7, zero, 64), ecall(), add(s6, a0, zero),
+        // close(s5)
+        add(a0, s5, zero), addi(a7, zero, 57), ecall(),
+        // write(1, buffer, s2)
+        addi(a0, zero, 1), addi(a1, s0, 0x100), add(a2, s2, zero),
+        addi(a7, zero, 64), ecall(),
+        // s7 = open("../input.bin"), s8 = open("/etc/hostname")
+        addi(a0, s0, 0x40), addi(a1, zero, 0), addi(a7, zero, 1024), ecall(), add(s7, a0, zero),
+        addi(a0, s0, 0x60), ecall(), add(s8, a0, zero),
+        // s9 = read(9, buffer, 4)
+        addi(a0, zero, 9), addi(a1, s0, 0x100), addi(a2, zero, 4),
+        addi(a7, zero, 63), ecall(), add(s9, a0, zero),
+        // s10 = brk(0), s11 = brk(s10 + 0x100)
+        addi(a0, zero, 0), addi(a7, zero, 214), ecall(), add(s10, a0, zero),
+        addi(a0, s10, 0x100), ecall(), add(s11, a0, zero),
+        // exit(7)
+        addi(a0, zero, 7), addi(a7, zero, 93), ecall(),
+    };
+}
+
+/// write zero-terminated text into guest memory
+void put_text(vm::basic_vm& machine, std::uint32_t address, std::string_view text)
+{
+    auto view = machine.get_guest_span(address, text.size() + 1);
+    vm::ensure(view.has_value(), "unable write text");
+    std::memcpy(view->data(), text.data(), text.size());
+    (*view)[text.size()] = std::byte{0};
+}
+
+std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+/// guest reopens slots of standard streams
+std::vector<Code> make_std_slots()
+{
+    return {
+        lui(s0, upper_of(data)),
+        // close(1), s1 = open("input.bin"), s2 = close(s1)
+        addi(a0, zero, 1), addi(a7, zero, 57), ecall(),
+        addi(a0, s0, 0), addi(a1, zero, 0), addi(a7, zero, 1024), ecall(), add(s1, a0, zero),
+        add(a0, s1, zero), addi(a7, zero, 57), ecall(), add(s2, a0, zero),
+        // close(2), s3 = open("input.bin") into lowest slot 1, left opened
+        addi(a0, zero, 2), addi(a7, zero, 57), ecall(),
+        addi(a0, s0, 0), addi(a1, zero, 0), addi(a7, zero, 1024), ecall(), add(s3, a0, zero),
+        addi(a7, zero, 10), ecall(),
+    };
+}
+
+/// num of opened host files, 0 if host does not list them
+size_t count_host_files()
+{
+    std::error_code error;
+    std::filesystem::directory_iterator it{"/proc/self/fd", error};
+    if (error) return 0;
+    return static_cast<size_t>(std::distance(it, std::filesystem::directory_iterator{}));
+}
+
+/// files opened into slots 0..2 are closed by close() and by destructor
+void test_std_slots(const std::filesystem::path& root)
+{
+    const auto before = count_host_files();
+    {
+        std::stringstream output;
+        vm::console out{output};
+        vm::linux_abi abi{out, root};
+        vm::basic_vm machine;
+        vm::ensure(init_vm(machine, make_std_slots()), "std slots: unable init VM");
+        vm::ensure(abi.register_syscalls(machine), "std slots: unable register syscalls");
+        put_text(machine, data, "input.bin");
+        machine.start();
+        machine.run();
+
+        vm::ensure(machine.get_register(s1) == 1 && machine.get_register(s3) == 1, "std slots: slot is not reused");
+        vm::ensure(machine.get_register(s2) == 0, "std slots: close failed");
+        // root and file in slot 1
+        vm::ensure(count_host_files() == (before ? before + 2 : 0), "std slots: closed file is not released");
+    }
+    vm::ensure(count_host_files() == before, "std slots: file is not closed by destructor");
+}
+
+/// guest opens files through symlinks
+std::vector<Code> make_symlinks()
+{
+    return {
+        lui(s0, upper_of(data)),
+        // s1 = open("escape.txt"), s2 = open("escape/secret.txt")
+        addi(a0, s0, 0), addi(a1, zero, 0), addi(a7, zero, 1024), ecall(), add(s1, a0, zero),
+        addi(a0, s0, 0x20), ecall(), add(s2, a0, zero),
+        // s3 = open("escape.txt", O_WRONLY | O_TRUNC)
+        addi(a0, s0, 0), addi(a1, zero, 01001), ecall(), add(s3, a0, zero),
+        // s4 = open("inner/input.bin")
+        addi(a0, s0, 0x40), addi(a1, zero, 0), ecall(), add(s4, a0, zero),
+        addi(a7, zero, 10), ecall(),
+    };
+}
+
+/// symlinks to files outside of root are not opened
+void test_symlinks(const std::filesystem::path& root)
+{
+    const auto outside = root.string() + "-outside";
+    std::filesystem::create_directories(outside);
+    {
+        std::ofstream file{outside + "/secret.txt", std::ios::binary};
+        file << content;
+    }
+    std::filesystem::create_directories(root / "inner");
+    std::filesystem::copy_file(root / "input.bin", root / "inner" / "input.bin");
+    std::error_code error;
+    std::filesystem::create_symlink(outside + "/secret.txt", root / "escape.txt", error);
+    if (!error) std::filesystem::create_directory_symlink(outside, root / "escape", error);
+    if (error)
+    {
+        // host without symlinks
+        std::filesystem::remove_all(outside);
+        return;
+    }
+
+    std::stringstream output;
+    vm::console out{output};
+    vm::linux_abi abi{out, root};
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, make_symlinks()), "symlinks: unable init VM");
+    vm::ensure(abi.register_syscalls(machine), "symlinks: unable register syscalls");
+    put_text(machine, data, "escape.txt");
+    put_text(machine, data + 0x20, "escape/secret.txt");
+    put_text(machine, data + 0x40, "inner/input.bin");
+    machine.start();
+    machine.run();
+
+    auto is_error = [&](RegAlias r) { return vm::to_signed(machine.get_register(r)) < 0; };
+    vm::ensure(is_error(s1) && is_error(s2), "symlinks: file outside of root is opened");
+    vm::ensure(is_error(s3), "symlinks: file outside of root is opened for write");
+    vm::ensure(machine.get_register(s4) == 3, "symlinks: file in subdirectory is not opened");
+    vm::ensure(read_file(outside + "/secret.txt") == content, "symlinks: file outside of root is changed");
+    std::filesystem::remove_all(outside);
+}
+
+int main()
+{
+    const auto root = std::filesystem::temp_directory_path() / std::format("yeti-abi-{:08x}", std::random_device{}());
+    std::filesystem::create_directories(root);
+    {
+        std::ofstream file{root / "input.bin", std::ios::binary};
+        file << content;
+    }
+    test_std_slots(root);
+    test_symlinks(root);
+
+    std::stringstream output;
+    vm::console out{output};
+    vm::linux_abi abi{out, root};
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, make_program()), "unable init VM");
+    {
+        // write is used by console, nothing is registered
+        vm::basic_vm other;
+        vm::ensure(out.register_syscalls(other), "unable register console");
+        vm::ensure(!abi.register_syscalls(other), "used ID is registered");
+        vm::ensure(other.get_syscalls().find_entry(vm::linux_abi::openat_id) == nullptr, "syscall is registered partially");
+    }
+    vm::ensure(abi.register_syscalls(machine), "unable register syscalls");
+    abi.set_heap(heap, heap + 0x1000);
+    put_text(machine, data, "input.bin");
+    put_text(machine, data + 0x20, "out.txt");
+    put_text(machine, data + 0x40, "../input.bin");
+    put_text(machine, data + 0x60, "/etc/hostname");
+    machine.start();
+    machine.run();
+
+    auto reg = [&](RegAlias r) { return machine.get_register(r); };
+    auto error = [](std::int32_t code) { return static_cast<vm::register_t>(-code); };
+    vm::ensure(reg(s1) == 3, "open: lowest free fd expected");
+    vm::ensure(reg(s2) == content.size(), "read: wrong size");
+    vm::ensure(reg(s3) == 0, "fstat: failed");
+    std::int64_t size = 0;
+    std::memcpy(&size, machine.get_guest_span(stat + 48, sizeof(size))->data(), sizeof(size));
+    vm::ensure(size == static_cast<std::int64_t>(content.size()), "fstat: wrong size");
+    vm::ensure(reg(s4) == 2, "lseek: wrong offset");
+    vm::ensure(reg(s5) == 3, "open: closed fd is not reused");
+    vm::ensure(reg(s6) == content.size(), "write: wrong size");
+    vm::ensure(reg(s7) == error(13) && reg(s8) == error(13), "open: path outside of root is opened");
+    vm::ensure(reg(s9) == error(9), "read: bad fd");
+    vm::ensure(reg(s10) == heap && reg(s11) == heap + 0x100, "brk: wrong break");
+    vm::ensure(abi.is_exited() && abi.get_exit_code() == 7, "exit: wrong code");
+
+    vm::ensure(read_file(root / "out.txt") == content, "write: wrong file content");
+    vm::ensure(output.str() == content, "write: wrong console output");
+    std::filesystem::remove_all(root);
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+
+void test_self_modifying(bool predecode)
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, make_self_modifying()), "unable init VM");
+    machine.enable_predecode(predecode);
+    machine.start();
+    machine.run();
+    auto result = machine.get_register(RegAlias::a0);
+    vm::ensure(result == 101, std::format("predecode = {}: a0 = {}, expected 101", predecode, result));
+}
+
+/// run program with cache directory, report cache hit
+bool run_cached(const std::filesystem::path& directory, const std::vector<Code>& program,
+                vm::basic_vm::engine_type engine, std::string_view name)
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, program), "unable init VM");
+    machine.enable_predecode(true);
+    machine.set_decode_cache(directory);
+    machine.set_engine(engine);
+    machine.start();
+    const bool hit = machine.is_decode_cache_hit();
+    machine.run();
+    auto result = machine.get_register(RegAlias::a0);
+    vm::ensure(result == 101, std::format("{}: a0 = {}, expected 101", name, result));
+    return hit;
+}
+
+/// cache file is created on first start, reused later and rebuilt if it is stale
+void test_file_cache(vm::basic_vm::engine_type engine)
+{
+    const auto directory = std::filesystem::temp_directory_path()
+            / std::format("yeti-predecode-{:08x}", std::random_device{}());
+    const auto program = make_self_modifying();
+    const auto name = std::format("{}", static_cast<int>(engine));
+
+    vm::ensure(!run_cached(directory, program, engine, name + "/miss"), name + ": hit in empty directory");
+    vm::ensure(run_cached(directory, program, engine, name + "/hit"), name + ": cache file is not used");
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry: std::filesystem::directory_iterator{directory})
+    {
+        files.push_back(entry.path());
+    }
+    vm::ensure(files.size() == 1, name + ": expected one cache file");
+
+    // broken record: code of first slot
+    {
+        std::fstream file{files[0], std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(48);
+        file.put('\x55');
+    }
+    vm::ensure(!run_cached(directory, program, engine, name + "/broken"), name + ": broken file is used");
+    vm::ensure(run_cached(directory, program, engine, name + "/rebuilt"), name + ": broken file is not rebuilt");
+
+    // other handler for same code of first slot
+    {
+        std::fstream file{files[0], std::ios::binary | std::ios::in | std::ios::out};
+        std::uint16_t handler = 0;
+        file.seekg(52);
+        file.read(reinterpret_cast<char*>(&handler), sizeof(handler));
+        vm::ensure(handler != 0, name + ": first slot is not cached");
+        handler = (handler == 1) ? 2 : 1;
+        file.seekp(52);
+        file.write(reinterpret_cast<const char*>(&handler), sizeof(handler));
+    }
+    vm::ensure(!run_cached(directory, program, engine, name + "/handler"), name + ": wrong handler is used");
+    vm::ensure(run_cached(directory, program, engine, name + "/handler rebuilt"), name + ": file with wrong handler is not rebuilt");
+
+    // truncated file
+    std::filesystem::resize_file(files[0], 40);
+    vm::ensure(!run_cached(directory, program, engine, name + "/truncated"), name + ": truncated file is used");
+    vm::ensure(run_cached(directory, program, engine, name + "/restored"), name + ": truncated file is not rebuilt");
+
+    // other program gets own file
+    auto other = program;
+    other.push_back(ebreak());
+    vm::ensure(!run_cached(directory, other, engine, name + "/other"), name + ": file of other program is used");
+    vm::ensure(std::distance(std::filesystem::directory_iterator{directory}, {}) == 2, name + ": expected two cache files");
+
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    test_self_modifying(false);
+    test_self_modifying(true);
+    for (auto engine: {vm::basic_vm::engine_type::interpreter, vm::basic_vm::engine_type::blocks})
+    {
+        test_file_cache(engine);
+    }
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
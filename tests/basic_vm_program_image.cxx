@@ -0,0 +1,110 @@
+#include <fstream>
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+
+/// VM with program mapped from image
+/// each VM patches own copy of shared code
+void test_private_code(engine_type engine)
+{
+    const auto program = to_binary(make_self_modifying());
+    const auto image = vm::program_image::create(program);
+    vm::ensure(image != nullptr, "unable create image");
+
+    for (int i = 0; i < 3; ++i)
+    {
+        fixture vm{*image, engine};
+        vm.machine.run();
+        vm::ensure(vm.machine.get_register(RegAlias::a0) == 101,
+                   std::format("{}/{}: a0 = {}, patch of other VM is visible", static_cast<int>(engine), i,
+                               vm.machine.get_register(RegAlias::a0)));
+    }
+    const auto content = image->get_data();
+    vm::ensure(std::equal(content.begin(), content.end(), program.begin(), program.end()), "image is modified");
+}
+
+/// initialized data is shared until first store
+void test_data_section()
+{
+    const std::vector<std::uint8_t> values{0x10, 0, 0, 0};
+    const auto section = vm::program_image::create(values);
+    const auto code = vm::program_image::create(to_binary({
+        lui(RegAlias::s0, upper_of(data)),               // 0x00
+        lw(RegAlias::a0, RegAlias::s0, 0),               // 0x04
+        addi(RegAlias::a0, RegAlias::a0, 1),             // 0x08
+        sw(RegAlias::a0, RegAlias::s0, 0),               // 0x0c
+        lw(RegAlias::a1, RegAlias::s0, 0),               // 0x10
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x14
+        ecall(),                                         // 0x18
+    }));
+    vm::ensure(section && code, "unable create image");
+
+    fixture first{*code, engine_type::interpreter};
+    fixture second{*code, engine_type::interpreter};
+    vm::ensure(first.machine.load_image(*section, data), "first: unable load data");
+    vm::ensure(second.machine.load_image(*section, data), "second: unable load data");
+    first.machine.run();
+    second.machine.run();
+    for (auto* machine: {&first.machine, &second.machine})
+    {
+        vm::ensure(machine->get_register(RegAlias::a0) == 0x11, "data: wrong loaded value");
+        vm::ensure(machine->get_register(RegAlias::a1) == 0x11, "data: store is not visible");
+    }
+    vm::ensure(section->get_data()[0] == 0x10, "data: image is modified");
+
+    // image does not fit into block
+    vm::ensure(!first.machine.load_image(*section, data + vm::basic_vm::def_data_size - 2), "data: out of range");
+}
+
+/// binary file is mapped without copies, VM does not modify file
+void test_file()
+{
+    const auto program = to_binary(make_self_modifying());
+    const auto path = std::filesystem::temp_directory_path() / std::format("yeti-image-{}.bin", program.size());
+    {
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(program.data()), static_cast<std::streamsize>(program.size()));
+        vm::ensure(file.good(), "file: unable write program");
+    }
+
+    {
+        const auto image = vm::program_image::open(path);
+        vm::ensure(image != nullptr, "file: unable open image");
+        vm::ensure(image->get_size() == program.size(), "file: wrong size");
+        vm::ensure(image->get_mapped_size() >= image->get_size(), "file: wrong mapped size");
+
+        for (auto engine: {engine_type::interpreter, engine_type::jit})
+        {
+            fixture vm{*image, engine};
+            vm.machine.run();
+            vm::ensure(vm.machine.get_register(RegAlias::a0) == 101, "file: wrong result");
+        }
+        const auto content = image->get_data();
+        vm::ensure(std::equal(content.begin(), content.end(), program.begin(), program.end()), "file: image is modified");
+    }
+    const auto stored = vm::load_program(path);
+    vm::ensure(stored && stored.value() == program, "file: file is modified");
+    std::filesystem::remove(path);
+
+    vm::ensure(vm::program_image::open(path) == nullptr, "file: missing file is opened");
+    vm::ensure(vm::program_image::open(path.parent_path()) == nullptr, "file: directory is opened");
+}
+
+int main()
+{
+    for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+    {
+        test_private_code(engine);
+    }
+    test_data_section();
+    test_file();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+using stop_reason = vm::basic_vm::stop_reason;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+constexpr std::uint64_t unlimited = std::numeric_limits<std::uint64_t>::max();
+
+/// loop of 50 iterations, 257 instructions
+std::vector<Code> make_loop()
+{
+    constexpr Code constant = 0x12345678;
+    return {
+        lui(RegAlias::s0, upper_of(data)),                       // 0x00
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x04
+        addi(RegAlias::a1, RegAlias::zero, 50),                  // 0x08
+        lui(RegAlias::t0, upper_of(constant)),                   // 0x0c
+        addi(RegAlias::t0, RegAlias::t0, lower_of(constant)),    // 0x10
+        add(RegAlias::a0, RegAlias::a0, RegAlias::t0),           // 0x14: loop
+        sw(RegAlias::a0, RegAlias::s0, 0),                       // 0x18
+        addi(RegAlias::a1, RegAlias::a1, -1),                    // 0x1c
+        slt(RegAlias::t1, RegAlias::zero, RegAlias::a1),         // 0x20
+        bne(RegAlias::t1, RegAlias::zero, -16),                  // 0x24: -> 0x14
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x28
+        ecall(),                                                 // 0x2c
+    };
+}
+constexpr std::uint64_t loop_size = 5 + 5 * 50 + 2;
+
+std::string name_of(engine_type engine, std::string_view test)
+{
+    return std::format("{}/{}", static_cast<int>(engine), test);
+}
+
+/// whole program in one call
+void test_unlimited(engine_type engine)
+{
+    const auto name = name_of(engine, "unlimited");
+    fixture vm{make_loop(), engine};
+    auto result = vm.machine.run_for(unlimited);
+    vm::ensure(result.reason == stop_reason::halt, name + ": halt expected");
+    vm::ensure(result.executed == loop_size, std::format("{}: executed {}, expected {}", name, result.executed, loop_size));
+}
+
+/// program is executed by small slices
+void test_slices(engine_type engine, std::uint64_t slice)
+{
+    const auto name = name_of(engine, std::format("slice {}", slice));
+    fixture vm{make_loop(), engine};
+
+    vm::ensure(vm.machine.run_for(0).executed == 0, name + ": zero budget");
+
+    std::uint64_t total = 0;
+    while (true)
+    {
+        auto result = vm.machine.run_for(slice);
+        vm::ensure(result.executed <= slice, name + ": budget exceeded");
+        total += result.executed;
+        if (result.reason == stop_reason::halt) break;
+        vm::ensure(result.reason == stop_reason::budget, name + ": budget expected");
+        vm::ensure(result.executed == slice, name + ": budget is not used");
+    }
+    vm::ensure(total == loop_size, std::format("{}: executed {}, expected {}", name, total, loop_size));
+    vm::ensure(vm.machine.get_register(RegAlias::a0) == vm::register_t(50 * 0x12345678u), name + ": wrong result");
+}
+
+/// run_for() stops after ebreak
+void test_breakpoint(engine_type engine)
+{
+    const auto name = name_of(engine, "breakpoint");
+    fixture vm{{
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x00
+        addi(RegAlias::a0, RegAlias::a0, 1),                     // 0x04
+        ebreak(),                                                // 0x08
+        addi(RegAlias::a0, RegAlias::a0, 1),                     // 0x0c
+        ebreak(),                                                // 0x10
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x14
+        ecall(),                                                 // 0x18
+    }, engine};
+
+    auto result = vm.machine.run_for(100);
+    vm::ensure(result.reason == stop_reason::breakpoint && result.executed == 3, name + ": first break");
+    vm::ensure(vm.machine.get_pc() == 0x0c && vm.machine.get_register(RegAlias::a0) == 1, name + ": first state");
+    result = vm.machine.run_for(100);
+    vm::ensure(result.reason == stop_reason::breakpoint && result.executed == 2, name + ": second break");
+    vm::ensure(vm.machine.get_pc() == 0x14 && vm.machine.get_register(RegAlias::a0) == 2, name + ": second state");
+    result = vm.machine.run_for(100);
+    vm::ensure(result.reason == stop_reason::halt && result.executed == 2, name + ": halt");
+}
+
+/// run_for() reports trap, faulting instruction is not counted
+void test_trap(engine_type engine)
+{
+    const auto name = name_of(engine, "trap");
+    fixture vm{{
+        lui(RegAlias::s0, upper_of(data)),                       // 0x00
+        addi(RegAlias::a0, RegAlias::zero, 1),                   // 0x04
+        lw(RegAlias::a1, RegAlias::s0, 2),                       // 0x08: misaligned
+    }, engine};
+
+    auto result = vm.machine.run_for(100);
+    vm::ensure(result.reason == stop_reason::trap, name + ": trap expected");
+    vm::ensure(result.fault.cause == vm::trap_cause::misaligned_load, name + ": wrong cause");
+    vm::ensure(result.executed == 2, std::format("{}: executed {}, expected 2", name, result.executed));
+}
+
+/// fault of load at start of compiled block, loads before it are retired
+void test_block_fault(engine_type engine)
+{
+    const auto name = name_of(engine, "block fault");
+    fixture vm{{
+        lui(RegAlias::s0, upper_of(data)),                       // 0x00
+        addi(RegAlias::s1, RegAlias::s0, 0),                     // 0x04
+        addi(RegAlias::a1, RegAlias::zero, 20),                  // 0x08
+        lw(RegAlias::t2, RegAlias::s1, 0),                       // 0x0c: loop
+        addi(RegAlias::a1, RegAlias::a1, -1),                    // 0x10
+        bne(RegAlias::a1, RegAlias::zero, -8),                   // 0x14: -> 0x0c
+        lui(RegAlias::s1, upper_of(0x10000000)),                 // 0x18: outside of memory
+        jal(RegAlias::zero, -16),                                // 0x1c: -> 0x0c
+    }, engine};
+
+    constexpr std::uint64_t expected = 3 + 20 * 3 + 2;
+    auto result = vm.machine.run_for(1000);
+    vm::ensure(result.reason == stop_reason::trap, name + ": trap expected");
+    vm::ensure(result.fault.pc == 0x0c, name + ": wrong PC of trap");
+    vm::ensure(result.executed == expected, std::format("{}: executed {}, expected {}", name, result.executed, expected));
+}
+
+int main()
+{
+    for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+    {
+        test_unlimited(engine);
+        test_slices(engine, 1);
+        test_slices(engine, 7);
+        test_slices(engine, 64);
+        test_breakpoint(engine);
+        test_trap(engine);
+        test_block_fault(engine);
+    }
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
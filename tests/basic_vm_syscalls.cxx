@@ -0,0 +1,165 @@
+#include <cstring>
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using trap_cause = vm::trap_cause;
+using engine_type = vm::basic_vm::engine_type;
+
+constexpr std::uint32_t data = vm::basic_vm::def_data_base;
+
+/// counters of calls
+struct counters
+{
+    int table = 0;
+    int sparse = 0;
+    int functor = 0;
+};
+
+void count_table(vm::vm_interface* m, void* context)
+{
+    static_cast<counters*>(context)->table += 1;
+    m->set_register(RegAlias::a0, m->get_register(RegAlias::a0) + 1);
+}
+
+void count_sparse(vm::vm_interface* m, void* context)
+{
+    static_cast<counters*>(context)->sparse += 1;
+    m->set_register(RegAlias::a0, m->get_register(RegAlias::a0) + 10);
+}
+
+/// register calls in flat table, in sparse map and functor
+fixture::setup_fn make_setup(counters& calls)
+{
+    return [&calls](vm::basic_vm& machine) {
+        auto& sys = machine.get_syscalls();
+        bool ok = sys.register_handler(1, "table", count_table, &calls);
+        ok = ok && sys.register_handler(1024, "sparse", count_sparse, &calls);
+        ok = ok && sys.register_handler(vm::syscall_functor::create(255, "functor", [&calls](vm::vm_interface* m) {
+            calls.functor += 1;
+            m->set_register(RegAlias::a0, m->get_register(RegAlias::a0) + 100);
+        }));
+        vm::ensure(ok, "unable register syscalls");
+    };
+}
+
+void test_dispatch()
+{
+    counters calls;
+    fixture vm{{
+        addi(RegAlias::a0, RegAlias::zero, 0),           // 0x00
+        addi(RegAlias::a7, RegAlias::zero, 1),           // 0x04
+        ecall(),                                         // 0x08
+        ecall(),                                         // 0x0c
+        addi(RegAlias::a7, RegAlias::zero, 1024),        // 0x10
+        ecall(),                                         // 0x14
+        addi(RegAlias::a7, RegAlias::zero, 255),         // 0x18
+        ecall(),                                         // 0x1c
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x20
+        ecall(),                                         // 0x24
+    }, engine_type::interpreter, make_setup(calls)};
+    vm.machine.run();
+    vm::ensure(calls.table == 2 && calls.sparse == 1 && calls.functor == 1, "dispatch: wrong num of calls");
+    vm::ensure(vm.machine.get_register(RegAlias::a0) == 112, "dispatch: wrong result");
+
+    const auto& sys = vm.machine.get_syscalls();
+    vm::ensure(sys.find_handler(1024) && sys.find_handler(1024)->get_name() == "sparse", "dispatch: sparse handler");
+    vm::ensure(sys.find_entry(2) == nullptr && sys.find_entry(1025) == nullptr, "dispatch: unknown entry");
+}
+
+void test_unknown()
+{
+    for (vm::register_t id: {2u, 1025u})
+    {
+        counters calls;
+        fixture vm{{
+            addi(RegAlias::a7, RegAlias::zero, static_cast<std::int32_t>(id)),   // 0x00
+            ecall(),                                                              // 0x04
+        }, engine_type::interpreter, make_setup(calls)};
+        auto info = vm.machine.run_until_trap();
+        vm::ensure(info.cause == trap_cause::unknown_syscall && info.address == id,
+                   std::format("unknown {}: trap expected", id));
+    }
+
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, std::vector<Code>{}), "unable init VM");
+    bool duplicate = false;
+    try
+    {
+        [[maybe_unused]] bool ok = machine.get_syscalls().register_handler(10, "other exit", count_table);
+    }
+    catch (std::domain_error&)
+    {
+        duplicate = true;
+    }
+    vm::ensure(duplicate, "duplicate: ID is registered twice");
+    vm::ensure(machine.get_syscalls().find_handler(10)->get_name() == "exit", "duplicate: handler is replaced");
+}
+
+/// views are bounded by block
+void test_span_bounds()
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, std::vector<Code>{}), "unable init VM");
+    const auto& ro = machine;
+
+    auto view = machine.get_guest_span(data + 16, 64);
+    vm::ensure(view && view->size() == 64, "bounds: view inside of block");
+    std::memset(view->data(), 0x5a, view->size());
+    vm::register_t value = 0;
+    machine.read_memory(data + 16 + 60, sizeof(value), value);
+    vm::ensure(value == 0x5a5a5a5a, "bounds: write through view");
+    vm::ensure(ro.get_guest_span(data + 16, 64)->data() == view->data(), "bounds: read-only view");
+
+    vm::ensure(machine.get_guest_span(data + 16, 0).has_value(), "bounds: empty view");
+    vm::ensure(!machine.get_guest_span(data - 4, 8), "bounds: view crosses blocks");
+    vm::ensure(!ro.get_guest_span(data + vm::basic_vm::def_data_size - 4, 8), "bounds: view after last block");
+    vm::ensure(!machine.get_guest_span(0x10000000, 4), "bounds: unmapped view");
+}
+
+/// syscall writes code through view, stale code is dropped
+void test_span_code(engine_type engine, bool predecode)
+{
+    const Code patched = addi(RegAlias::a0, RegAlias::a0, 100);
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, {
+        addi(RegAlias::a0, RegAlias::zero, 0),           // 0x00
+        addi(RegAlias::s1, RegAlias::zero, 0),           // 0x04
+        addi(RegAlias::a0, RegAlias::a0, 1),             // 0x08: patched instruction
+        bne(RegAlias::s1, RegAlias::zero, 20),           // 0x0c: -> 0x20
+        addi(RegAlias::s1, RegAlias::zero, 1),           // 0x10
+        addi(RegAlias::a7, RegAlias::zero, 100),         // 0x14
+        ecall(),                                         // 0x18: patch
+        jal(RegAlias::zero, -20),                        // 0x1c: -> 0x08
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x20
+        ecall(),                                         // 0x24
+    }), "unable init VM");
+    vm::ensure(machine.get_syscalls().register_handler(vm::syscall_functor::create(100, "patch", [&](vm::vm_interface*) {
+        auto view = machine.get_guest_span(0x08, sizeof(patched));
+        vm::ensure(view.has_value(), "code: unable get view");
+        std::memcpy(view->data(), &patched, sizeof(patched));
+    })), "unable register patch");
+    machine.set_engine(engine);
+    machine.enable_predecode(predecode);
+    machine.start();
+    machine.run();
+    auto result = machine.get_register(RegAlias::a0);
+    vm::ensure(result == 101, std::format("code {}/{}: a0 = {}, expected 101", static_cast<int>(engine), predecode, result));
+}
+
+int main()
+{
+    test_dispatch();
+    test_unknown();
+    test_span_bounds();
+    for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+    {
+        test_span_code(engine, false);
+        test_span_code(engine, true);
+    }
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
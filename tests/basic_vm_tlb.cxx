@@ -0,0 +1,100 @@
+#include <iostream>
+
+#include "device_memory.hxx"
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+using tests::device_memory;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+/// page with same TLB entry as first page of data
+constexpr std::int32_t conflict = data + vm::memory_tlb::entries_count * vm::memory_management_unit::page_size;
+constexpr std::int32_t device = 0x2000'0000;
+constexpr vm::register_t device_value = 0x11223344;
+
+/// loop of 10 iterations: load from s0, load from s1, store to s0
+std::vector<Code> make_loop(std::int32_t first, std::int32_t second)
+{
+    return {
+        lui(RegAlias::s0, upper_of(first)),                      // 0x00
+        addi(RegAlias::s0, RegAlias::s0, lower_of(first)),       // 0x04
+        lui(RegAlias::s1, upper_of(second)),                     // 0x08
+        addi(RegAlias::s1, RegAlias::s1, lower_of(second)),      // 0x0c
+        addi(RegAlias::a1, RegAlias::zero, 10),                  // 0x10
+        addi(RegAlias::a0, RegAlias::zero, 0),                   // 0x14
+        lw(RegAlias::t0, RegAlias::s0, 0),                       // 0x18: loop
+        lw(RegAlias::t1, RegAlias::s1, 4),                       // 0x1c
+        add(RegAlias::a0, RegAlias::a0, RegAlias::t1),           // 0x20
+        sw(RegAlias::a0, RegAlias::s0, 0),                       // 0x24
+        addi(RegAlias::a1, RegAlias::a1, -1),                    // 0x28
+        bne(RegAlias::a1, RegAlias::zero, -20),                  // 0x2c: -> 0x18
+        addi(RegAlias::a7, RegAlias::zero, 10),                  // 0x30
+        ecall(),                                                 // 0x34
+    };
+}
+
+/// check TLB counters of VM
+void check(const vm::basic_vm& machine, std::string_view name, std::uint64_t hits, std::uint64_t misses)
+{
+    const auto& stats = machine.get_tlb_stats();
+    vm::ensure(stats.hits == hits, std::format("{}: {} hits, expected {}", name, stats.hits, hits));
+    vm::ensure(stats.misses == misses, std::format("{}: {} misses, expected {}", name, stats.misses, misses));
+}
+
+void test_engine(engine_type engine)
+{
+    const auto prefix = std::format("{}/", static_cast<int>(engine));
+    const auto dev = std::make_shared<device_memory>(device, 0x1000, device_value);
+    const auto add_device = [&dev](vm::basic_vm& machine) {
+        vm::ensure(machine.add_memory(dev), "unable add device");
+    };
+    {
+        // one page: only first access misses
+        fixture vm{make_loop(data, data + 64), engine, add_device};
+        vm.machine.run();
+        check(vm.machine, prefix + "same page", 29, 1);
+        vm::ensure(vm.machine.get_register(RegAlias::a0) == 0, prefix + "same page: wrong result");
+    }
+    {
+        // two pages in different entries
+        fixture vm{make_loop(data, data + 0x1000), engine, add_device};
+        vm.machine.run();
+        check(vm.machine, prefix + "two pages", 28, 2);
+    }
+    {
+        // pages evict each other
+        fixture vm{make_loop(data, conflict), engine, add_device};
+        vm.machine.run();
+        check(vm.machine, prefix + "conflict", 9, 21);
+    }
+    {
+        // device is never cached, all loads see value of device
+        fixture vm{make_loop(device, device), engine, add_device};
+        vm.machine.run();
+        check(vm.machine, prefix + "device", 0, 30);
+        vm::ensure(dev->stores == 10, prefix + "device: stores are lost");
+        vm::ensure(vm.machine.get_register(RegAlias::a0) == 10 * device_value, prefix + "device: wrong result");
+    }
+}
+
+int main()
+{
+    for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+    {
+        test_engine(engine);
+    }
+
+    // counters are reset by start()
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, make_loop(data, data)), "unable init VM");
+    machine.start();
+    machine.run();
+    vm::ensure(machine.get_tlb_stats().hits != 0, "restart: hits expected");
+    machine.start();
+    vm::ensure(machine.get_tlb_stats().hits == 0 && machine.get_tlb_stats().misses == 0, "restart: counters are not reset");
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+
+#include "rv32_program.hxx"
+
+using namespace tests::rv32_program;
+using vm::RegAlias;
+using engine_type = vm::basic_vm::engine_type;
+using vm::trap_cause;
+
+constexpr std::int32_t data = vm::basic_vm::def_data_base;
+
+void check_trap(std::string_view name, const vm::trap& actual, trap_cause cause, vm::register_t address, vm::register_t pc)
+{
+    vm::ensure(actual.cause == cause,
+               std::format("{}: cause {}, expected {}", name, vm::get_name(actual.cause), vm::get_name(cause)));
+    vm::ensure(actual.address == address, std::format("{}: address {:08x}, expected {:08x}", name, actual.address, address));
+    vm::ensure(actual.pc == pc, std::format("{}: pc {:08x}, expected {:08x}", name, actual.pc, pc));
+}
+
+/// each kind of trap stops VM at faulting instruction without side effects
+void test_causes(engine_type engine)
+{
+    {
+        fixture vm{{
+            lui(RegAlias::s0, upper_of(data)),           // 0x00
+            addi(RegAlias::a1, RegAlias::zero, 5),       // 0x04
+            lw(RegAlias::a1, RegAlias::s0, 2),           // 0x08: misaligned
+            addi(RegAlias::a7, RegAlias::zero, 10),      // 0x0c
+            ecall(),                                     // 0x10
+        }, engine};
+        auto result = vm.machine.run_until_trap();
+        check_trap("misaligned load", result, trap_cause::misaligned_load, data + 2, 0x08);
+        vm::ensure(vm.machine.get_pc() == 0x08, "misaligned load: PC changed");
+        vm::ensure(vm.machine.get_register(RegAlias::a1) == 5, "misaligned load: rd changed");
+        vm::ensure(vm.machine.is_running(), "misaligned load: VM stopped");
+
+        // emulate access and resume
+        vm.machine.set_pc(result.pc + sizeof(Code));
+        vm::ensure(!vm.machine.run_until_trap(), "misaligned load: resume failed");
+        vm::ensure(!vm.machine.is_running(), "misaligned load: VM is not halted");
+    }
+    {
+        fixture vm{{
+            addi(RegAlias::s0, RegAlias::zero, -16),     // 0x00
+            sw(RegAlias::s0, RegAlias::s0, 0),           // 0x04: out of range
+            ecall(),                                     // 0x08
+        }, engine};
+        check_trap("store access", vm.machine.run_until_trap(), trap_cause::store_access, 0xfffffff0, 0x04);
+    }
+    {
+        fixture vm{{
+            addi(RegAlias::a0, RegAlias::zero, 1),       // 0x00
+            jal(RegAlias::ra, 6),                        // 0x04: misaligned target
+            ecall(),                                     // 0x08
+        }, engine};
+        check_trap("misaligned jump", vm.machine.run_until_trap(), trap_cause::misaligned_jump, 0x0a, 0x04);
+        vm::ensure(vm.machine.get_pc() == 0x04, "misaligned jump: PC changed");
+    }
+    {
+        fixture vm{{
+            addi(RegAlias::a0, RegAlias::zero, 1),       // 0x00
+            0xffffffff,                                  // 0x04: illegal
+        }, engine};
+        check_trap("illegal instruction", vm.machine.run_until_trap(), trap_cause::illegal_instruction, 0xffffffff, 0x04);
+    }
+    {
+        fixture vm{{
+            addi(RegAlias::a7, RegAlias::zero, 99),      // 0x00
+            ecall(),                                     // 0x04: unknown syscall
+        }, engine};
+        check_trap("unknown syscall", vm.machine.run_until_trap(), trap_cause::unknown_syscall, 99, 0x04);
+    }
+}
+
+/// host emulates misaligned loads in hot loop
+void test_emulation(engine_type engine)
+{
+    fixture vm{{
+        lui(RegAlias::s0, upper_of(data)),               // 0x00
+        addi(RegAlias::a0, RegAlias::zero, 40),          // 0x04
+        addi(RegAlias::a1, RegAlias::zero, 0),           // 0x08
+        lw(RegAlias::t0, RegAlias::s0, 1),               // 0x0c: loop, misaligned
+        add(RegAlias::a1, RegAlias::a1, RegAlias::t0),   // 0x10
+        addi(RegAlias::a0, RegAlias::a0, -1),            // 0x14
+        bne(RegAlias::a0, RegAlias::zero, -12),          // 0x18: -> 0x0c
+        addi(RegAlias::a7, RegAlias::zero, 10),          // 0x1c
+        ecall(),                                         // 0x20
+    }, engine};
+
+    size_t count = 0;
+    while (auto result = vm.machine.run_until_trap())
+    {
+        check_trap("emulation", result, trap_cause::misaligned_load, data + 1, 0x0c);
+        vm.machine.set_register(RegAlias::t0, 3);
+        vm.machine.set_pc(result.pc + sizeof(Code));
+        ++count;
+    }
+    vm::ensure(count == 40, std::format("emulation: {} traps, expected 40", count));
+    vm::ensure(vm.machine.get_register(RegAlias::a1) == 120, "emulation: wrong result");
+}
+
+/// run_step() returns trap, run() throws
+void test_wrappers()
+{
+    const std::vector<Code> program{
+        lui(RegAlias::s0, upper_of(data)),               // 0x00
+        lw(RegAlias::a1, RegAlias::s0, 2),               // 0x04: misaligned
+    };
+    {
+        fixture vm{program, engine_type::interpreter};
+        vm::ensure(!vm.machine.run_step(), "step: unexpected trap");
+        auto result = vm.machine.run_step();
+        check_trap("step", result, trap_cause::misaligned_load, data + 2, 0x04);
+        vm::ensure(!result.get_message().empty(), "step: empty message");
+    }
+    {
+        fixture vm{program, engine_type::interpreter};
+        bool thrown = false;
+        try
+        {
+            vm.machine.run();
+        }
+        catch (vm::basic_vm::data_access_error&)
+        {
+            thrown = true;
+        }
+        vm::ensure(thrown, "run: data_access_error is expected");
+    }
+}
+
+int main()
+{
+    for (auto engine: {engine_type::interpreter, engine_type::blocks, engine_type::jit})
+    {
+        test_causes(engine);
+        test_emulation(engine);
+    }
+    test_wrappers();
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
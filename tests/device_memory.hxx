@@ -0,0 +1,55 @@
+/// MMIO block for memory tests
+#pragma once
+
+#include <yeti-vm/vm_base_types.hxx>
+#include <yeti-vm/vm_memory.hxx>
+
+#include <algorithm>
+#include <cstring>
+
+namespace tests
+{
+
+/**
+ * block without host memory
+ *
+ * each load returns constant, stores are counted and dropped
+ */
+struct device_memory: vm::memory_block
+{
+    /// value of each load
+    vm::register_t value;
+    /// num of stores
+    size_t stores = 0;
+
+    device_memory(address_type address, size_type size, vm::register_t value = 0xffff'ffff)
+        : vm::memory_block(address, size)
+        , value{value}
+    {}
+
+    bool load(address_type, void *dest, size_type size) const override
+    {
+        std::memset(dest, 0, size);
+        std::memcpy(dest, &value, std::min<size_type>(size, sizeof(value)));
+        return true;
+    }
+
+    bool store(address_type, const void *, size_type) override
+    {
+        ++stores;
+        return true;
+    }
+
+protected:
+    const void * get_ro(address_type, size_type) const override
+    {
+        return nullptr;
+    }
+
+    void * get_rw(address_type, size_type) override
+    {
+        return nullptr;
+    }
+};
+
+} // namespace tests
@@ -50,6 +50,130 @@ R"(
     ensure(data.back().is_eof(), "should back().is_eof() == true");
 }
 
+/// records are stored in flat form with resolved addresses
+void test_flat_file()
+{
+    std::stringstream stream;
+    stream <<
+        ":020000040040BA\n"
+        ":0400100001020304E2\n"
+        ":0400140005060708CE\n"
+        ":0400140005060708CF\n"
+        ":00000001FF\n";
+    auto result = vm::parse_hex(stream);
+    ensure(result.has_value(), "flat: should return parsed data");
+    const auto& hex = result.value();
+
+    ensure(hex.size() == 5, "flat: should size() == 5");
+    ensure(hex.get_payload().size() == 2 + 4 * 3, "flat: wrong payload size");
+    ensure(hex.get_address(1) == 0x00400010 && hex.get_address(2) == 0x00400014, "flat: wrong address");
+    ensure(hex[1].data.data() + 4 == hex[2].data.data(), "flat: payload is not contiguous");
+    ensure(hex[2].data[3] == 0x08, "flat: wrong data");
+    ensure(hex[2].is_valid() && !hex[3].is_valid(), "flat: checksum is lost");
+
+    size_t count = 0;
+    for (auto record: hex)
+    {
+        ensure(record.count == record.data.size(), "flat: wrong count");
+        ++count;
+    }
+    ensure(count == hex.size(), "flat: wrong iteration");
+}
+
+/// vectorized decoder is same as per digit decoder for all chars at all positions
+void test_decoder()
+{
+    const std::string_view digits = "0123456789abcdefABCDEF";
+    std::string hex = "0123456789abcdefABCDEF0123";
+    std::vector<uint8_t> bytes(hex.size() / 2);
+    ensure(vm::from_hex(hex, bytes.data()), "decoder: valid digits are rejected");
+    ensure(bytes == vm::from_hex(hex), "decoder: wrong result");
+
+    for (size_t pos = 0; pos < hex.size(); ++pos)
+    {
+        const auto saved = hex[pos];
+        for (int c = 0; c < 256; ++c)
+        {
+            hex[pos] = static_cast<char>(c);
+            const bool is_digit = digits.find(static_cast<char>(c)) != std::string_view::npos;
+            ensure(vm::from_hex(hex, bytes.data()) == is_digit,
+                   std::format("decoder: char {:02x} at {}, expected {}", c, pos, is_digit));
+            if (is_digit)
+            {
+                ensure(bytes == vm::from_hex(hex), std::format("decoder: wrong value of char {:02x} at {}", c, pos));
+            }
+        }
+        hex[pos] = saved;
+    }
+}
+
+/// records are passed to sink without intermediate storage
+void test_streaming()
+{
+    const std::string text =
+        ":10010000214601360121470136007EFE09D2190140\r\n"
+        "garbage line\r\n"
+        ":0400000300003800C1\r\n"
+        ":00000001FF\r\n"
+        ":10010000214601360121470136007EFE09D2190140\r\n";
+    size_t count = 0;
+    bool ok = vm::parse_hex(text, [&count](const vm::hex_record_view& record) {
+        ensure(record.is_valid(), std::format("streaming: record {} is not valid", count));
+        ++count;
+        return true;
+    });
+    ensure(ok && count == 3, "streaming: records after EOF should be skipped");
+
+    ensure(!vm::parse_hex(":10010000214601360121470136007EFE09D21901\n", [](auto&) { return true; }),
+           "streaming: short record should be rejected");
+    ensure(!vm::parse_hex(":100100002146013601214701360X7EFE09D2190140\n", [](auto&) { return true; }),
+           "streaming: not hex digit should be rejected");
+    ensure(!vm::parse_hex(text, [](auto&) { return false; }), "streaming: sink should stop parsing");
+
+    // bad checksum is reported by record
+    ok = vm::parse_hex(":0400000300003800C2\n", [](const vm::hex_record_view& record) {
+        ensure(!record.is_valid() && record.sum_expected == 0xC2 && record.sum_actual == 0xC1, "streaming: wrong checksum");
+        ensure(record.get_start() == 0x3800, "streaming: wrong start");
+        return true;
+    });
+    ensure(ok, "streaming: bad checksum is not parse error");
+}
+
+/// stream larger than buffer of parser
+void test_large_stream()
+{
+    constexpr size_t records = 20'000;
+    std::stringstream stream;
+    for (size_t i = 0; i < records; ++i)
+    {
+        std::vector<uint8_t> bytes{16, static_cast<uint8_t>(i >> 8u), static_cast<uint8_t>(i), 0};
+        for (size_t j = 0; j < 16; ++j)
+        {
+            bytes.push_back(static_cast<uint8_t>(i + j));
+        }
+        bytes.push_back(vm::hex_checksum(bytes.data(), bytes.data() + bytes.size()));
+        stream << ':';
+        for (auto byte: bytes)
+        {
+            stream << std::format("{:02X}", byte);
+        }
+        stream << '\n';
+    }
+    stream << ":00000001FF\n";
+
+    size_t count = 0;
+    bool ok = vm::parse_hex(stream, [&count](const vm::hex_record_view& record) {
+        if (record.type == vm::hex_record::HEX_EOF)
+            return true;
+        ensure(record.is_valid() && record.count == 16, std::format("large: record {} is broken", count));
+        ensure(record.offset == static_cast<uint16_t>(count) && record.data[15] == static_cast<uint8_t>(count + 15),
+               std::format("large: record {} has wrong content", count));
+        ++count;
+        return true;
+    });
+    ensure(ok && count == records, std::format("large: {} records parsed, expected {}", count, records));
+}
+
 int main(int argc, char** argv)
 {
     test_parse_record("00000001FF", 0xFF, record_type::HEX_EOF, 0x00);
@@ -61,6 +185,10 @@ int main(int argc, char** argv)
     test_parse_record("0B0010006164647265737320676170A7", 0xA7, record_type::HEX_DATA, 0x0B);
 
     test_parser();
+    test_flat_file();
+    test_decoder();
+    test_streaming();
+    test_large_stream();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include <iostream>
 
+#include "device_memory.hxx"
 #include "yeti-vm/vm_memory.hxx"
 #include "yeti-vm/vm_utility.hxx"
 
 using range = vm::memory_block::params;
+using tests::device_memory;
 
 int main()
 {
@@ -95,6 +97,63 @@ int main()
         test_set_get(150, uint16_t{0xd1});
     }
 
+    {
+        using mmu_type = vm::memory_management_unit;
+        constexpr auto page = mmu_type::page_size;
+        mmu_type mmu;
+
+        // RAM: two full pages and tail, device shares last page of RAM
+        vm::ensure(mmu.add_block<vm::generic_memory>(page, 2 * page + 16), "RAM: should return true");
+        vm::ensure(mmu.add_block<device_memory>(3 * page + 64, 64), "device: should return true");
+        vm::ensure(mmu.add_block<device_memory>(0xffff'f000, page), "last page: should return true");
+        vm::ensure(!mmu.add_block<vm::generic_memory>(3 * page + 100, 8), "overlap in shared page: should return false");
+        vm::ensure(!mmu.add_block<vm::generic_memory>(0, page + 1), "overlap at page start: should return false");
+
+        auto* ram = mmu.find_block(page, 4);
+        vm::ensure(ram != nullptr, "RAM: should be not null");
+        vm::ensure(mmu.find_block(2 * page + 100, 4) == ram, "second page: same block expected");
+        vm::ensure(mmu.find_block(3 * page, 16) == ram, "tail in shared page: same block expected");
+        vm::ensure(mmu.find_block(3 * page + 12, 8) == nullptr, "crosses end of RAM: should be null");
+        vm::ensure(mmu.find_block(2 * page - 2, 4) == ram, "crosses page boundary: same block expected");
+        vm::ensure(mmu.find_block(3 * page + 32, 4) == nullptr, "gap in shared page: should be null");
+        vm::ensure(mmu.find_block(0x1000'0000, 4) == nullptr, "unmapped: should be null");
+        vm::ensure(mmu.find_block(0, 4) == nullptr, "unmapped page in table: should be null");
+
+        auto* device = mmu.find_block(3 * page + 64, 4);
+        vm::ensure(device != nullptr && device != ram, "device: should be found");
+        vm::ensure(mmu.find_block(0xffff'fffc, 4) != nullptr, "last page: should be found");
+
+        auto* full = mmu.find_page(2 * page);
+        vm::ensure(full && full->block == ram && !full->shared, "full page: should be mapped to RAM");
+        vm::ensure(full->host == ram->get_rw_ptr<std::uint8_t>(2 * page), "full page: wrong host pointer");
+        auto* shared = mmu.find_page(3 * page);
+        vm::ensure(shared && shared->block == nullptr && shared->host == nullptr && shared->shared, "shared page: expected");
+        auto* mmio = mmu.find_page(0xffff'f000);
+        vm::ensure(mmio && mmio->block != nullptr && mmio->host == nullptr, "device page: should not have host memory");
+        vm::ensure(mmu.find_page(0x1000'0000) == nullptr, "unmapped: no page table expected");
+    }
+
+    {
+        constexpr vm::memory_block::size_type size = 64 * 1024 * 1024;
+        constexpr vm::memory_block::address_type start = 0x1000'0000;
+        vm::sparse_memory block{start, size};
+
+        vm::ensure(block.get_committed_size() < size, "sparse: block is committed on construction");
+        std::uint32_t value = 0xffffffff;
+        vm::ensure(block.load(start + size / 2, &value, sizeof(value)) && value == 0, "sparse: untouched page should be zero");
+
+        const auto before = block.get_committed_size();
+        value = 0x12345678;
+        vm::ensure(block.store(start + size - 4, &value, sizeof(value)), "sparse: store failed");
+        value = 0;
+        vm::ensure(block.load(start + size - 4, &value, sizeof(value)) && value == 0x12345678, "sparse: wrong value");
+        vm::ensure(block.get_committed_size() <= before + vm::memory_management_unit::page_size, "sparse: more than one page committed");
+        vm::ensure(!block.store(start + size - 2, &value, sizeof(value)), "sparse: store out of range");
+
+        auto* host = block.get_host_memory();
+        vm::ensure(host != nullptr && host[size - 4] == 0x78, "sparse: wrong host memory");
+    }
+
     std::cout << "ok" << std::endl;
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <iostream>
+
+#include "yeti-vm/vm_handler.hxx"
+#include "yeti-vm/vm_handlers_rv32i.hxx"
+#include "yeti-vm/vm_handlers_rv32m.hxx"
+#include "yeti-vm/vm_utility.hxx"
+
+using vm::opcode::Decoder;
+using vm::opcode::Encoder;
+
+/// dispatch table should give same result as handlers map
+void test_same_handlers(const vm::registry& registry)
+{
+    for (vm::opcode::opcode_t group = 0; group < vm::registry::group_count; ++group)
+    {
+        for (vm::opcode::opcode_t func_3 = 0; func_3 < vm::registry::func_a_count; ++func_3)
+        {
+            for (vm::opcode::opcode_t func_7 = 0; func_7 < vm::registry::func_b_count; ++func_7)
+            {
+                Decoder code{Encoder::r_type(group, 1, 2, 3, func_3, func_7)};
+                vm::ensure(registry.find_handler(&code) == registry.lookup(&code),
+                           std::format("handlers mismatch: {:08x}", code.code));
+            }
+        }
+    }
+}
+
+/// custom handler in unused group
+struct custom_op: public vm::instruction_base<vm::opcode::CUSTOM_0, vm::opcode::R_TYPE, 0b0010, 0b0000001>
+{
+    void exec(vm::vm_interface *, const Decoder *) const override {}
+};
+
+int main()
+{
+    vm::registry registry;
+    vm::ensure(vm::rv32i::register_rv32i_set(&registry), "unable register RV32I");
+    test_same_handlers(registry);
+    vm::ensure(vm::rv32m::register_rv32m_set(&registry), "unable register RV32M");
+    test_same_handlers(registry);
+    vm::ensure(registry.register_handler<custom_op>(), "unable register custom handler");
+    test_same_handlers(registry);
+
+    Decoder custom{Encoder::r_type(vm::opcode::CUSTOM_0, 1, 2, 3, 0b0010, 0b0000001)};
+    vm::ensure(registry.find_handler(&custom) != nullptr, "custom handler not found");
+
+    Decoder add{Encoder::r_type(vm::opcode::OP, 1, 2, 3, 0b000, 0b0000000)};
+    Decoder mul{Encoder::r_type(vm::opcode::OP, 1, 2, 3, 0b000, 0b0000001)};
+    vm::ensure(registry.find_handler(&add)->get_mnemonic() == "add", "add not found");
+    vm::ensure(registry.find_handler(&mul)->get_mnemonic() == "mul", "mul not found");
+
+    std::cout << "ok" << std::endl;
+    return EXIT_SUCCESS;
+}
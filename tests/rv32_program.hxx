@@ -0,0 +1,321 @@
+/// helpers for building small RV32 programs in tests
+#pragma once
+
+#include <yeti-vm/vm_basic.hxx>
+#include <yeti-vm/vm_opcode.hxx>
+
+#include <format>
+#include <functional>
+
+namespace tests::rv32_program
+{
+using vm::opcode::Encoder;
+using Group = vm::opcode::OpcodeType;
+using Code = vm::opcode::opcode_t;
+using RegId = vm::register_no;
+
+/// generic register-register operation
+inline Code op_r(RegId rd, RegId rs1, RegId rs2, Code func3, Code func7)
+{
+    return Encoder::r_type(Group::OP, rd, rs1, rs2, func3, func7);
+}
+
+/// generic register-immediate operation
+inline Code op_i(RegId rd, RegId rs1, std::int32_t imm, Code func3)
+{
+    return Encoder::i_type(Group::OP_IMM, rd, rs1, std::bit_cast<Code>(imm), func3);
+}
+
+/// generic load, func3 selects width
+inline Code load(RegId rd, RegId base, std::int32_t offset, Code func3)
+{
+    return Encoder::i_type(Group::LOAD, rd, base, std::bit_cast<Code>(offset), func3);
+}
+
+/// generic store, func3 selects width
+inline Code store(RegId src, RegId base, std::int32_t offset, Code func3)
+{
+    return Encoder::s_type(Group::STORE, base, src, std::bit_cast<Code>(offset), func3);
+}
+
+/// generic branch, func3 selects condition
+inline Code branch(RegId lhs, RegId rhs, std::int32_t offset, Code func3)
+{
+    return Encoder::b_type(Group::BRANCH, lhs, rhs, std::bit_cast<Code>(offset), func3);
+}
+
+inline Code addi(RegId rd, RegId rs1, std::int32_t imm)
+{
+    return Encoder::i_type(Group::OP_IMM, rd, rs1, std::bit_cast<Code>(imm), 0b000);
+}
+
+inline Code slli(RegId rd, RegId rs1, Code shift)
+{
+    return Encoder::i_type(Group::OP_IMM, rd, rs1, shift, 0b001);
+}
+
+inline Code add(RegId rd, RegId rs1, RegId rs2)
+{
+    return Encoder::r_type(Group::OP, rd, rs1, rs2, 0b000, 0b0000000);
+}
+
+inline Code sub(RegId rd, RegId rs1, RegId rs2)
+{
+    return Encoder::r_type(Group::OP, rd, rs1, rs2, 0b000, 0b0100000);
+}
+
+inline Code slt(RegId rd, RegId rs1, RegId rs2)
+{
+    return Encoder::r_type(Group::OP, rd, rs1, rs2, 0b010, 0b0000000);
+}
+
+inline Code mul(RegId rd, RegId rs1, RegId rs2)
+{
+    return Encoder::r_type(Group::OP, rd, rs1, rs2, 0b000, 0b0000001);
+}
+
+inline Code lui(RegId rd, Code upper)
+{
+    return Encoder::u_type(Group::LUI, rd, upper & ~Code{0xfff});
+}
+
+inline Code auipc(RegId rd, Code upper)
+{
+    return Encoder::u_type(Group::AUIPC, rd, upper & ~Code{0xfff});
+}
+
+inline Code lw(RegId rd, RegId base, std::int32_t offset)
+{
+    return Encoder::i_type(Group::LOAD, rd, base, std::bit_cast<Code>(offset), 0b010);
+}
+
+inline Code sw(RegId src, RegId base, std::int32_t offset)
+{
+    return Encoder::s_type(Group::STORE, base, src, std::bit_cast<Code>(offset), 0b010);
+}
+
+inline Code beq(RegId lhs, RegId rhs, std::int32_t offset)
+{
+    return Encoder::b_type(Group::BRANCH, lhs, rhs, std::bit_cast<Code>(offset), 0b000);
+}
+
+inline Code bne(RegId lhs, RegId rhs, std::int32_t offset)
+{
+    return Encoder::b_type(Group::BRANCH, lhs, rhs, std::bit_cast<Code>(offset), 0b001);
+}
+
+inline Code jal(RegId rd, std::int32_t offset)
+{
+    return Encoder::j_type(Group::JAL, rd, std::bit_cast<Code>(offset));
+}
+
+inline Code jalr(RegId rd, RegId base, std::int32_t offset)
+{
+    return Encoder::i_type(Group::JALR, rd, base, std::bit_cast<Code>(offset), 0b000);
+}
+
+inline Code ecall()
+{
+    return Encoder::i_type(Group::SYSTEM, 0, 0, 0, 0b000);
+}
+
+inline Code ebreak()
+{
+    return Encoder::i_type(Group::SYSTEM, 0, 0, 1, 0b000);
+}
+
+/// fence rw, rw
+inline Code fence()
+{
+    return Encoder::i_type(Group::MISC_MEM, 0, 0, 0x033, 0b000);
+}
+
+/// atomic read and write of CSR
+inline Code csrrw(RegId rd, Code csr, RegId rs1)
+{
+    return Encoder::i_type(Group::SYSTEM, rd, rs1, csr, 0b001);
+}
+
+/// upper part for lui/auipc + addi pair
+inline Code upper_of(Code value)
+{
+    return (value + 0x800) & ~Code{0xfff};
+}
+
+/// lower part for lui/auipc + addi pair
+inline std::int32_t lower_of(Code value)
+{
+    return std::bit_cast<std::int32_t>(value - upper_of(value));
+}
+
+/// convert list of instructions to binary
+inline vm::program_code_t to_binary(const std::vector<Code>& program)
+{
+    vm::program_code_t result(program.size() * sizeof(Code));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// initialise ISA and memory, register "exit" syscall(a7 = 10)
+inline bool init_machine(vm::basic_vm& machine)
+{
+    bool ok = machine.init_isa();
+    ok = ok && machine.init_memory();
+    ok = ok && machine.get_syscalls().register_handler(
+        vm::syscall_functor::create(10, "exit", [](vm::vm_interface* m) { m->halt(); }));
+    return ok;
+}
+
+/// initialise VM, program is loaded at address 0
+inline bool init_vm(vm::basic_vm& machine, const std::vector<Code>& program)
+{
+    return init_machine(machine) && machine.set_program(to_binary(program), 0);
+}
+
+/// initialise VM, image is loaded at address 0
+inline bool init_vm(vm::basic_vm& machine, const vm::program_image& image)
+{
+    return init_machine(machine) && machine.set_program(image, 0);
+}
+
+/// initialise VM, segments are loaded, PC is set to entry
+inline bool init_vm(vm::basic_vm& machine, const vm::elf_file& elf)
+{
+    return init_machine(machine) && machine.set_program(elf);
+}
+
+/**
+ * started VM with loaded program
+ *
+ * program is list of instructions, program_image or elf_file
+ */
+struct fixture
+{
+    /// called before VM is initialised: reserve guest space, add blocks and syscalls
+    using setup_fn = std::function<void(vm::basic_vm&)>;
+
+    vm::basic_vm machine;
+
+    template<typename Program = std::vector<Code>>
+    fixture(const Program& program, vm::basic_vm::engine_type engine, const setup_fn& setup = {})
+    {
+        if (setup)
+        {
+            setup(machine);
+        }
+        vm::ensure(init_vm(machine, program), "unable init VM");
+        machine.set_engine(engine);
+        machine.start();
+    }
+};
+
+/// run program, registers and PC are returned
+/// @param failed set if VM throws data_access_error
+inline vm::register_file run_program(const std::vector<Code>& program, vm::basic_vm::engine_type engine, bool& failed)
+{
+    vm::basic_vm machine;
+    vm::ensure(init_vm(machine, program), "unable init VM");
+    machine.set_engine(engine);
+    machine.start();
+    failed = false;
+    try
+    {
+        machine.run();
+    }
+    catch (vm::basic_vm::data_access_error&)
+    {
+        failed = true;
+    }
+    vm::register_file result{};
+    for (vm::register_no r = 0; r < vm::register_count; ++r)
+    {
+        result[r] = machine.get_register(r);
+    }
+    result[vm::RegAlias::pc] = machine.get_pc();
+    return result;
+}
+
+/// program gives same result with interpreter and selected engine
+inline void test_same_result(std::string_view name, const std::vector<Code>& program,
+                             vm::basic_vm::engine_type engine, bool expect_fail)
+{
+    bool interpreter_failed = false;
+    bool engine_failed = false;
+    auto expected = run_program(program, vm::basic_vm::engine_type::interpreter, interpreter_failed);
+    auto actual = run_program(program, engine, engine_failed);
+    vm::ensure(interpreter_failed == expect_fail, std::format("{}: interpreter, unexpected result", name));
+    vm::ensure(engine_failed == expect_fail, std::format("{}: engine, unexpected result", name));
+    for (vm::register_no r = 0; r < expected.size(); ++r)
+    {
+        vm::ensure(expected[r] == actual[r],
+                   std::format("{}: register {} = {:08x}, expected {:08x}",
+                               name, vm::get_register_alias(r), actual[r], expected[r]));
+    }
+}
+
+/// program gives expected value of register with selected engine
+inline void test_register(std::string_view name, const std::vector<Code>& program,
+                          vm::basic_vm::engine_type engine, vm::register_no r, vm::register_t expected)
+{
+    bool failed = false;
+    auto actual = run_program(program, engine, failed);
+    vm::ensure(!failed && actual[r] == expected,
+               std::format("{}: register {} = {:08x}, expected {:08x}",
+                           name, vm::get_register_alias(r), actual[r], expected));
+}
+
+/// hot loop with fence in the middle of block, a1 = 0x0c
+inline std::vector<Code> make_fence()
+{
+    using namespace vm;
+    return {
+        addi(a0, zero, 20),             // 0x00
+        addi(a2, zero, 0),              // 0x04
+        fence(),                        // 0x08: loop
+        auipc(a1, 0),                   // 0x0c
+        add(a2, a2, a1),                // 0x10
+        addi(a0, a0, -1),               // 0x14
+        bne(a0, zero, -16),             // 0x18: -> 0x08
+        addi(a7, zero, 10),             // 0x1c
+        ecall(),                        // 0x20
+    };
+}
+
+/// hot loop with CSR access at the end of block, a1 = 0x14
+inline std::vector<Code> make_csr()
+{
+    using namespace vm;
+    return {
+        addi(a0, zero, 20),             // 0x00
+        addi(a2, zero, 0),              // 0x04
+        addi(a2, a2, 1),                // 0x08: loop
+        csrrw(zero, 0x340, zero),       // 0x0c: mscratch
+        addi(a0, a0, -1),               // 0x10
+        auipc(a1, 0),                   // 0x14
+        bne(a0, zero, -16),             // 0x18: -> 0x08
+        addi(a7, zero, 10),             // 0x1c
+        ecall(),                        // 0x20
+    };
+}
+
+/// program patches own code and executes patched instruction again
+inline std::vector<Code> make_self_modifying()
+{
+    using namespace vm;
+    const Code patched = addi(a0, a0, 100);
+    return {
+        addi(a0, zero, 0),              // 0x00
+        addi(s1, zero, 0),              // 0x04
+        addi(a0, a0, 1),                // 0x08: patched instruction
+        bne(s1, zero, 24),              // 0x0c: -> 0x24
+        addi(s1, zero, 1),              // 0x10
+        lui(t0, upper_of(patched)),     // 0x14
+        addi(t0, t0, lower_of(patched)),// 0x18
+        sw(t0, zero, 0x08),             // 0x1c
+        jal(zero, -24),                 // 0x20: -> 0x08
+        addi(a7, zero, 10),             // 0x24
+        ecall(),                        // 0x28
+    };
+}
+
+} // namespace tests::rv32_program
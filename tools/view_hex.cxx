@@ -3,7 +3,7 @@
 #include "yeti-vm/vm_utility.hxx"
 #include <format>
 
-std::string to_hex(const vm::hex_record& r)
+std::string to_hex(const vm::hex_record_view& r)
 {
     std::string result;
     result.reserve(r.data.size() * 2);
@@ -42,7 +42,7 @@ int main(int argc, char** argv)
         << std::setw(10) << std::left << "r.data"
         << std::endl;
     size_t idx = 1;
-    for (auto& r : records)
+    for (auto r : records)
     {
         std::cout
                 << std::dec
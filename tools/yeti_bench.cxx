@@ -0,0 +1,996 @@
+/**
+ * yeti-bench - micro benchmarks for VM internals
+ *
+ * usage: yeti-bench [name...] - run selected benchmarks(all by default)
+ */
+
+#include "yeti-vm/vm_opcode.hxx"
+#include "yeti-vm/vm_handler.hxx"
+#include "yeti-vm/vm_handlers_rv32i.hxx"
+#include "yeti-vm/vm_handlers_rv32m.hxx"
+#include "yeti-vm/vm_basic.hxx"
+#include "yeti-vm/vm_console.hxx"
+#include "yeti-vm/vm_io_ring.hxx"
+#include "yeti-vm/vm_utility.hxx"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <functional>
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+using vm::opcode::Encoder;
+using vm::opcode::Decoder;
+using Group = vm::opcode::OpcodeType;
+
+struct benchmark
+{
+    std::string_view name;
+    std::function<void()> run;
+};
+
+/// print result of measurement
+void report(std::string_view name, size_t count, clock_type::duration elapsed)
+{
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    std::cout
+        << std::setw(32) << std::left << name
+        << std::setw(12) << std::right << count
+        << std::setw(12) << std::right << std::fixed << std::setprecision(3) << ns / double(count) << " ns/op"
+        << std::endl;
+}
+
+/// adds extra blocks and syscalls, loads program
+using load_fn = std::function<bool(vm::basic_vm&)>;
+
+/**
+ * init ISA and memory, register "exit" syscall(a7 = 10), then call `load`
+ *
+ * layout of memory(guest space, base of code and data) is selected before call
+ */
+void init_vm(vm::basic_vm& machine, const load_fn& load)
+{
+    bool ok = machine.init_isa();
+    ok = ok && machine.init_memory();
+    ok = ok && machine.get_syscalls().register_handler(
+        vm::syscall_functor::create(10, "exit", [](vm::vm_interface* m) { m->halt(); }));
+    ok = ok && load(machine);
+    vm::ensure(ok, "unable init VM");
+}
+
+/// init VM, program is loaded at `address` after `setup`
+void init_vm(vm::basic_vm& machine, const vm::program_code_t& program, vm::vm_interface::address_t address,
+             const load_fn& setup = {})
+{
+    init_vm(machine, [&](vm::basic_vm& m) {
+        return (!setup || setup(m)) && m.set_program(program, address);
+    });
+}
+
+/// typical instruction mix
+std::vector<Decoder> make_instruction_mix()
+{
+    using namespace vm;
+    return {
+        Decoder{Encoder::i_type(Group::OP_IMM, a0, a0, 1, 0b000)},       // addi
+        Decoder{Encoder::r_type(Group::OP, a1, a0, a2, 0b000, 0b0000000)}, // add
+        Decoder{Encoder::r_type(Group::OP, a1, a0, a2, 0b000, 0b0100000)}, // sub
+        Decoder{Encoder::i_type(Group::LOAD, a3, sp, 8, 0b010)},         // lw
+        Decoder{Encoder::s_type(Group::STORE, sp, a3, 8, 0b010)},        // sw
+        Decoder{Encoder::b_type(Group::BRANCH, a0, a1, -8, 0b001)},      // bne
+        Decoder{Encoder::u_type(Group::LUI, a4, 0x12345000)},            // lui
+        Decoder{Encoder::j_type(Group::JAL, ra, 16)},                    // jal
+        Decoder{Encoder::r_type(Group::OP, a1, a0, a2, 0b000, 0b0000001)}, // mul
+        Decoder{Encoder::r_type(Group::OP_IMM, a1, a0, 3, 0b001, 0b0000000)}, // slli
+    };
+}
+
+/// compare handler lookup: handlers map vs dispatch table
+void bench_dispatch()
+{
+    vm::registry registry;
+    vm::ensure(vm::rv32i::register_rv32i_set(&registry), "unable register RV32I");
+    vm::ensure(vm::rv32m::register_rv32m_set(&registry), "unable register RV32M");
+
+    const auto mix = make_instruction_mix();
+    constexpr size_t rounds = 2'000'000;
+    const size_t count = rounds * mix.size();
+
+    auto measure = [&](std::string_view name, auto find)
+    {
+        size_t found = 0;
+        auto start = clock_type::now();
+        for (size_t i = 0; i < rounds; ++i)
+        {
+            for (const auto& code: mix)
+            {
+                found += find(&code) != nullptr;
+            }
+        }
+        auto elapsed = clock_type::now() - start;
+        vm::ensure(found == count, "unable find handler");
+        report(name, count, elapsed);
+    };
+
+    measure("dispatch/map_lookup", [&registry](const Decoder* code) { return registry.lookup(code); });
+    measure("dispatch/flat_table", [&registry](const Decoder* code) { return registry.find_handler(code); });
+}
+
+/// tight loop: a0 = sum(1..count)
+vm::program_code_t make_loop_program(vm::register_t count)
+{
+    using namespace vm;
+    const std::vector<opcode::opcode_t> program{
+        Encoder::u_type(Group::LUI, a1, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, a1, a1, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::i_type(Group::OP_IMM, a0, zero, 0, 0b000),
+        // loop:
+        Encoder::r_type(Group::OP, a0, a0, a1, 0b000, 0b0000000),
+        Encoder::i_type(Group::OP_IMM, a1, a1, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, a1, zero, to_unsigned(-8), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    program_code_t result(program.size() * sizeof(opcode::opcode_t));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// compare execution engines on tight loop
+void bench_engines()
+{
+    constexpr vm::register_t count = 3'000'000;
+    constexpr size_t instructions = 3 + 3 * count + 2;
+    const auto program = make_loop_program(count);
+
+    auto measure = [&](std::string_view name, vm::basic_vm::engine_type engine, bool predecode)
+    {
+        vm::basic_vm machine;
+        init_vm(machine, program, 0);
+        machine.set_engine(engine);
+        machine.enable_predecode(predecode);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(machine.get_register(vm::a0) == vm::register_t(count * (count + 1ull) / 2), "wrong result");
+        report(name, instructions, elapsed);
+    };
+
+    measure("engine/interpreter", vm::basic_vm::engine_type::interpreter, false);
+    measure("engine/interpreter+predecode", vm::basic_vm::engine_type::interpreter, true);
+    measure("engine/blocks", vm::basic_vm::engine_type::blocks, false);
+    measure("engine/jit", vm::basic_vm::engine_type::jit, false);
+}
+
+/// tight loop, code block is last of many memory blocks
+void bench_pc()
+{
+    constexpr vm::register_t count = 3'000'000;
+    constexpr size_t instructions = 3 + 3 * count + 2;
+    constexpr size_t extra_blocks = 16;
+    constexpr vm::vm_interface::address_t code_base = 0x8000'0000;
+    const auto program = make_loop_program(count);
+
+    auto measure = [&](std::string_view name, vm::basic_vm::engine_type engine, bool predecode)
+    {
+        vm::basic_vm machine;
+        vm::ensure(machine.set_ro_base(code_base), "unable move code");
+        init_vm(machine, program, code_base, [](vm::basic_vm& m) {
+            bool ok = true;
+            for (size_t i = 0; i < extra_blocks; ++i)
+            {
+                ok = ok && m.add_memory(0x1000'0000 + i * 0x1'0000, 0x1000);
+            }
+            return ok;
+        });
+        machine.set_engine(engine);
+        machine.enable_predecode(predecode);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(machine.get_register(vm::a0) == vm::register_t(count * (count + 1ull) / 2), "wrong result");
+        report(name, instructions, elapsed);
+    };
+
+    measure("pc/interpreter", vm::basic_vm::engine_type::interpreter, false);
+    measure("pc/interpreter+predecode", vm::basic_vm::engine_type::interpreter, true);
+    measure("pc/blocks", vm::basic_vm::engine_type::blocks, false);
+}
+
+/// loop of loads and stores: a0 = sum(1..count)
+vm::program_code_t make_memory_program(vm::register_t count, vm::register_t data_base)
+{
+    using namespace vm;
+    const std::vector<opcode::opcode_t> program{
+        Encoder::u_type(Group::LUI, s0, data_base),
+        Encoder::u_type(Group::LUI, a1, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, a1, a1, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::s_type(Group::STORE, s0, zero, 0, 0b010),
+        // loop:
+        Encoder::i_type(Group::LOAD, a0, s0, 0, 0b010),
+        Encoder::r_type(Group::OP, a0, a0, a1, 0b000, 0b0000000),
+        Encoder::s_type(Group::STORE, s0, a0, 0, 0b010),
+        Encoder::i_type(Group::OP_IMM, a1, a1, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, a1, zero, to_unsigned(-16), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    program_code_t result(program.size() * sizeof(opcode::opcode_t));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// address translation: data block is placed after many small blocks
+void bench_memory()
+{
+    constexpr vm::register_t count = 3'000'000;
+    constexpr size_t instructions = 4 + 5 * count + 2;
+    constexpr size_t extra_blocks = 64;
+    constexpr vm::vm_interface::address_t data_base = 0x4000'0000;
+    const auto program = make_memory_program(count, data_base);
+
+    auto measure = [&](std::string_view name, vm::basic_vm::engine_type engine, bool reserve)
+    {
+        vm::basic_vm machine;
+        vm::ensure(!reserve || machine.enable_guest_space(), "unable reserve guest space");
+        vm::ensure(machine.set_rw_base(data_base), "unable move data");
+        init_vm(machine, program, vm::basic_vm::def_code_base, [](vm::basic_vm& m) {
+            bool ok = true;
+            for (size_t i = 0; i < extra_blocks; ++i)
+            {
+                ok = ok && m.add_memory(0x1000'0000 + i * 0x1000, 0x100);
+            }
+            return ok;
+        });
+        machine.set_engine(engine);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(machine.get_register(vm::a0) == vm::register_t(count * (count + 1ull) / 2), "wrong result");
+        report(name, instructions, elapsed);
+    };
+
+    measure("memory/interpreter", vm::basic_vm::engine_type::interpreter, false);
+    measure("memory/blocks", vm::basic_vm::engine_type::blocks, false);
+    measure("memory/jit", vm::basic_vm::engine_type::jit, false);
+    if (vm::guest_space::is_supported())
+    {
+        measure("memory/jit+guest_space", vm::basic_vm::engine_type::jit, true);
+    }
+}
+
+/// many short-lived instances: init memory, load and run small program
+void bench_instances()
+{
+    constexpr size_t count = 2'000;
+    constexpr vm::register_t iterations = 100;
+    // program with large code section
+    auto program = make_loop_program(iterations);
+    program.resize(256 * 1024);
+    const auto image = vm::program_image::create(program);
+    vm::ensure(image != nullptr, "unable create image");
+
+    // same program loaded from file by each instance
+    const auto file = std::filesystem::temp_directory_path() / "yeti-bench-instances.bin";
+    {
+        std::ofstream out{file, std::ios::binary};
+        out.write(reinterpret_cast<const char*>(program.data()), static_cast<std::streamsize>(program.size()));
+        vm::ensure(out.good(), "unable write program");
+    }
+
+    auto measure = [&](std::string_view name, auto load)
+    {
+        auto start = clock_type::now();
+        std::uint64_t committed = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            vm::basic_vm machine;
+            init_vm(machine, load);
+            machine.start();
+            machine.run();
+            committed += machine.get_committed_memory();
+        }
+        auto elapsed = clock_type::now() - start;
+
+        report(name, count, elapsed);
+        std::cout
+            << std::setw(32) << std::left << std::format("{}/committed", name)
+            << std::setw(12) << std::right << count
+            << std::setw(12) << std::right << committed / count / 1024 << " KiB/op"
+            << std::endl;
+    };
+
+    measure("instances/copy", [&](vm::basic_vm& machine) {
+        return machine.set_program(program, vm::basic_vm::def_code_base);
+    });
+    measure("instances/image", [&](vm::basic_vm& machine) {
+        return machine.set_program(*image, vm::basic_vm::def_code_base);
+    });
+    measure("instances/file-read", [&](vm::basic_vm& machine) {
+        auto bin = vm::load_program(file);
+        return bin && machine.set_program(bin.value(), vm::basic_vm::def_code_base);
+    });
+    measure("instances/file-map", [&](vm::basic_vm& machine) {
+        auto mapped = vm::program_image::open(file);
+        return mapped && machine.set_program(*mapped, vm::basic_vm::def_code_base);
+    });
+    std::filesystem::remove(file);
+}
+
+/// compare predecode of cold straight-line code: lazy, cache file rebuilt, cache file reused
+void bench_decode_cache()
+{
+    using namespace vm;
+    constexpr size_t count = 200;
+    constexpr size_t size = 16 * 1024;
+    std::vector<opcode::opcode_t> code;
+    const auto mix = make_instruction_mix();
+    for (size_t i = 0; code.size() < size; ++i)
+    {
+        const auto op = mix[i % mix.size()];
+        const auto group = op.get_code();
+        // straight-line ALU code only
+        if (group == Group::OP || group == Group::OP_IMM || group == Group::LUI)
+        {
+            code.push_back(op.code);
+        }
+    }
+    code.push_back(Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000));
+    code.push_back(Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000));
+    program_code_t program(code.size() * sizeof(opcode::opcode_t));
+    std::memcpy(program.data(), code.data(), program.size());
+
+    const auto directory = std::filesystem::temp_directory_path() / "yeti-bench-decode";
+    std::filesystem::remove_all(directory);
+
+    auto measure = [&](std::string_view name, const std::filesystem::path& cache, bool rebuild)
+    {
+        clock_type::duration elapsed{};
+        clock_type::duration starting{};
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (rebuild)
+            {
+                std::filesystem::remove_all(directory);
+            }
+            basic_vm machine;
+            init_vm(machine, program, basic_vm::def_code_base);
+            machine.enable_predecode(true);
+            machine.set_decode_cache(cache);
+
+            auto start = clock_type::now();
+            machine.start();
+            auto started = clock_type::now();
+            machine.run();
+            starting += started - start;
+            elapsed += clock_type::now() - start;
+        }
+        report(name, count, elapsed);
+        report(std::format("{}/start", name), count, starting);
+    };
+
+    measure("decode/lazy", {}, false);
+    measure("decode/cache-rebuild", directory, true);
+    measure("decode/cache-hit", directory, false);
+    std::filesystem::remove_all(directory);
+}
+
+/// loop with fusible pairs: a0 = sum(2 * i), i = 0..count-1
+vm::program_code_t make_fusible_program(vm::register_t count)
+{
+    using namespace vm;
+    const std::vector<opcode::opcode_t> program{
+        Encoder::u_type(Group::LUI, a1, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, a1, a1, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::i_type(Group::OP_IMM, a0, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, a2, zero, 0, 0b000),
+        // loop:
+        Encoder::r_type(Group::OP_IMM, t0, a2, 1, 0b001, 0b0000000),   // slli
+        Encoder::r_type(Group::OP, a0, a0, t0, 0b000, 0b0000000),      // add
+        Encoder::i_type(Group::OP_IMM, a2, a2, 1, 0b000),
+        Encoder::r_type(Group::OP, t1, a2, a1, 0b010, 0b0000000),      // slt
+        Encoder::b_type(Group::BRANCH, t1, zero, to_unsigned(-16), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    program_code_t result(program.size() * sizeof(opcode::opcode_t));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// blocks engine with and without superinstructions
+void bench_fusion()
+{
+    constexpr vm::register_t count = 3'000'000;
+    constexpr size_t instructions = 4 + 5 * count + 2;
+    const auto program = make_fusible_program(count);
+
+    auto measure = [&](std::string_view name, vm::basic_vm::engine_type engine, bool fusion)
+    {
+        vm::basic_vm machine;
+        init_vm(machine, program, 0);
+        machine.set_engine(engine);
+        machine.enable_fusion(fusion);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(machine.get_register(vm::a0) == vm::register_t(count * (count - 1ull)), "wrong result");
+        report(name, instructions, elapsed);
+        return machine.get_fusion_stats();
+    };
+
+    measure("fusion/blocks", vm::basic_vm::engine_type::blocks, false);
+    const auto stats = measure("fusion/blocks+fusion", vm::basic_vm::engine_type::blocks, true);
+    measure("fusion/jit+fusion", vm::basic_vm::engine_type::jit, true);
+
+    for (size_t i = 0; i < stats.size(); ++i)
+    {
+        std::cout
+            << "    " << std::setw(28) << std::left << vm::fusion::get_name(vm::fusion::kind(i))
+            << std::setw(12) << std::right << stats[i] << " hits"
+            << std::endl;
+    }
+}
+
+/// loop with syscall in each iteration
+vm::program_code_t make_syscall_program(vm::register_t count)
+{
+    using namespace vm;
+    const std::vector<opcode::opcode_t> program{
+        Encoder::u_type(Group::LUI, s0, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, s0, s0, count - ((count + 0x800) & ~0xfffu), 0b000),
+        // loop:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 11, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),            // ecall
+        Encoder::i_type(Group::OP_IMM, s0, s0, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, s0, zero, to_unsigned(-12), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    program_code_t result(program.size() * sizeof(opcode::opcode_t));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// cost of syscall dispatch: std::function vs plain function
+void bench_syscalls()
+{
+    constexpr vm::register_t count = 1'000'000;
+    const auto program = make_syscall_program(count);
+
+    auto measure = [&](std::string_view name, auto bind)
+    {
+        vm::basic_vm machine;
+        init_vm(machine, program, vm::basic_vm::def_code_base, [&](vm::basic_vm& m) {
+            return bind(m.get_syscalls());
+        });
+        machine.set_engine(vm::basic_vm::engine_type::blocks);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        report(name, count, clock_type::now() - start);
+    };
+
+    vm::register_t sum = 0;
+    measure("syscalls/functor", [&](vm::syscall_registry& sys) {
+        return sys.register_handler(vm::syscall_functor::create(11, "put", [&sum](vm::vm_interface* m) {
+            sum += m->get_register(vm::a0);
+        }));
+    });
+    measure("syscalls/function", [&](vm::syscall_registry& sys) {
+        return sys.register_handler(11, "put", [](vm::vm_interface* m, void* context) {
+            *static_cast<vm::register_t*>(context) += m->get_register(vm::a0);
+        }, &sum);
+    });
+
+    // dispatch only: map lookup and std::function vs flat table and plain function
+    constexpr size_t calls = 10'000'000;
+    vm::basic_vm machine;
+    vm::syscall_registry sys;
+    vm::ensure(sys.register_handler(vm::syscall_functor::create(11, "functor", [&sum](vm::vm_interface* m) {
+        sum += m->get_register(vm::a0);
+    })), "unable register functor");
+    vm::ensure(sys.register_handler(12, "function", [](vm::vm_interface* m, void* context) {
+        *static_cast<vm::register_t*>(context) += m->get_register(vm::a0);
+    }, &sum), "unable register function");
+
+    auto start = clock_type::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        sys.find_handler(11)->exec(&machine);
+    }
+    report("syscalls/dispatch-map", calls, clock_type::now() - start);
+
+    start = clock_type::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        (*sys.find_entry(12))(&machine);
+    }
+    report("syscalls/dispatch-table", calls, clock_type::now() - start);
+}
+
+/// stream which counts written chars
+struct counting_buffer: std::streambuf
+{
+    size_t count = 0;
+protected:
+    int_type overflow(int_type value) override
+    {
+        count += 1;
+        return value;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize size) override
+    {
+        count += size;
+        return size;
+    }
+};
+
+/// guest prints text: char per syscall vs buffered console vs one write
+void bench_console()
+{
+    using namespace vm;
+    constexpr vm::register_t lines = 10'000;
+    constexpr vm::register_t line_size = 64;
+    constexpr vm::register_t count = lines * line_size;
+    const std::string line = std::string(line_size - 1, '#') + "\n";
+
+    // put_char for each char of text in data block
+    const std::vector<opcode::opcode_t> chars{
+        Encoder::u_type(Group::LUI, s0, basic_vm::def_data_base),
+        Encoder::u_type(Group::LUI, s1, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, s1, s1, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, console::put_char_id, 0b000),
+        // loop:
+        Encoder::i_type(Group::LOAD, a0, s0, 0, 0b100),                  // lbu
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, s0, s0, 1, 0b000),
+        Encoder::i_type(Group::OP_IMM, s1, s1, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, s1, zero, to_unsigned(-16), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    // one write for whole text
+    const std::vector<opcode::opcode_t> buffer{
+        Encoder::i_type(Group::OP_IMM, a0, zero, 1, 0b000),
+        Encoder::u_type(Group::LUI, a1, basic_vm::def_data_base),
+        Encoder::u_type(Group::LUI, a2, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, a2, a2, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, console::write_id, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+
+    auto measure = [&](std::string_view name, const std::vector<opcode::opcode_t>& code, bool buffered)
+    {
+        counting_buffer sink;
+        std::ostream output{&sink};
+        console out{output};
+        basic_vm machine;
+        program_code_t program(code.size() * sizeof(opcode::opcode_t));
+        std::memcpy(program.data(), code.data(), program.size());
+        init_vm(machine, program, basic_vm::def_code_base, [&](basic_vm& target) {
+            if (buffered)
+            {
+                return out.register_syscalls(target);
+            }
+            // std::ostream for each char
+            return target.get_syscalls().register_handler(
+                syscall_functor::create(console::put_char_id, "put_char", [&output](vm_interface* m) {
+                    output << static_cast<char>(m->get_register(a0));
+                    output.flush();
+                }));
+        });
+        for (vm::register_t i = 0; i < lines; ++i)
+        {
+            auto block = machine.get_ptr_rw(basic_vm::def_data_base + i * line_size, 1);
+            vm::ensure(block && block->store(basic_vm::def_data_base + i * line_size, line.data(), line_size),
+                       "unable store text");
+        }
+        machine.set_engine(basic_vm::engine_type::blocks);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        out.flush();
+        auto elapsed = clock_type::now() - start;
+        vm::ensure(sink.count == count, std::format("{}: wrong output size {}", name, sink.count));
+        report(name, count, elapsed);
+    };
+
+    measure("console/put_char-stream", chars, false);
+    measure("console/put_char-buffered", chars, true);
+    measure("console/write", buffer, true);
+}
+
+/// host fills guest buffer: store per word vs view of guest memory
+void bench_spans()
+{
+    constexpr size_t count = 2'000;
+    constexpr vm::register_t size = 64 * 1024;
+    const auto address = vm::basic_vm::def_data_base;
+    std::vector<std::uint8_t> source(size, 0x5a);
+
+    vm::basic_vm machine;
+    vm::ensure(machine.init_isa() && machine.init_memory(), "unable init VM");
+
+    auto start = clock_type::now();
+    for (size_t n = 0; n < count; ++n)
+    {
+        for (vm::register_t i = 0; i < size; i += sizeof(vm::register_t))
+        {
+            vm::register_t value;
+            std::memcpy(&value, source.data() + i, sizeof(value));
+            machine.write_memory(address + i, sizeof(value), value);
+        }
+    }
+    report("spans/write_memory-64K", count, clock_type::now() - start);
+
+    start = clock_type::now();
+    for (size_t n = 0; n < count; ++n)
+    {
+        auto view = machine.get_guest_span(address, size);
+        vm::ensure(view.has_value(), "unable get view");
+        std::memcpy(view->data(), source.data(), size);
+    }
+    report("spans/span-64K", count, clock_type::now() - start);
+}
+
+/// loop with misaligned load in each iteration
+vm::program_code_t make_faulting_program(vm::register_t count)
+{
+    using namespace vm;
+    const std::vector<opcode::opcode_t> program{
+        Encoder::u_type(Group::LUI, s0, basic_vm::def_data_base),
+        Encoder::u_type(Group::LUI, a0, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, a0, a0, count - ((count + 0x800) & ~0xfffu), 0b000),
+        // loop:
+        Encoder::i_type(Group::LOAD, t0, s0, 1, 0b010),                 // misaligned lw
+        Encoder::i_type(Group::OP_IMM, a0, a0, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, a0, zero, to_unsigned(-8), 0b001),
+        // exit:
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    program_code_t result(program.size() * sizeof(opcode::opcode_t));
+    std::memcpy(result.data(), program.data(), result.size());
+    return result;
+}
+
+/// cost of guest fault: trap vs exception
+void bench_traps()
+{
+    constexpr vm::register_t count = 200'000;
+    const auto program = make_faulting_program(count);
+
+    auto measure = [&](std::string_view name, bool use_exceptions)
+    {
+        vm::basic_vm machine;
+        init_vm(machine, program, 0);
+        machine.set_engine(vm::basic_vm::engine_type::blocks);
+        machine.start();
+
+        size_t faults = 0;
+        auto start = clock_type::now();
+        while (machine.is_running())
+        {
+            if (use_exceptions)
+            {
+                try
+                {
+                    machine.run();
+                }
+                catch (vm::basic_vm::data_access_error&)
+                {
+                    machine.set_pc(machine.get_pc() + sizeof(vm::opcode::opcode_t));
+                    ++faults;
+                }
+            }
+            else if (auto trap = machine.run_until_trap())
+            {
+                machine.set_pc(trap.pc + sizeof(vm::opcode::opcode_t));
+                ++faults;
+            }
+        }
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(faults == count, "wrong num of faults");
+        report(name, faults, elapsed);
+    };
+
+    measure("traps/exception", true);
+    measure("traps/trap", false);
+}
+
+/// time slicing of tenants: run_for() vs run_step() loop
+void bench_slices()
+{
+    constexpr vm::register_t count = 200'000;
+    constexpr size_t tenants = 64;
+    constexpr std::uint64_t slice = 1000;
+    constexpr size_t instructions = tenants * (3 + 3 * count + 2);
+    const auto program = make_loop_program(count);
+
+    auto measure = [&](std::string_view name, bool by_steps)
+    {
+        std::vector<std::unique_ptr<vm::basic_vm>> machines;
+        for (size_t i = 0; i < tenants; ++i)
+        {
+            auto& machine = *machines.emplace_back(std::make_unique<vm::basic_vm>());
+            init_vm(machine, program, 0);
+            machine.set_engine(vm::basic_vm::engine_type::blocks);
+            machine.start();
+        }
+
+        size_t executed = 0;
+        auto start = clock_type::now();
+        for (bool active = true; active; )
+        {
+            active = false;
+            for (auto& machine: machines)
+            {
+                if (!machine->is_running()) continue;
+                if (by_steps)
+                {
+                    for (std::uint64_t i = 0; i < slice && machine->is_running(); ++i, ++executed)
+                    {
+                        vm::ensure(!machine->run_step(), "unexpected trap");
+                    }
+                }
+                else
+                {
+                    executed += machine->run_for(slice).executed;
+                }
+                active = true;
+            }
+        }
+        auto elapsed = clock_type::now() - start;
+
+        vm::ensure(executed == instructions, "wrong num of instructions");
+        report(name, executed, elapsed);
+    };
+
+    measure("slices/run_step", true);
+    measure("slices/run_for", false);
+}
+
+/// IntelHEX text of binary at address 0, 16 bytes per record
+std::string make_hex_text(const vm::program_code_t& bin)
+{
+    std::string text;
+    auto put_record = [&text](std::vector<std::uint8_t> bytes)
+    {
+        bytes.push_back(vm::hex_checksum(bytes.data(), bytes.data() + bytes.size()));
+        text += ':';
+        for (auto byte: bytes)
+        {
+            text += std::format("{:02X}", byte);
+        }
+        text += '\n';
+    };
+    for (size_t pos = 0; pos < bin.size(); pos += 16)
+    {
+        if (pos % 0x10000 == 0)
+        {
+            // extended linear address
+            put_record({2, 0, 0, 4, static_cast<std::uint8_t>(pos >> 24u), static_cast<std::uint8_t>(pos >> 16u)});
+        }
+        std::vector<std::uint8_t> bytes{16, static_cast<std::uint8_t>(pos >> 8u), static_cast<std::uint8_t>(pos), 0};
+        bytes.insert(bytes.end(), bin.begin() + static_cast<std::ptrdiff_t>(pos), bin.begin() + static_cast<std::ptrdiff_t>(pos + 16));
+        put_record(std::move(bytes));
+    }
+    put_record({0, 0, 0, 1});
+    return text;
+}
+
+/// load of large IntelHEX image
+void bench_hex()
+{
+    constexpr size_t size = 2 * 1024 * 1024;
+    vm::program_code_t bin(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        bin[i] = static_cast<std::uint8_t>(i * 7);
+    }
+    const auto text = make_hex_text(bin);
+    const size_t records = size / 16;
+
+    auto make_vm = []
+    {
+        auto machine = std::make_unique<vm::basic_vm>();
+        bool ok = machine->init_isa();
+        ok = ok && machine->init_memory();
+        vm::ensure(ok, "unable init VM");
+        return machine;
+    };
+
+    auto measure = [&](std::string_view name, auto load)
+    {
+        auto machine = make_vm();
+        std::istringstream stream{text};
+        auto start = clock_type::now();
+        vm::ensure(load(*machine, stream), "unable load hex");
+        auto elapsed = clock_type::now() - start;
+        report(name, records, elapsed);
+    };
+
+    measure("hex/parse", [](vm::basic_vm&, std::istream& stream) {
+        return vm::parse_hex(stream).has_value();
+    });
+    std::istringstream text_stream{text};
+    const auto parsed = vm::parse_hex(text_stream);
+    vm::ensure(parsed.has_value(), "unable parse hex");
+    measure("hex/load", [&parsed](vm::basic_vm& machine, std::istream&) {
+        return machine.set_program(parsed.value());
+    });
+    measure("hex/sink", [](vm::basic_vm&, std::istream& stream) {
+        size_t count = 0;
+        return vm::parse_hex(stream, [&count](const vm::hex_record_view&) { return ++count != 0; });
+    });
+    measure("hex/stream", [](vm::basic_vm& machine, std::istream& stream) {
+        return machine.set_program(stream);
+    });
+}
+
+/// guest writes records to /dev/null: write per record vs ring batches
+void bench_ring()
+{
+    using namespace vm;
+    constexpr vm::register_t count = 32'768;
+    constexpr vm::register_t batch = 64;
+    constexpr vm::register_t batches = count / batch;
+    constexpr vm::register_t record = 0x700;
+    constexpr vm::register_t record_size = 64;
+    constexpr vm::register_t path = 0x780;
+    // host file is fd 3
+    constexpr std::uint16_t fd = 3;
+    static_assert(io_ring::get_ring_size(batch) <= record);
+
+    // s0 = data block, fd = open("null", O_WRONLY)
+    const std::vector<opcode::opcode_t> open_file{
+        Encoder::u_type(Group::LUI, s0, basic_vm::def_data_base),
+        Encoder::i_type(Group::OP_IMM, a0, s0, path, 0b000),
+        Encoder::i_type(Group::OP_IMM, a1, zero, 1, 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, linux_abi::open_id, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    const std::vector<opcode::opcode_t> exit{
+        Encoder::i_type(Group::OP_IMM, a7, zero, 10, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+    };
+    // write syscall per record
+    std::vector<opcode::opcode_t> writes{
+        Encoder::u_type(Group::LUI, s2, (count + 0x800) & ~0xfffu),
+        Encoder::i_type(Group::OP_IMM, s2, s2, count - ((count + 0x800) & ~0xfffu), 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, linux_abi::write_id, 0b000),
+        // loop:
+        Encoder::i_type(Group::OP_IMM, a0, zero, fd, 0b000),
+        Encoder::i_type(Group::OP_IMM, a1, s0, record, 0b000),
+        Encoder::i_type(Group::OP_IMM, a2, zero, record_size, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, s2, s2, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, s2, zero, to_unsigned(-20), 0b001),
+    };
+    // requests are prepared by host once, guest reposts whole ring by one ring_enter
+    std::vector<opcode::opcode_t> ring{
+        Encoder::i_type(Group::OP_IMM, a0, s0, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, a1, zero, batch, 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, io_ring::setup_id, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, s1, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, s2, zero, batches, 0b000),
+        Encoder::i_type(Group::OP_IMM, a7, zero, io_ring::enter_id, 0b000),
+        // loop: cq_head = tail, sq_tail = tail + batch, ring_enter(batch)
+        Encoder::s_type(Group::STORE, s0, s1, 8, 0b010),
+        Encoder::i_type(Group::OP_IMM, s1, s1, batch, 0b000),
+        Encoder::s_type(Group::STORE, s0, s1, 4, 0b010),
+        Encoder::i_type(Group::OP_IMM, a0, zero, batch, 0b000),
+        Encoder::i_type(Group::SYSTEM, zero, zero, 0, 0b000),
+        Encoder::i_type(Group::OP_IMM, s2, s2, to_unsigned(-1), 0b000),
+        Encoder::b_type(Group::BRANCH, s2, zero, to_unsigned(-24), 0b001),
+    };
+    for (auto* code: {&writes, &ring})
+    {
+        code->insert(code->begin(), open_file.begin(), open_file.end());
+        code->insert(code->end(), exit.begin(), exit.end());
+    }
+
+    auto measure = [&](std::string_view name, const std::vector<opcode::opcode_t>& code, bool use_worker, size_t requests)
+    {
+        counting_buffer sink;
+        std::ostream output{&sink};
+        console out{output};
+        linux_abi files{out, "/dev"};
+        io_ring io{files, use_worker};
+        basic_vm machine;
+        program_code_t program(code.size() * sizeof(opcode::opcode_t));
+        std::memcpy(program.data(), code.data(), program.size());
+        init_vm(machine, program, basic_vm::def_code_base, [&](basic_vm& m) {
+            return files.register_syscalls(m) && io.register_syscalls(m);
+        });
+
+        const char null_path[] = "null";
+        auto view = machine.get_guest_span(basic_vm::def_data_base, record + record_size);
+        auto text = machine.get_guest_span(basic_vm::def_data_base + path, sizeof(null_path));
+        vm::ensure(view && text, "unable get view");
+        std::memcpy(text->data(), null_path, sizeof(null_path));
+        for (vm::register_t i = 0; i < batch; ++i)
+        {
+            const io_ring::submission request{io_ring::op_write, fd, basic_vm::def_data_base + record, record_size, i};
+            std::memcpy(view->data() + sizeof(io_ring::header) + i * sizeof(request), &request, sizeof(request));
+        }
+        machine.set_engine(basic_vm::engine_type::blocks);
+        machine.start();
+
+        auto start = clock_type::now();
+        machine.run();
+        io.wait();
+        auto elapsed = clock_type::now() - start;
+        vm::ensure(io.get_requests() == requests, std::format("{}: wrong num of requests", name));
+        report(name, count, elapsed);
+    };
+
+    measure("ring/write", writes, false, 0);
+    measure("ring/batch", ring, false, count);
+    measure("ring/batch-worker", ring, true, count);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::vector<benchmark> benchmarks{
+        {"dispatch", bench_dispatch},
+        {"engines", bench_engines},
+        {"pc", bench_pc},
+        {"memory", bench_memory},
+        {"instances", bench_instances},
+        {"decode", bench_decode_cache},
+        {"fusion", bench_fusion},
+        {"traps", bench_traps},
+        {"syscalls", bench_syscalls},
+        {"console", bench_console},
+        {"spans", bench_spans},
+        {"slices", bench_slices},
+        {"hex", bench_hex},
+        {"ring", bench_ring},
+    };
+
+    for (const auto& bench: benchmarks)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+        {
+            selected |= bench.name == argv[i];
+        }
+        if (selected)
+        {
+            bench.run();
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -3,11 +3,18 @@
 #include "yeti-vm/vm_opcode.hxx"
 #include "yeti-vm/vm_handler.hxx"
 #include "yeti-vm/vm_basic.hxx"
+#include "yeti-vm/vm_console.hxx"
+#include "yeti-vm/vm_linux_abi.hxx"
+#include "yeti-vm/vm_io_ring.hxx"
 #include "yeti-vm/vm_handlers_rv32i.hxx"
 #include "yeti-vm/vm_handlers_rv32m.hxx"
 #include "yeti-vm/vm_base_types.hxx"
 #include "yeti-vm/vm_utility.hxx"
+#include "yeti-vm/vm_program_image.hxx"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <variant>
 
@@ -15,11 +22,12 @@ namespace fs = std::filesystem;
 
 struct load_helper
 {
-    using bin_data = vm::program_code_t;
+    using bin_data = vm::program_image::ptr;
     using hex_data = vm::hex_file;
     using bin_opt = std::optional<bin_data>;
     using hex_opt = std::optional<hex_data>;
-    using program_data = std::variant<bin_data, hex_data, std::nullptr_t>;
+    using elf_data = vm::elf_file::ptr;
+    using program_data = std::variant<bin_data, hex_data, elf_data, std::nullptr_t>;
 
     [[nodiscard]]
     bool load_file(const fs::path& fileName)
@@ -29,9 +37,10 @@ struct load_helper
 
         if (ext == ".bin")
         {
-            auto code = vm::load_program(fileName);
+            // binary is mapped from page cache, no copies
+            auto code = vm::program_image::open(fileName);
             if (code)
-                data = code.value();
+                data = code;
         }
         else if (ext == ".hex")
         {
@@ -39,8 +48,14 @@ struct load_helper
             if (code)
                 data = code.value();
         }
+        else
+        {
+            auto code = vm::elf_file::open(fileName);
+            if (code)
+                data = code;
+        }
 
-        return is_bin() || is_hex();
+        return is_bin() || is_hex() || is_elf();
     }
 
     [[nodiscard]]
@@ -54,6 +69,12 @@ struct load_helper
         return std::get_if<hex_data>(&data);
     }
 
+    [[nodiscard]]
+    const auto * as_elf() const
+    {
+        return std::get_if<elf_data>(&data);
+    }
+
     [[nodiscard]]
     bool is_bin() const
     {
@@ -65,6 +86,11 @@ struct load_helper
         return holds_alternative<hex_data>(data);
     }
     [[nodiscard]]
+    bool is_elf() const
+    {
+        return holds_alternative<elf_data>(data);
+    }
+    [[nodiscard]]
     bool is_null() const
     {
         return holds_alternative<std::nullptr_t>(data);
@@ -75,8 +101,9 @@ struct load_helper
     {
         bool empty = is_null();
 
-        empty |= is_bin() && as_bin()->empty();
+        empty |= is_bin() && (*as_bin())->get_size() == 0;
         empty |= is_hex() && as_hex()->empty();
+        empty |= is_elf() && (*as_elf())->get_segments().empty();
 
         return empty;
     }
@@ -85,17 +112,35 @@ struct load_helper
     bool set_program(vm::basic_vm& vm, vm::basic_vm::address_t pc_value = 0) const
     {
         if (is_empty()) return false;
-        if (is_bin()) return vm.set_program(*as_bin(), pc_value);
+        if (is_bin()) return vm.set_program(**as_bin(), pc_value);
         if (is_hex()) return vm.set_program(*as_hex());
+        if (is_elf()) return vm.set_program(**as_elf());
         return false;
     }
 
+    /// first address of heap: end of ELF data or start of data block
+    [[nodiscard]]
+    vm::register_t get_heap_start() const
+    {
+        constexpr auto data_base = vm::basic_vm::def_data_base;
+        vm::register_t start = data_base;
+        if (!is_elf()) return start;
+        for (const auto& segment: (*as_elf())->get_segments())
+        {
+            if (segment.address < data_base) continue;
+            start = std::max(start, segment.address + segment.memory_size);
+        }
+        // aligned as malloc() of newlib expects
+        return (start + 15u) & ~vm::register_t{15u};
+    }
+
     program_data data = nullptr;
 };
 
-void disasm(const vm::program_code_t &code);
+void disasm(std::span<const std::uint8_t> code);
 
-void run_vm(const load_helper &code, bool debug);
+/// @return exit code of guest
+int run_vm(const load_helper &code, bool debug, vm::basic_vm::engine_type engine);
 
 int main(int argc, char** argv)
 {
@@ -103,14 +148,33 @@ int main(int argc, char** argv)
     {
         std::cout << "Usage:" << std::endl;
         std::cout << "\texe d <path/to/file.bin> - disasm bin file" << std::endl;
-        std::cout << "\texe <v|V> <path/to/program> - run 'bin' or 'hex' file." << std::endl;
+        std::cout << "\texe <v|V> <path/to/program> - run 'bin', 'hex' or ELF file." << std::endl;
         std::cout << "\t\tv - no debug output" << std::endl;
         std::cout << "\t\tV - enable debug output" << std::endl;
+        std::cout << "\texe <v|V> <path/to/program> <engine> - run with selected engine" << std::endl;
+        std::cout << "\t\tinterpreter - decode and execute one by one(default)" << std::endl;
+        std::cout << "\t\tblocks - translate to basic blocks" << std::endl;
+        std::cout << "\t\tjit - compile hot blocks to native code(x86-64 only, blocks on other hosts)" << std::endl;
+        std::cout << "\tYETI_DECODE_CACHE=<dir> - keep predecoded programs in directory" << std::endl;
+        std::cout << "\tguest opens files relative to current directory" << std::endl;
+        std::cout << "\tYETI_IO_WORKER=1 - run batches of I/O ring in worker thread" << std::endl;
         return 0;
     }
 
     fs::path program_file = argv[2];
 
+    auto engine = vm::basic_vm::engine_type::interpreter;
+    if (argc > 3)
+    {
+        auto selected = vm::basic_vm::find_engine(argv[3]);
+        if (!selected)
+        {
+            std::cerr << "Unknown engine: " << argv[3] << std::endl;
+            return EXIT_FAILURE;
+        }
+        engine = selected.value();
+    }
+
     load_helper helper;
 
     if (!helper.load_file(program_file))
@@ -132,14 +196,12 @@ int main(int argc, char** argv)
             std::cerr << "unable disasm not '.bin' file" << std::endl;
             return EXIT_FAILURE;
         }
-        disasm(*helper.as_bin());
+        disasm((*helper.as_bin())->get_data());
         break;
     case 'v':
-        run_vm(helper, false);
-        break;
+        return run_vm(helper, false, engine);
     case 'V':
-        run_vm(helper, true);
-        break;
+        return run_vm(helper, true, engine);
     default:
         std::cout << "Unknown option: " << argv[1] << std::endl;
         return EXIT_FAILURE;
@@ -148,15 +210,31 @@ int main(int argc, char** argv)
     return EXIT_SUCCESS;
 }
 
-void init_syscalls(vm::syscall_registry &sys);
+void init_syscalls(vm::basic_vm &machine, vm::console &out, vm::linux_abi &files, vm::io_ring &ring);
 
-void run_vm(const load_helper &code, bool debug)
+int run_vm(const load_helper &code, bool debug, vm::basic_vm::engine_type engine)
 {
+    // guest output, flushed on newline and on exit
+    vm::console out{std::cout};
+    vm::linux_abi files{out, fs::current_path()};
+    const char* worker = std::getenv("YETI_IO_WORKER");
+    vm::io_ring ring{files, worker && std::strcmp(worker, "1") == 0};
     vm::basic_vm machine;
 
+    machine.set_engine(engine);
     machine.enable_debugging(debug);
+    machine.enable_predecode(true);
+    if (const char* cache = std::getenv("YETI_DECODE_CACHE"); cache && *cache)
+    {
+        machine.set_decode_cache(cache);
+    }
+    if (engine == vm::basic_vm::engine_type::jit)
+    {
+        // native code uses checked access if space can not be reserved
+        [[maybe_unused]] bool reserved = machine.enable_guest_space();
+    }
 
-    init_syscalls(machine.get_syscalls());
+    init_syscalls(machine, out, files, ring);
     bool isa_ok = machine.init_isa();
     bool mem_ok = machine.init_memory();
     bool init_ok = isa_ok && mem_ok;
@@ -165,14 +243,16 @@ void run_vm(const load_helper &code, bool debug)
         std::cerr
             << std::format("Unable init VM: isa = {} / mem = {}", isa_ok, mem_ok)
             << std::endl;
-        return;
+        return EXIT_FAILURE;
     }
     auto ok = code.set_program(machine, 0);
     if (!ok)
     {
         std::cerr << "unable load program(no memory)" << std::endl;
-        return;
+        return EXIT_FAILURE;
     }
+    constexpr auto data_end = static_cast<vm::register_t>(vm::basic_vm::def_data_base + vm::basic_vm::def_data_size);
+    files.set_heap(code.get_heap_start(), data_end - vm::linux_abi::def_stack_size);
     machine.start();
     try
     {
@@ -180,59 +260,43 @@ void run_vm(const load_helper &code, bool debug)
     }
     catch (std::exception& e)
     {
+        ring.wait();
+        out.flush();
         std::cerr << "Exception" << e.what() << std::endl;
         machine.dump_state(std::cerr);
         throw ;
     }
+    // buffers of requests in flight are in guest memory
+    ring.wait();
+    return files.get_exit_code();
 }
 
-void init_syscalls(vm::syscall_registry &sys)
+void init_syscalls(vm::basic_vm &machine, vm::console &out, vm::linux_abi &files, vm::io_ring &ring)
 {
-    using vm::RegAlias;
-    using call = vm::syscall_functor;
-    sys.register_handler(call::create(1024, "open", [](vm::vm_interface* m){
-        auto name_ptr = m->get_register(vm::a0);
-        auto flags = m->get_register(vm::a1);
-        std::cout << "open " << vm::to_signed(name_ptr) << " " << flags << std::endl;
-        m->set_register(vm::a0, 0);
-    }));
-    sys.register_handler(call::create(63, "read", [](vm::vm_interface* m){
-        auto file_id = m->get_register(vm::a0);
-        auto buff_ptr = m->get_register(vm::a1);
-        auto buff_sz = m->get_register(vm::a2);
-
-        for (vm::vm_interface::address_t i = 0; i < buff_sz; i+= sizeof(vm::register_t))
-        {
-            m->write_memory(buff_ptr + i, sizeof(vm::register_t), i * i);
-        }
-
-        std::cout << "read " << file_id << " " << vm::to_signed(buff_ptr) << " " << buff_sz << std::endl;
-        m->set_register(vm::a0, 0);
-    }));
-    sys.register_handler(call::create(57, "close", [](vm::vm_interface* m){
-        auto file_id = m->get_register(vm::a0);
-        std::cout << "close " << file_id << std::endl;
-        m->set_register(vm::a0, 0);
-    }));
-    sys.register_handler(call::create(11, "put_char", [](vm::vm_interface* m){
-        auto value = m->get_register(vm::a0);
-        auto data = reinterpret_cast<const char*>(&value);
-        std::cout << *data;
-        m->set_register(vm::a0, 0);
-    }));
-    sys.register_handler(call::create(1, "put_int", [](vm::vm_interface* m){
-        auto value = m->get_register(vm::a0);
-        std::cout << vm::to_signed(value);
-        m->set_register(vm::a0, 0);
-    }));
-    sys.register_handler(call::create(10, "exit", [](vm::vm_interface* m){
+    auto& sys = machine.get_syscalls();
+    // put_int and put_char, write is provided by file layer
+    if (!out.register_print(machine))
+    {
+        std::cerr << "unable register console" << std::endl;
+    }
+    // files, brk and exit of newlib
+    if (!files.register_syscalls(machine))
+    {
+        std::cerr << "unable register file syscalls" << std::endl;
+    }
+    // batched read and write
+    if (!ring.register_syscalls(machine))
+    {
+        std::cerr << "unable register I/O ring" << std::endl;
+    }
+    sys.register_handler(10, "exit", [](vm::vm_interface* m, void* context){
         m->halt();
-        std::cout << "exit" << std::endl;
+        static_cast<vm::console*>(context)->write("exit\n");
         m->set_register(vm::a0, 0);
-    }));
+    }, &out);
 }
 
-void disasm(const vm::program_code_t &code)
+void disasm(std::span<const std::uint8_t> code)
 {
     using namespace std::literals;
     using vm::opcode::Decoder;